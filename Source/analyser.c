@@ -53,6 +53,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "file.h"
 #include "part.h"
 #include "roboconfig.h"
+#include "reader.h"
+#include "jobs.h"
+#include "cache.h"
+#include "intern.h"
 
 #ifdef DMALLOC
 #include <dmalloc.h>
@@ -62,23 +66,28 @@ static int          ToBeAdded(
     struct RB_Document *document,
     struct RB_header *header );
 static int          Find_Header_Name(
-    FILE *,
-    struct RB_header * );
+    struct RB_Source_Reader *,
+    struct RB_header *,
+    struct RB_Arena * );
 static struct RB_header *Grab_Header(
-    FILE *sourcehandle,
-    struct RB_Document *arg_document );
+    struct RB_Source_Reader *sourcehandle,
+    struct RB_Begin_Marker_Search *search,
+    struct RB_Document *arg_document,
+    struct RB_Arena *arena );
 static char        *Function_Name(
     char *header_name );
 static char        *Module_Name(
     char *header_name );
 static int          Find_End_Marker(
-    FILE *document,
-    struct RB_header *new_header );
+    struct RB_Source_Reader *document,
+    struct RB_header *new_header,
+    struct RB_Arena *arena );
 struct RB_HeaderType *AnalyseHeaderType(
     char **cur_char,
     int *is_internal );
 static struct RB_HeaderType *RB_Find_Marker(
-    FILE *document,
+    struct RB_Source_Reader *document,
+    struct RB_Begin_Marker_Search *search,
     int *is_internal,
     int reuse_previous_line );
 static int          Analyse_Items(
@@ -86,6 +95,74 @@ static int          Analyse_Items(
 static int          Is_ListItem_Start(
     char *arg_line,
     int arg_indent );
+static void         Analyse_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part );
+static void         Analyse_Part_Job(
+    void *data,
+    int job );
+static void         Check_For_Duplicate(
+    struct RB_Document *arg_document,
+    struct RB_header *new_header );
+static void         Restore_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part,
+    struct RB_Cache_Entry *entry );
+
+/* The number of warnings about duplicate headers given by the
+ * current thread.  They depend on the other source files, so they
+ * do not prevent the analysis of a file from being cached. */
+static ROBO_THREAD_LOCAL int duplicate_warnings = 0;
+
+/****is* Analyser/RB_Analysis
+ * FUNCTION
+ *   The parts of a document that are analysed in parallel,
+ *   see RB_Analyse_Document().
+ * ATTRIBUTES
+ *   o document -- the document.
+ *   o parts    -- all the parts of the document, in order.
+ *   o no_parts -- the number of parts.
+ *   o logs     -- the messages of the analysis of each part.
+ *   o last_line_number -- the value of line_number after the last
+ *                 part was analysed.
+ * SOURCE
+ */
+
+struct RB_Analysis
+{
+    struct RB_Document *document;
+    struct RB_Part    **parts;
+    int                 no_parts;
+    struct RB_Message_Log *logs;
+    int                 last_line_number;
+};
+
+/*****/
+
+
+
+/****is* Analyser/RB_Duplicate_Check
+ * FUNCTION
+ *   A check for a duplicate header that is postponed until the
+ *   message log of a part is replayed, see Check_For_Duplicate().
+ * ATTRIBUTES
+ *   o document    -- the document.
+ *   o header      -- a copy of the names of the new header.
+ *   o file_name   -- the source file of the new header.
+ *   o line_number -- the line of the new header.
+ * SOURCE
+ */
+
+struct RB_Duplicate_Check
+{
+    struct RB_Document *document;
+    struct RB_header   *header;
+    char               *file_name;
+    int                 line_number;
+};
+
+/*****/
+
 
 /****f* Analyser/Is_Pipe_Marker
  * NAME
@@ -237,41 +314,271 @@ void RB_Analyse_Document(
  */
 {
     struct RB_Part     *a_part;
+
+    if ( arg_document->no_jobs > 1 )
+    {
+        struct RB_Analysis  analysis;
+        int                 i;
+
+        analysis.document = arg_document;
+        analysis.no_parts = 0;
+        analysis.last_line_number = line_number;
+        for ( a_part = arg_document->parts; a_part; a_part = a_part->next )
+        {
+            ++analysis.no_parts;
+        }
+        analysis.parts =
+            malloc( ( analysis.no_parts + 1 ) * sizeof( struct RB_Part * ) );
+        analysis.logs = malloc( ( analysis.no_parts + 1 ) *
+                                sizeof( struct RB_Message_Log ) );
+        if ( !analysis.parts || !analysis.logs )
+        {
+            RB_Panic( "Out of memory! %s()\n", "RB_Analyse_Document" );
+        }
+        for ( i = 0, a_part = arg_document->parts; a_part;
+              a_part = a_part->next, ++i )
+        {
+            analysis.parts[i] = a_part;
+        }
+        RB_Run_Jobs( arg_document->no_jobs, analysis.no_parts,
+                     Analyse_Part_Job, &analysis );
+        /* Print the messages and update the header name index
+         * in the same order as a serial run would. */
+        for ( i = 0; i < analysis.no_parts; ++i )
+        {
+            RB_Replay_Message_Log( &( analysis.logs[i] ) );
+        }
+        /* Later warnings refer to the last line that was read. */
+        if ( analysis.no_parts )
+        {
+            a_part = analysis.parts[analysis.no_parts - 1];
+            RB_SetCurrentFile( Get_Fullname( a_part->filename ) );
+            line_number = analysis.last_line_number;
+        }
+        free( analysis.parts );
+        free( analysis.logs );
+    }
+    else
+    {
+        for ( a_part = arg_document->parts; a_part; a_part = a_part->next )
+        {
+            Analyse_Part( arg_document, a_part );
+        }
+    }
+}
+
+/*****/
+
+
+/****f* Analyser/RB_Analyse_Part
+ * FUNCTION
+ *   Scan the sourcefile of a single part of a document for
+ *   headers, and store these headers in the part.  This is used
+ *   to analyse a source file again after it was changed.
+ * SYNOPSIS
+ */
+void RB_Analyse_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part )
+/*
+ * INPUTS
+ *   o arg_document -- the document the part belongs to.
+ *   o a_part       -- the part, it should have no headers.
+ * SOURCE
+ */
+{
+    assert( a_part->headers == NULL );
+    Analyse_Part( arg_document, a_part );
+}
+
+/*****/
+
+
+/****if* Analyser/Analyse_Part_Job
+ * FUNCTION
+ *   Analyse one part of a document on one of the threads of the
+ *   job pool.  All messages go to the message log of the part.
+ * SYNOPSIS
+ */
+static void Analyse_Part_Job(
+    void *data,
+    int job )
+/*
+ * INPUTS
+ *   o data -- the RB_Analysis.
+ *   o job  -- the index of the part.
+ * SOURCE
+ */
+{
+    struct RB_Analysis *analysis = data;
+
+    RB_Start_Message_Log( &( analysis->logs[job] ) );
+    Analyse_Part( analysis->document, analysis->parts[job] );
+    RB_Stop_Message_Log(  );
+    if ( job == analysis->no_parts - 1 )
+    {
+        analysis->last_line_number = line_number;
+    }
+}
+
+/*****/
+
+
+/****if* Analyser/Analyse_Part
+ * FUNCTION
+ *   Scan the sourcefile of a part for headers, and store these
+ *   headers in the part.
+ * SYNOPSIS
+ */
+static void Analyse_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part )
+/*
+ * INPUTS
+ *   o arg_document -- the document the part belongs to.
+ *   o a_part       -- the part to be analysed.
+ * SOURCE
+ */
+{
     struct RB_Filename *a_filename;
     FILE               *filehandle;
+    struct RB_Source_Reader *reader;
+    struct RB_Begin_Marker_Search search;
+    struct RB_header   *new_header = NULL;
+    struct RB_Cache_Entry *entry = NULL;
+    struct RB_Arena    *arena = &( a_part->arena );
+    struct RB_Arena_Mark mark;
+    int                 warnings = RB_Thread_Warnings(  ) - duplicate_warnings;
 
-    for ( a_part = arg_document->parts; a_part; a_part = a_part->next )
-    {
-        struct RB_header   *new_header = NULL;
+    a_filename = a_part->filename;
+    RB_Say( "analysing %s\n", SAY_DEBUG, Get_Fullname( a_filename ) );
+    RB_SetCurrentFile( Get_Fullname( a_filename ) );
 
-        a_filename = a_part->filename;
-        RB_Say( "analysing %s\n", SAY_DEBUG, Get_Fullname( a_filename ) );
-        RB_SetCurrentFile( Get_Fullname( a_filename ) );
+    if ( arg_document->cache )
+    {
+        entry = RB_Cache_Lookup( arg_document->cache, a_part );
+        if ( entry->hit )
+        {
+            Restore_Part( arg_document, a_part, entry );
+            RB_Cache_Free_Entry( entry );
+            RB_Free_Kept_Source( a_filename );
+            return;
+        }
+    }
 
-        RB_Header_Lock_Reset(  );
+    RB_Header_Lock_Reset(  );
+    /* The directory scan might have read the file already */
+    reader = RB_Take_Kept_Source( a_filename );
+    if ( !reader )
+    {
         filehandle = RB_Open_Source( a_part );
-        line_number = 0;
+        reader = RB_Read_Source( filehandle );
+        fclose( filehandle );
+    }
+    if ( entry )
+    {
+        RB_Cache_Hash_Source( entry, reader );
+    }
+    line_number = 0;
+    RB_Start_Begin_Marker_Search( &search );
 
-        for ( new_header = Grab_Header( filehandle, arg_document );
-              new_header;
-              new_header = Grab_Header( filehandle, arg_document ) )
+    RB_Mark_Arena( arena, &mark );
+    for ( new_header = Grab_Header( reader, &search, arg_document, arena );
+          new_header;
+          new_header = Grab_Header( reader, &search, arg_document, arena ) )
+    {
+        if ( ToBeAdded( arg_document, new_header ) )
         {
-            if ( ToBeAdded( arg_document, new_header ) )
+            /* The Add is required before the 
+             * Analyse because Add sets the owner of the header
+             * which is needed for error messages.
+             */
+            RB_Part_Add_Header( a_part, new_header );
+            Analyse_Items( new_header );
+            if ( entry )
             {
-                /* The Add is required before the 
-                 * Analyse because Add sets the owner of the header
-                 * which is needed for error messages.
-                 */
-                RB_Part_Add_Header( a_part, new_header );
-                Analyse_Items( new_header );
+                RB_Cache_Add_Header( entry, new_header, TRUE );
             }
-            else
+        }
+        else
+        {
+            if ( entry )
             {
-                RB_Free_Header( new_header );
+                RB_Cache_Add_Header( entry, new_header, FALSE );
             }
+            RB_Free_Header( new_header );
+            /* Nothing else refers to the header, so its memory can
+             * be used for the next one. */
+            RB_Release_Arena( arena, &mark );
+        }
+        RB_Mark_Arena( arena, &mark );
+    }
+    if ( entry )
+    {
+        /* Only cache files that gave no warnings, the warnings
+         * would be lost otherwise. */
+        if ( RB_Thread_Warnings(  ) - duplicate_warnings == warnings )
+        {
+            RB_Cache_Store( arg_document->cache, entry, line_number );
+        }
+        RB_Cache_Free_Entry( entry );
+    }
+    /* The lines of the headers point into the reader, and are not
+     * needed anymore now the items have been made. */
+    for ( new_header = a_part->headers; new_header;
+          new_header = new_header->next )
+    {
+        new_header->lines = NULL;
+        new_header->no_lines = 0;
+    }
+    /* myLine points into the reader */
+    myLine = NULL;
+    readChars = 0;
+    RB_Free_Source_Reader( reader );
+}
+
+/*****/
+
+
+/****if* Analyser/Restore_Part
+ * FUNCTION
+ *   Add the headers of a source file that were found in the
+ *   cache to its part.  This is done in the same way, and in the
+ *   same order, as when the file is analysed.
+ * SYNOPSIS
+ */
+static void Restore_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part,
+    struct RB_Cache_Entry *entry )
+/*
+ * INPUTS
+ *   o arg_document -- the document the part belongs to.
+ *   o a_part       -- the part.
+ *   o entry        -- the cache entry of its source file.
+ * SOURCE
+ */
+{
+    int                 i;
+
+    RB_Say( "using the cached analysis of %s\n", SAY_DEBUG,
+            entry->source_name );
+    for ( i = 0; i < entry->no_headers; ++i )
+    {
+        struct RB_header   *header = entry->headers[i];
+
+        line_number = header->line_number;
+        Check_For_Duplicate( arg_document, header );
+        if ( entry->added[i] )
+        {
+            RB_Part_Add_Header( a_part, header );
+        }
+        else
+        {
+            RB_Free_Header( header );
         }
-        fclose( filehandle );
     }
+    line_number = entry->last_line_number;
 }
 
 /*****/
@@ -460,8 +767,9 @@ static void Remove_List_Char(
             char               *temp = arg_item->lines[start_index]->line;
 
             *c = ' ';
-            arg_item->lines[start_index]->line = RB_StrDup( temp + 2 );
-            free( temp );
+            /* The line is in the arena of the part, so it is not
+             * copied. */
+            arg_item->lines[start_index]->line = temp + 2;
         }
     }
 }
@@ -994,16 +1302,17 @@ static int Trim_Empty_Item_Begin_Lines(
 {
 
     char               *c;
+    char               *text;
 
     if ( Works_Like_SourceItem( arg_item->type ) )
     {
         /* We skip the first line after the source item, if
          * it an remark end marker -- such as '*)'
          */
-        c = arg_header->lines[current_index].line;
-        if ( RB_Is_Remark_End_Marker( c ) )
+        c = RB_Match_Remark_End_Marker( arg_header->lines[current_index].
+                                        line );
+        if ( c )
         {
-            c = RB_Skip_Remark_End_Marker( c );
             c = RB_Skip_Whitespace( c );
             if ( *c != '\0' )
             {
@@ -1024,9 +1333,9 @@ static int Trim_Empty_Item_Begin_Lines(
         {
             c = arg_header->lines[current_index].line;
             c = RB_Skip_Whitespace( c );
-            if ( RB_Has_Remark_Marker( c ) )
+            if ( ( text = RB_Match_Remark_Marker( c ) ) )
             {
-                c = RB_Skip_Remark_Marker( c );
+                c = text;
             }
             c = RB_Skip_Whitespace( c );
             if ( *c == '\0' )
@@ -1048,13 +1357,14 @@ static int Trim_Empty_Item_End_Lines(
     int current_index )
 {
     char               *c;
+    char               *text;
 
     if ( Works_Like_SourceItem( arg_item->type ) )
     {
-        c = arg_header->lines[current_index].line;
-        if ( RB_Is_Remark_Begin_Marker( c ) )
+        c = RB_Match_Remark_Begin_Marker( arg_header->lines[current_index].
+                                          line );
+        if ( c )
         {
-            c = RB_Skip_Remark_Begin_Marker( c );
             c = RB_Skip_Whitespace( c );
             if ( *c != '\0' )
             {
@@ -1070,9 +1380,9 @@ static int Trim_Empty_Item_End_Lines(
     {
         c = arg_header->lines[current_index].line;
         c = RB_Skip_Whitespace( c );
-        if ( RB_Has_Remark_Marker( c ) )
+        if ( ( text = RB_Match_Remark_Marker( c ) ) )
         {
-            c = RB_Skip_Remark_Marker( c );
+            c = text;
         }
         c = RB_Skip_Whitespace( c );
         if ( *c == '\0' )
@@ -1143,11 +1453,36 @@ static void Trim_Empty_Item_Lines(
 
 
 
+/****if* Analyser/Lines_Capacity
+ * FUNCTION
+ *   The size of the lines array of an item with a given number of
+ *   lines.  It is the smallest power of two that is not less than
+ *   the number of lines, so lines can be added to the array with
+ *   Add_Lines_To_Item() without copying it each time.
+ * SOURCE
+ */
+
+static int Lines_Capacity(
+    int no_lines )
+{
+    int                 capacity = 1;
+
+    while ( capacity < no_lines )
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/*******/
+
+
 /* TODO This routine is way too long */
 
 static void Copy_Lines_To_Item(
     struct RB_header *arg_header,
-    struct RB_Item *arg_item )
+    struct RB_Item *arg_item,
+    struct RB_Arena *arena )
 {
     Trim_Empty_Item_Lines( arg_header, arg_item );
 
@@ -1155,45 +1490,43 @@ static void Copy_Lines_To_Item(
     {
         int                 i = 0;
         int                 j = 0;
-        struct RB_Item_Line *itemline = NULL;
+        struct RB_Item_Line item_line;
+        struct RB_Item_Line *itemline = &item_line;
         int                 tool_active = 0;    /* Shows wether we are inside a tool body */
 
         /* Allocate enough memory for all the lines, plus one
-         * extra line
+         * extra line.  Add_Lines_To_Item() counts on the
+         * size being a power of two.
          */
         ++arg_item->no_lines;
         arg_item->lines =
-            calloc( arg_item->no_lines, sizeof( struct RB_Item_Line * ) );
-        if ( !arg_item->lines )
-        {
-            RB_Panic( "Out of memory! %s\n", "Copy_Lines_To_Item" );
-        }
+            RB_Arena_Calloc( arena, Lines_Capacity( arg_item->no_lines ),
+                             sizeof( struct RB_Item_Line * ) );
 
         /* And create an RB_Item_Line for each of them, and add
          * those to the RB_Item
          */
         for ( i = 0; i < arg_item->no_lines - 1; ++i )
         {
-            char               *c =
+            char               *line =
                 arg_header->lines[arg_item->begin_index + i].line;
-            /* TODO should be a Create_ItemLine() */
-            itemline = malloc( sizeof( struct RB_Item_Line ) );
-            if ( !itemline )
-            {
-                RB_Panic( "Out of memory! %s (2)\n", "Copy_Lines_To_Item" );
-            }
-
-            c = ExpandTab( c );
-            c = RB_Skip_Whitespace( c );
+            char               *expanded;
+            char               *c;
+            char               *text;
+            struct RB_Arena_Mark mark;
+
+            RB_Mark_Arena( arena, &mark );
+            expanded = ExpandTab( arena, line );
+            c = RB_Skip_Whitespace( expanded );
+            text = RB_Match_Remark_Marker( c );
             /* Lines with remark marker */
-            if ( RB_Has_Remark_Marker( c )
-                 && !Works_Like_SourceItem( arg_item->type ) )
+            if ( text && !Works_Like_SourceItem( arg_item->type ) )
             {
                 char               *c2, *c3;
                 int                 pipe_mode;
                 enum ItemLineKind   item_kind;
 
-                c = RB_Skip_Remark_Marker( c );
+                c = text;
                 c2 = RB_Skip_Whitespace( c );
                 if ( *c2 )
                 {
@@ -1240,8 +1573,7 @@ static void Copy_Lines_To_Item(
                 /* The is raw code, so we do not want to have the
                  * whitespace stripped of
                  */
-                c = arg_header->lines[arg_item->begin_index + i].line;
-                c = ExpandTab( c );
+                c = expanded;
             }
 
             /* Copy source like items */
@@ -1249,8 +1581,12 @@ static void Copy_Lines_To_Item(
                    ( itemline->kind != ITEM_LINE_RAW ) ) ||
                  Works_Like_SourceItem( arg_item->type ) )
             {
-                /* Copy item line */
-                itemline->line = RB_StrDup( c );
+                /* Copy item line, unless it already is a copy with
+                 * the tabs expanded.  The header lines point into
+                 * the source file, which is gone after the
+                 * analysis. */
+                itemline->line = ( expanded != line ) ? c :
+                    RB_Arena_StrDup( arena, c );
                 /* Copy original source line number */
                 itemline->line_number =
                     arg_header->lines[arg_item->begin_index + i].line_number;
@@ -1260,7 +1596,9 @@ static void Copy_Lines_To_Item(
                     arg_item->max_line_number = itemline->line_number;
                 }
                 itemline->format = 0;
-                arg_item->lines[j] = itemline;
+                arg_item->lines[j] =
+                    RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line ) );
+                *( arg_item->lines[j] ) = *itemline;
                 ++j;
             }
             else
@@ -1268,7 +1606,7 @@ static void Copy_Lines_To_Item(
                 /* We dump the RAW item lines if we are not in a
                  * source item.
                  */
-                free( itemline );
+                RB_Release_Arena( arena, &mark );
             }
         }
 
@@ -1277,14 +1615,9 @@ static void Copy_Lines_To_Item(
             /* And one empty line to mark the end of an item and
              * to be able to store some additional formatting actions
              */
-            itemline = malloc( sizeof( struct RB_Item_Line ) );
-            if ( !itemline )
-            {
-                RB_Panic( "Out of memory! %s (3)\n", "Copy_Lines_To_Item" );
-            }
-
+            itemline = RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line ) );
             itemline->kind = ITEM_LINE_END;
-            itemline->line = RB_StrDup( "" );
+            itemline->line = RB_Arena_StrDup( arena, "" );
             itemline->format = 0;
             arg_item->lines[j] = itemline;
 
@@ -1295,7 +1628,6 @@ static void Copy_Lines_To_Item(
         else
         {
             arg_item->no_lines = 0;
-            free( arg_item->lines );
             arg_item->lines = NULL;
         }
     }
@@ -1309,29 +1641,31 @@ static void Copy_Lines_To_Item(
 /*RZ*/
 static void Add_Lines_To_Item(
     struct RB_Item *arg_item,
-    char *c )
+    char *c,
+    struct RB_Arena *arena )
 {
   struct RB_Item_Line *itemline = NULL;
 
   if (arg_item->no_lines == 0) {
-    arg_item->lines = malloc( sizeof( struct RB_Item_Line * ) );
-    itemline = malloc( sizeof( struct RB_Item_Line ) );
-    if ( !itemline || !arg_item->lines) {
-      RB_Panic( "Out of memory! %s (2)\n", "Add_Lines_To_Item" );
-    }
-    itemline->line = RB_StrDup( "" );
+    arg_item->lines = RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line * ) );
+    itemline = RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line ) );
+    itemline->line = RB_Arena_StrDup( arena, "" );
     itemline->kind = ITEM_LINE_END;
     itemline->format = 0;
     arg_item->lines[0] = itemline;
     arg_item->no_lines = 1;
   }
-  arg_item->no_lines++;
-  arg_item->lines = realloc( arg_item->lines, arg_item->no_lines * sizeof( struct RB_Item_Line * ) );
-  itemline = malloc( sizeof( struct RB_Item_Line ) );
-  if ( !itemline || !arg_item->lines) {
-    RB_Panic( "Out of memory! %s (2)\n", "Add_Lines_To_Item" );
+  /* The lines array is full when its size is a power of two */
+  if ( Lines_Capacity( arg_item->no_lines ) == arg_item->no_lines ) {
+    struct RB_Item_Line **lines =
+      RB_Arena_Alloc( arena, 2 * arg_item->no_lines * sizeof( struct RB_Item_Line * ) );
+
+    memcpy( lines, arg_item->lines, arg_item->no_lines * sizeof( struct RB_Item_Line * ) );
+    arg_item->lines = lines;
   }
-  itemline->line = RB_StrDup( c );
+  arg_item->no_lines++;
+  itemline = RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line ) );
+  itemline->line = RB_Arena_StrDup( arena, c );
   itemline->kind = ITEM_LINE_PLAIN;
   itemline->format = 0;
   if ( arg_item->no_lines > 1 ) {
@@ -1363,6 +1697,7 @@ static int Analyse_Items(
     char *cur_mchar = NULL;
     char *cur_char = NULL;
     int length;
+    struct RB_Arena    *arena = &( arg_header->owner->arena );
 
     RB_Item_Lock_Reset(  );
 
@@ -1379,7 +1714,7 @@ static int Analyse_Items(
     /* and all the others */
     while ( ( item_type != NO_ITEM ) && ( line_nr < arg_header->no_lines ) )
     {
-        new_item = RB_Create_Item( item_type );
+        new_item = RB_Create_Item( arena, item_type );
         new_item->begin_index = line_nr;
         /*RZ add source comments to this item */
         if (use_source_comments) {
@@ -1418,7 +1753,7 @@ static int Analyse_Items(
                         if (use_item == NULL) {
                             item_type = RB_Get_Item_Type (use_source_comments);
                             if ( item_type != NO_ITEM ) {
-                                use_item = RB_Create_Item( item_type );
+                                use_item = RB_Create_Item( arena, item_type );
                                 use_item->no_lines = 0;
                                 /* Add the item to the end of the list of items. */
                                 if ( arg_header->items ) {
@@ -1432,7 +1767,7 @@ static int Analyse_Items(
                                 }
                             }
                         }
-                        Add_Lines_To_Item( use_item, &cur_char[length]);
+                        Add_Lines_To_Item( use_item, &cur_char[length], arena );
                     }
                 }
             }
@@ -1449,7 +1784,7 @@ static int Analyse_Items(
         assert( new_item->end_index >= new_item->begin_index );
 
         /* Now analyse and copy the lines */
-        Copy_Lines_To_Item( arg_header, new_item );
+        Copy_Lines_To_Item( arg_header, new_item, arena );
         Analyse_Item_Format( new_item );
         /* Handy for debugging wiki formatting 
          *   Dump_Item( new_item );
@@ -1520,6 +1855,124 @@ static int ToBeAdded(
 
 
 
+/****if* Analyser/Warn_For_Duplicate
+ * FUNCTION
+ *   Warn if a header with one of the names of a new header was
+ *   already added to one of the parts of the document.
+ *   Duplicate headers do not crash the program so we accept them.
+ *   But we do warn the user.
+ * SYNOPSIS
+ */
+static void Warn_For_Duplicate(
+    struct RB_Document *arg_document,
+    struct RB_header *new_header )
+/*
+ * INPUTS
+ *   o arg_document -- the document.
+ *   o new_header   -- the new header, its names should be set.
+ * SOURCE
+ */
+{
+    struct RB_header   *duplicate_header =
+        RB_Document_Check_For_Duplicate( arg_document, new_header );
+
+    if ( duplicate_header )
+    {
+        ++duplicate_warnings;
+        RB_Warning
+            ( "A header with the name \"%s\" already exists.\n  See %s(%d)\n",
+              new_header->name,
+              Get_Fullname( duplicate_header->owner->filename ),
+              duplicate_header->line_number );
+    }
+}
+
+/*******/
+
+
+/****if* Analyser/Run_Duplicate_Check
+ * FUNCTION
+ *   Do a postponed duplicate check and free it.
+ * SYNOPSIS
+ */
+static void Run_Duplicate_Check(
+    void *data )
+/*
+ * INPUTS
+ *   o data -- the RB_Duplicate_Check.
+ * SOURCE
+ */
+{
+    struct RB_Duplicate_Check *check = data;
+    struct RB_header   *header = check->header;
+    char               *previous_file = current_file;
+    int                 previous_line_number = line_number;
+
+    RB_SetCurrentFile( check->file_name );
+    line_number = check->line_number;
+    Warn_For_Duplicate( check->document, header );
+    RB_SetCurrentFile( previous_file );
+    line_number = previous_line_number;
+    free( header->names );
+    free( header );
+    free( check );
+}
+
+/*******/
+
+
+/****if* Analyser/Check_For_Duplicate
+ * FUNCTION
+ *   Warn if there already is a header with one of the names of a
+ *   new header.  The header name index of the document is shared
+ *   by all parts, so when the parts are analysed in parallel
+ *   the check is postponed with RB_Defer().  The new header might
+ *   be freed before that, so the check gets a copy of the array of
+ *   its names.  The names themselves are interned.
+ * SYNOPSIS
+ */
+static void Check_For_Duplicate(
+    struct RB_Document *arg_document,
+    struct RB_header *new_header )
+/*
+ * INPUTS
+ *   o arg_document -- the document.
+ *   o new_header   -- the new header, its names should be set.
+ * SOURCE
+ */
+{
+    if ( RB_Message_Log_Active(  ) )
+    {
+        struct RB_Duplicate_Check *check =
+            malloc( sizeof( struct RB_Duplicate_Check ) );
+        struct RB_header   *header = calloc( 1, sizeof( struct RB_header ) );
+        int                 i;
+
+        RB_Mem_Check( check );
+        RB_Mem_Check( header );
+        header->no_names = new_header->no_names;
+        header->names = malloc( ( header->no_names + 1 ) * sizeof( char * ) );
+        RB_Mem_Check( header->names );
+        for ( i = 0; i < header->no_names; ++i )
+        {
+            header->names[i] = new_header->names[i];
+        }
+        header->name = header->no_names ? header->names[0] : NULL;
+        check->document = arg_document;
+        check->header = header;
+        check->file_name = current_file;
+        check->line_number = line_number;
+        RB_Defer( Run_Duplicate_Check, check );
+    }
+    else
+    {
+        Warn_For_Duplicate( arg_document, new_header );
+    }
+}
+
+/*******/
+
+
 /****f* Analyser/Grab_Header
  * FUNCTION
  *   Grab a header from a source file, that is scan a source file
@@ -1528,11 +1981,15 @@ static int ToBeAdded(
  * SYNPOPSIS
  */
 static struct RB_header *Grab_Header(
-    FILE *sourcehandle,
-    struct RB_Document *arg_document )
+    struct RB_Source_Reader *sourcehandle,
+    struct RB_Begin_Marker_Search *search,
+    struct RB_Document *arg_document,
+    struct RB_Arena *arena )
 /*
  * INPUTS
- *   o sourcehandle -- an opened source file.
+ *   o sourcehandle -- the reader of the source file.
+ *   o search       -- the search for begin markers in the file.
+ *   o arena        -- the arena the header is allocated from.
  * OUTPUT
  *   o sourcehandle -- will point to the line following the end marker.
  * RESULT
@@ -1545,46 +2002,35 @@ static struct RB_header *Grab_Header(
     struct RB_HeaderType *header_type = NULL;
     int                 good_header = FALSE;
     int                 reuse = FALSE;
+    struct RB_Arena_Mark mark;
 
+    RB_Mark_Arena( arena, &mark );
     do
     {
         good_header = FALSE;
-        header_type = RB_Find_Marker( sourcehandle, &is_internal, reuse );
+        header_type =
+            RB_Find_Marker( sourcehandle, search, &is_internal, reuse );
         reuse = FALSE;
         if ( header_type )
         {
-            struct RB_header   *duplicate_header = NULL;
             long                previous_line = 0;
 
-            new_header = RB_Alloc_Header(  );
+            new_header = RB_Alloc_Header( arena );
             new_header->htype = header_type;
             new_header->is_internal = is_internal;
 
-            if ( Find_Header_Name( sourcehandle, new_header ) )
+            if ( Find_Header_Name( sourcehandle, new_header, arena ) )
             {
                 new_header->line_number = line_number;
                 RB_Say( "found header [line %5d]: \"%s\"\n", SAY_DEBUG,
                         line_number, new_header->name );
-                duplicate_header =
-                    RB_Document_Check_For_Duplicate( arg_document,
-                                                     new_header );
-                if ( duplicate_header )
-                {
-                    /* Duplicate headers do not crash the program so
-                     * we accept them.  But we do warn the user.
-                     */
-                    RB_Warning
-                        ( "A header with the name \"%s\" already exists.\n  See %s(%d)\n",
-                          new_header->name,
-                          Get_Fullname( duplicate_header->owner->filename ),
-                          duplicate_header->line_number );
-                }
+                Check_For_Duplicate( arg_document, new_header );
 
                 if ( ( new_header->function_name =
                        Function_Name( new_header->name ) ) == NULL )
                 {
                     RB_Warning( "Can't determine the \"function\" name.\n" );
-                    RB_Free_Header( new_header );
+                    RB_Release_Arena( arena, &mark );
                     new_header = NULL;
                 }
                 else
@@ -1594,14 +2040,14 @@ static struct RB_header *Grab_Header(
                     {
                         RB_Warning
                             ( "Can't determine the \"module\" name.\n" );
-                        RB_Free_Header( new_header );
+                        RB_Release_Arena( arena, &mark );
                         new_header = NULL;
                     }
                     else
                     {
                         previous_line = line_number;
-                        if ( Find_End_Marker( sourcehandle, new_header ) ==
-                             0 )
+                        if ( Find_End_Marker( sourcehandle, new_header,
+                                              arena ) == 0 )
                         {
                             RB_Warning
                                 ( "found header on line %d with name \"%s\"\n"
@@ -1611,7 +2057,7 @@ static struct RB_header *Grab_Header(
                              * Marking using RB_Find_Marker()
                              */
                             reuse = TRUE;
-                            RB_Free_Header( new_header );
+                            RB_Release_Arena( arena, &mark );
                             new_header = NULL;
                         }
                         else
@@ -1627,7 +2073,7 @@ static struct RB_header *Grab_Header(
             else
             {
                 RB_Warning( "found header marker but no name\n" );
-                RB_Free_Header( new_header );
+                RB_Release_Arena( arena, &mark );
                 new_header = NULL;
             }
         }
@@ -1660,14 +2106,13 @@ static char        *Module_Name(
  * INPUTS
  *   o header_name -- a pointer to a nul terminated string.
  * RESULT
- *   Pointer to the modulename.  You're responsible for freeing it.
+ *   Pointer to the interned modulename, or NULL if there is none.
  * SEE ALSO
  *   Function_Name()
  * SOURCE
  */
 {
     char               *cur_char;
-    char                c;
     char               *name = NULL;
 
     assert( header_name );
@@ -1675,10 +2120,8 @@ static char        *Module_Name(
     for ( cur_char = header_name; *cur_char && *cur_char != '/'; ++cur_char );
     if ( *cur_char )
     {
-        c = *cur_char;
-        *cur_char = '\0';
-        name = RB_StrDup( header_name );
-        *cur_char = c;
+        name = RB_Intern_StrLen( header_name,
+                                 ( size_t ) ( cur_char - header_name ) );
     }
     return name;
 }
@@ -1699,6 +2142,11 @@ static char        *Module_Name(
 static char        *Function_Name(
     char *header_name )
 /*
+ * INPUTS
+ *   o header_name -- a pointer to a nul terminated string.
+ * RESULT
+ *   Pointer to the interned function name, or NULL if there is
+ *   none.
  * SOURCE
  */
 {
@@ -1723,7 +2171,7 @@ static char        *Function_Name(
     }
     if ( name )
     {
-        return RB_StrDup( name );
+        return RB_Intern_String( name );
     }
     else
     {
@@ -1744,22 +2192,26 @@ static char        *Function_Name(
  * SYNOPSIS
  */
 static struct RB_HeaderType *RB_Find_Marker(
-    FILE *document,
+    struct RB_Source_Reader *document,
+    struct RB_Begin_Marker_Search *search,
     int *is_internal,
     int reuse_previous_line )
 /*
  * INPUTS
- *   document - pointer to the file to be searched.
- *   the gobal buffer line_buffer.
+ *   document - the reader of the file to be searched.
+ *   search   - the search for begin markers in the file.  The
+ *              lines that can not contain one are skipped without
+ *              looking at them one by one.
+ *   reuse_previous_line - check the current line (myLine)
+ *                         before reading the next one.
  * OUTPUT
  *   o document will point to the line after the line with 
  *     the header marker.
+ *   o myLine is the line with the header marker.
  *   o is_internal will be TRUE if the header is an internal
  *     header.
  * RESULT
  *   o header type
- * BUGS
- *   Bad use of feof(), fgets().
  * SEE ALSO
  *   Find_End_Marker
  * SOURCE
@@ -1771,29 +2223,37 @@ static struct RB_HeaderType *RB_Find_Marker(
 
     cur_char = NULL;
     found = FALSE;
-    while ( !feof( document ) && !found )
+    while ( !found )
     {
-        if ( reuse_previous_line )
+        if ( reuse_previous_line && myLine )
         {
-            /* reuse line in the line_buffer */
+            /* reuse the current line */
             reuse_previous_line = FALSE;
         }
         else
         {
-            RB_FreeLineBuffer(  );
-            myLine = RB_ReadWholeLine( document, line_buffer, &readChars );
-        }
-        if ( !feof( document ) )
-        {
-            line_number++;
-            found = RB_Is_Begin_Marker( myLine, &cur_char );
-            if ( found )
+            size_t              next_line =
+                RB_Find_Begin_Marker_Line( search, document->data,
+                                           document->size,
+                                           RB_Rest_Of_Source( document ) );
+
+            line_number += ( int ) RB_Skip_Source_Lines( document, next_line );
+            myLine = RB_Next_Source_Line( document );
+            readChars = ( int ) document->length;
+            if ( myLine == NULL )
             {
-                header_type = AnalyseHeaderType( &cur_char, is_internal );
-                RB_Say( "found header marker of type %s\n", SAY_DEBUG,
-                        header_type->indexName );
+                /* end of the file */
+                break;
             }
         }
+        line_number++;
+        found = RB_Is_Begin_Marker( myLine, &cur_char );
+        if ( found )
+        {
+            header_type = AnalyseHeaderType( &cur_char, is_internal );
+            RB_Say( "found header marker of type %s\n", SAY_DEBUG,
+                    header_type->indexName );
+        }
     }
 
     return header_type;
@@ -1850,14 +2310,18 @@ struct RB_HeaderType *AnalyseHeaderType(
  * SYNOPSIS
  */
 static int Find_End_Marker(
-    FILE *document,
-    struct RB_header *new_header )
+    struct RB_Source_Reader *document,
+    struct RB_header *new_header,
+    struct RB_Arena *arena )
 /*
  * INPUTS
- *   o document -- a pointer to an opened source file.
+ *   o document -- the reader of the source file.
+ *   o arena    -- the arena the array of lines is allocated in.
  * OUTPUT
  *   o new_header -- the lines of source code will be added
- *                   here.
+ *                   here.  They point into the data of the
+ *                   reader, so they are only valid as long as
+ *                   the reader is.
  * RESULT
  *   o TRUE  -- an end marker was found.
  *   o FALSE -- no end marker was found while scanning the
@@ -1870,6 +2334,7 @@ static int Find_End_Marker(
     unsigned int        max_no_lines = 10;
     struct RB_header_lines *lines = NULL;
     char               *dummy;
+    enum RB_Marker_Kind marker_kind;
 
     lines = malloc( max_no_lines * sizeof( struct RB_header_lines ) );
     if ( lines == NULL )
@@ -1877,19 +2342,20 @@ static int Find_End_Marker(
         RB_Panic( "Out of memory! %s()\n", "Find_End_Marker" );
     }
 
-    while ( !feof( document ) )
+    while ( ( myLine = RB_Next_Source_Line( document ) ) != NULL )
     {
-        RB_FreeLineBuffer(  );
-        myLine = RB_ReadWholeLine( document, line_buffer, &readChars );
+        readChars = ( int ) document->length;
         ++line_number;          /* global linecounter, koessi */
-        if ( RB_Is_Begin_Marker( myLine, &dummy ) )
+        marker_kind = RB_Match_Header_Marker( myLine, &dummy );
+        if ( marker_kind == RB_BEGIN_MARKER )
         {
             /* Bad... found a begin marker but was expecting to
                find an end marker.  Panic... */
+            free( lines );
             found = FALSE;
             return found;
         }
-        else if ( RB_Is_End_Marker( myLine ) )
+        else if ( marker_kind == RB_END_MARKER )
         {
             RB_Say( "Found end marker \"%s\"", SAY_DEBUG, myLine );
             found = TRUE;
@@ -1897,17 +2363,15 @@ static int Find_End_Marker(
         }
         else
         {
-            unsigned int        n;
-            char               *line;
+            size_t              n = document->length;
 
-            line = RB_StrDup( myLine );
-            n = strlen( line );
             assert( n > 0 );
-            assert( line[n - 1] == '\n' );
-            /* Strip CR */
-            line[n - 1] = '\0';
-            /* Copy the line itself */
-            lines[no_lines].line = line;
+            assert( myLine[n - 1] == '\n' );
+            /* The line is not copied but stays in the source file,
+             * with its LF as its end.  The reader never looks back
+             * at the lines it already handed out. */
+            myLine[n - 1] = '\0';
+            lines[no_lines].line = myLine;
             /* and also save the original source line number */
             lines[no_lines].line_number = line_number;
             ++no_lines;
@@ -1928,7 +2392,11 @@ static int Find_End_Marker(
     }
 
     new_header->no_lines = no_lines;
-    new_header->lines = lines;
+    new_header->lines =
+        RB_Arena_Alloc( arena, no_lines * sizeof( struct RB_header_lines ) );
+    memcpy( new_header->lines, lines,
+            no_lines * sizeof( struct RB_header_lines ) );
+    free( lines );
 
     return found;
 }
@@ -2003,10 +2471,27 @@ static int RB_WordWithSpacesLen(
 /*** RB_WordWithSpacesLen ***/
 
 
-/* TODO Documentation */
+/****if* Analyser/Find_Header_Name
+ * FUNCTION
+ *   Store the names that follow the begin marker on the current
+ *   line, and on the lines that follow it if the names end with a
+ *   separator.
+ * SYNOPSIS
+ */
 static int Find_Header_Name(
-    FILE *fh,
-    struct RB_header *hdr )
+    struct RB_Source_Reader *fh,
+    struct RB_header *hdr,
+    struct RB_Arena *arena )
+/*
+ * INPUTS
+ *   o fh    -- the reader of the source file.
+ *   o hdr   -- the header the names are stored in.  The names
+ *              are interned.
+ *   o arena -- the arena the array of names is allocated from.
+ * RESULT
+ *   The number of names.
+ * SOURCE
+ */
 {
     char               *cur_char = myLine;
     char              **names = NULL;
@@ -2029,7 +2514,7 @@ static int Find_Header_Name(
             RB_Panic( "Out of memory! %s()\n", "Find_Header_Name" );
         }
 
-        names[num - 1] = RB_StrDupLen( cur_char, length );
+        names[num - 1] = RB_Intern_StrLen( cur_char, length );
         /* printf("%c adding name = %s\n", num > 1 ? ' ' : '*', names[ num - 1 ] ); */
         cur_char += length;
         if ( Find_Parameter_Char( &( configuration.header_separate_chars ),
@@ -2040,18 +2525,28 @@ static int Find_Header_Name(
             if ( *cur_char == 0 )
             {
                 /* Skip comment */
-                RB_FreeLineBuffer(  );
-                myLine = RB_ReadWholeLine( fh, line_buffer, &readChars );
+                myLine = RB_Next_Source_Line( fh );
+                readChars = ( int ) fh->length;
                 line_number++;
+                if ( myLine == NULL )
+                {
+                    /* end of the file */
+                    break;
+                }
                 for ( cur_char = myLine;
                       *cur_char && !utf8_isalpha( *cur_char ); cur_char++ );
             }
         }
     }
-    hdr->names = names;
+    hdr->names = RB_Arena_Alloc( arena, num * sizeof *names );
+    if ( num )
+    {
+        memcpy( hdr->names, names, num * sizeof *names );
+    }
+    free( names );
     hdr->no_names = num;
-    hdr->name = num ? names[0] : NULL;
+    hdr->name = num ? hdr->names[0] : NULL;
     return num;
 }
 
-/*****  Find_Header_Name  *****/
+/*******/
@@ -28,5 +28,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 void                RB_Analyse_Document(
     struct RB_Document *arg_document );
+void                RB_Analyse_Part(
+    struct RB_Document *arg_document,
+    struct RB_Part *a_part );
 
 #endif /* ROBODOC_ANALYSER_H */
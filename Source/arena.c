@@ -0,0 +1,309 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Arena
+ * FUNCTION
+ *   Region allocation for the document model.  The headers of a
+ *   part, their lines, names and items are all taken from the
+ *   arena of the part, see RB_Part.  This needs one malloc() per
+ *   RB_ARENA_BLOCK_SIZE bytes instead of one per object, and all
+ *   of it is released at once when the part is freed.
+ *****
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "robodoc.h"
+#include "arena.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+/****id* Arena/RB_ARENA_ALIGN
+ * FUNCTION
+ *   All objects start at a multiple of this, so any structure
+ *   can be stored in an arena.
+ * SOURCE
+ */
+
+#define RB_ARENA_ALIGN 16
+
+/*******/
+
+
+/****id* Arena/RB_ARENA_ROUND
+ * FUNCTION
+ *   Round a size up to a multiple of RB_ARENA_ALIGN.
+ * SOURCE
+ */
+
+#define RB_ARENA_ROUND( size ) \
+    ( ( ( size ) + RB_ARENA_ALIGN - 1 ) & ~( ( size_t ) RB_ARENA_ALIGN - 1 ) )
+
+/*******/
+
+
+/****if* Arena/Block_Data
+ * FUNCTION
+ *   The memory of a block.
+ * SOURCE
+ */
+
+static char        *Block_Data(
+    struct RB_Arena_Block *block )
+{
+    return ( char * ) block + RB_ARENA_ROUND( sizeof( struct RB_Arena_Block ) );
+}
+
+/*******/
+
+
+/****f* Arena/RB_Init_Arena
+ * FUNCTION
+ *   Make an arena empty.  Memory it still holds is not freed.
+ * SOURCE
+ */
+
+void RB_Init_Arena(
+    struct RB_Arena *arena )
+{
+    arena->blocks = NULL;
+    arena->current = NULL;
+}
+
+/*******/
+
+
+/****f* Arena/RB_Arena_Alloc
+ * FUNCTION
+ *   Allocate memory from an arena.  It can not be freed on its
+ *   own.
+ * SYNOPSIS
+ */
+void               *RB_Arena_Alloc(
+    struct RB_Arena *arena,
+    size_t size )
+/*
+ * INPUTS
+ *   o arena -- the arena.
+ *   o size  -- the number of bytes.
+ * RESULT
+ *   The memory, aligned for any structure.  The program is
+ *   aborted if there is no memory left.
+ * SOURCE
+ */
+{
+    struct RB_Arena_Block *block = arena->current;
+    size_t              rounded = RB_ARENA_ROUND( size ? size : 1 );
+    char               *memory;
+
+    if ( !block || ( block->size - block->used < rounded ) )
+    {
+        size_t              block_size = RB_ARENA_BLOCK_SIZE;
+
+        if ( rounded > RB_ARENA_BLOCK_SIZE / 4 )
+        {
+            /* It gets a block of its own, and the current block
+             * stays in use. */
+            block_size = rounded;
+        }
+        block = malloc( RB_ARENA_ROUND( sizeof( struct RB_Arena_Block ) ) +
+                        block_size );
+        RB_Mem_Check( block );
+        block->size = block_size;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        if ( block_size == RB_ARENA_BLOCK_SIZE || !arena->current )
+        {
+            arena->current = block;
+        }
+    }
+    memory = Block_Data( block ) + block->used;
+    block->used += rounded;
+    return memory;
+}
+
+/*******/
+
+
+/****f* Arena/RB_Arena_Calloc
+ * FUNCTION
+ *   Allocate memory for an array from an arena, and set it to
+ *   zero.
+ * SOURCE
+ */
+
+void               *RB_Arena_Calloc(
+    struct RB_Arena *arena,
+    size_t count,
+    size_t size )
+{
+    void               *memory = RB_Arena_Alloc( arena, count * size );
+
+    memset( memory, 0, count * size );
+    return memory;
+}
+
+/*******/
+
+
+/****f* Arena/RB_Arena_StrDupLen
+ * FUNCTION
+ *   Copy the first length characters of a string into an arena.
+ * SOURCE
+ */
+
+char               *RB_Arena_StrDupLen(
+    struct RB_Arena *arena,
+    char *str,
+    size_t length )
+{
+    char               *copy = RB_Arena_Alloc( arena, length + 1 );
+
+    memcpy( copy, str, length );
+    copy[length] = '\0';
+    return copy;
+}
+
+/*******/
+
+
+/****f* Arena/RB_Arena_StrDup
+ * FUNCTION
+ *   Copy a string into an arena.
+ * SOURCE
+ */
+
+char               *RB_Arena_StrDup(
+    struct RB_Arena *arena,
+    char *str )
+{
+    return RB_Arena_StrDupLen( arena, str, strlen( str ) );
+}
+
+/*******/
+
+
+/****f* Arena/RB_Mark_Arena
+ * FUNCTION
+ *   Remember the state of an arena, so all that is allocated
+ *   after this can be released with RB_Release_Arena().
+ * SOURCE
+ */
+
+void RB_Mark_Arena(
+    struct RB_Arena *arena,
+    struct RB_Arena_Mark *mark )
+{
+    mark->blocks = arena->blocks;
+    mark->current = arena->current;
+    mark->used = arena->current ? arena->current->used : 0;
+}
+
+/*******/
+
+
+/****f* Arena/RB_Release_Arena
+ * FUNCTION
+ *   Release all memory that was allocated from an arena since it
+ *   was marked with RB_Mark_Arena().
+ * SOURCE
+ */
+
+void RB_Release_Arena(
+    struct RB_Arena *arena,
+    struct RB_Arena_Mark *mark )
+{
+    while ( arena->blocks != mark->blocks )
+    {
+        struct RB_Arena_Block *next = arena->blocks->next;
+
+        free( arena->blocks );
+        arena->blocks = next;
+    }
+    arena->current = mark->current;
+    if ( arena->current )
+    {
+        arena->current->used = mark->used;
+    }
+}
+
+/*******/
+
+
+/****f* Arena/RB_Move_Arena
+ * FUNCTION
+ *   Hand all memory of one arena over to another arena, so it is
+ *   freed with that arena.  The first arena is left empty.
+ * SOURCE
+ */
+
+void RB_Move_Arena(
+    struct RB_Arena *to,
+    struct RB_Arena *from )
+{
+    if ( from->blocks )
+    {
+        struct RB_Arena_Block *last = from->blocks;
+
+        while ( last->next )
+        {
+            last = last->next;
+        }
+        last->next = to->blocks;
+        to->blocks = from->blocks;
+        if ( !to->current )
+        {
+            to->current = from->current;
+        }
+    }
+    RB_Init_Arena( from );
+}
+
+/*******/
+
+
+/****f* Arena/RB_Free_Arena
+ * FUNCTION
+ *   Free all memory of an arena, and leave it empty.
+ * SOURCE
+ */
+
+void RB_Free_Arena(
+    struct RB_Arena *arena )
+{
+    struct RB_Arena_Block *block;
+    struct RB_Arena_Block *next;
+
+    for ( block = arena->blocks; block; block = next )
+    {
+        next = block->next;
+        free( block );
+    }
+    RB_Init_Arena( arena );
+}
+
+/*******/
@@ -0,0 +1,127 @@
+#ifndef ROBODOC_ARENA_H
+#define ROBODOC_ARENA_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stddef.h>
+
+/****d* Arena/RB_ARENA_BLOCK_SIZE
+ * FUNCTION
+ *   The size of the blocks of memory an arena gets from malloc().
+ *   Larger requests get a block of their own.
+ * SOURCE
+ */
+
+#define RB_ARENA_BLOCK_SIZE 65536
+
+/*******/
+
+
+/****s* Arena/RB_Arena_Block
+ * FUNCTION
+ *   A block of memory of an arena.  The memory that is handed out
+ *   follows the structure.
+ * ATTRIBUTES
+ *   o next -- the block that was allocated before this one.
+ *   o size -- the number of bytes after the structure.
+ *   o used -- the number of them that were handed out.
+ * SOURCE
+ */
+
+struct RB_Arena_Block
+{
+    struct RB_Arena_Block *next;
+    size_t              size;
+    size_t              used;
+};
+
+/*******/
+
+
+/****s* Arena/RB_Arena
+ * FUNCTION
+ *   A region of memory from which many small objects are
+ *   allocated, and that is freed as a whole with
+ *   RB_Free_Arena().  An arena that is all zeros is empty and
+ *   ready to use.  An arena should only be used by one thread at
+ *   a time.
+ * ATTRIBUTES
+ *   o blocks  -- all blocks, the last allocated one first.
+ *   o current -- the block small objects are taken from.
+ * SOURCE
+ */
+
+struct RB_Arena
+{
+    struct RB_Arena_Block *blocks;
+    struct RB_Arena_Block *current;
+};
+
+/*******/
+
+
+/****s* Arena/RB_Arena_Mark
+ * FUNCTION
+ *   The state of an arena at some moment, see RB_Mark_Arena() and
+ *   RB_Release_Arena().
+ * SOURCE
+ */
+
+struct RB_Arena_Mark
+{
+    struct RB_Arena_Block *blocks;
+    struct RB_Arena_Block *current;
+    size_t              used;
+};
+
+/*******/
+
+
+void                RB_Init_Arena(
+    struct RB_Arena *arena );
+void               *RB_Arena_Alloc(
+    struct RB_Arena *arena,
+    size_t size );
+void               *RB_Arena_Calloc(
+    struct RB_Arena *arena,
+    size_t count,
+    size_t size );
+char               *RB_Arena_StrDup(
+    struct RB_Arena *arena,
+    char *str );
+char               *RB_Arena_StrDupLen(
+    struct RB_Arena *arena,
+    char *str,
+    size_t length );
+void                RB_Mark_Arena(
+    struct RB_Arena *arena,
+    struct RB_Arena_Mark *mark );
+void                RB_Release_Arena(
+    struct RB_Arena *arena,
+    struct RB_Arena_Mark *mark );
+void                RB_Move_Arena(
+    struct RB_Arena *to,
+    struct RB_Arena *from );
+void                RB_Free_Arena(
+    struct RB_Arena *arena );
+
+#endif /* ROBODOC_ARENA_H */
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 #include "ascii_generator.h"
 #include "util.h"
@@ -202,7 +203,24 @@ void RB_ASCII_Generate_Item_End(
 }
 
 
-static int          section_counters[ASCII_MAX_SECTION_DEPTH];
+static ROBO_THREAD_LOCAL int section_counters[ASCII_MAX_SECTION_DEPTH + 1];
+
+
+/****f* ASCII_Generator/RB_ASCII_Reset_Section_Counters
+ * FUNCTION
+ *   Start numbering the sections from 1 again.
+ * SOURCE
+ */
+
+void RB_ASCII_Reset_Section_Counters(
+    void )
+{
+    memset( section_counters, 0, sizeof( section_counters ) );
+}
+
+/*******/
+
+
 void RB_ASCII_Generate_BeginSection(
     FILE *dest_doc,
     int depth,
@@ -211,44 +229,41 @@ void RB_ASCII_Generate_BeginSection(
 {
     int                 i;
 
-    ++section_counters[depth];
-    for ( i = depth + 1; i < ASCII_MAX_SECTION_DEPTH; ++i )
+    /* Sections deeper than there are counters are not numbered. */
+    if ( depth <= ASCII_MAX_SECTION_DEPTH )
     {
-        section_counters[i] = 0;
+        ++section_counters[depth];
+        for ( i = depth + 1; i <= ASCII_MAX_SECTION_DEPTH; ++i )
+        {
+            section_counters[i] = 0;
+        }
     }
-    if ( depth < ASCII_MAX_SECTION_DEPTH )
+    if ( !( course_of_action.do_sectionnameonly ) &&
+         ( depth <= ASCII_MAX_SECTION_DEPTH ) )
     {
-        if ( !( course_of_action.do_sectionnameonly ) )
+        for ( i = 1; i <= depth; ++i )
         {
-            for ( i = 1; i <= depth; ++i )
-            {
-                fprintf( dest_doc, "%d.", section_counters[i] );
-            }
-            fprintf( dest_doc, "  " );
+            fprintf( dest_doc, "%d.", section_counters[i] );
         }
+        fprintf( dest_doc, "  " );
+    }
 
-        /*  Print Header "first" name */
-        RB_ASCII_Generate_String( dest_doc, name );
-
-        /*  Print further names */
-        for ( i = 1; i < header->no_names; i++ )
-        {
-            fprintf( dest_doc, ( i % header_breaks ) ? ", " : ",\n" );
-            RB_ASCII_Generate_String( dest_doc, header->names[i] );
-        }
+    /*  Print Header "first" name */
+    RB_ASCII_Generate_String( dest_doc, name );
 
-        /*  Include module name if not sectionnameonly */
-        if ( !( course_of_action.do_sectionnameonly ) )
-        {
-            fprintf( dest_doc, " [ " );
-            RB_ASCII_Generate_String( dest_doc, header->htype->indexName );
-            fprintf( dest_doc, " ]" );
-        }
+    /*  Print further names */
+    for ( i = 1; i < header->no_names; i++ )
+    {
+        fprintf( dest_doc, ( i % header_breaks ) ? ", " : ",\n" );
+        RB_ASCII_Generate_String( dest_doc, header->names[i] );
     }
-    else
+
+    /*  Include module name if not sectionnameonly */
+    if ( !( course_of_action.do_sectionnameonly ) )
     {
-        /* too deep, don't do anything. */
-        assert( 0 );
+        fprintf( dest_doc, " [ " );
+        RB_ASCII_Generate_String( dest_doc, header->htype->indexName );
+        fprintf( dest_doc, " ]" );
     }
 }
 
@@ -64,6 +64,8 @@ void                RB_ASCII_Generate_Char(
 void                RB_ASCII_Generate_Item_End(
     FILE *dest_doc );
 
+void                RB_ASCII_Reset_Section_Counters(
+    void );
 void RB_ASCII_Generate_BeginSection(
     FILE *dest_doc,
     int depth,
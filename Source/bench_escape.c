@@ -0,0 +1,202 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Escape_Benchmark
+ * FUNCTION
+ *   Microbenchmark for the HTML escaping of RB_Generate_Chars().
+ *   It escapes a large text in memory, once one character at a time
+ *   the way RB_HTML_Generate_Char() does it, and once with each
+ *   RB_Find_Markup_Char() implementation the processor supports,
+ *   and prints the speed of each in GB/s.
+ * SYNOPSIS
+ *   make -f makefile.plain bench_escape
+ *   ./bench_escape [megabytes] [repeats]
+ *****
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "escape.h"
+
+static const char   sample[] =
+    "   Generate a single character in the current output mode.\n"
+    "   if ( a < b && b > c ) { return list->next; }\n"
+    "   The individual generators make sure that special characters\n"
+    "   are escaped, see RB_HTML_Generate_Char() and friends.\n";
+
+/* Escape one character at a time, as RB_HTML_Generate_Char() does */
+
+static size_t Escape_Per_Char(
+    const char *text,
+    size_t length,
+    char *out )
+{
+    char               *o = out;
+    size_t              i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        switch ( text[i] )
+        {
+        case '<':
+            memcpy( o, "&lt;", 4 );
+            o += 4;
+            break;
+        case '>':
+            memcpy( o, "&gt;", 4 );
+            o += 4;
+            break;
+        case '&':
+            memcpy( o, "&amp;", 5 );
+            o += 5;
+            break;
+        default:
+            *o++ = text[i];
+        }
+    }
+    return o - out;
+}
+
+/* Escape runs, as RB_Generate_Chars() does */
+
+static size_t Escape_Runs(
+    const char *text,
+    size_t length,
+    char *out )
+{
+    const char         *end = text + length;
+    char               *o = out;
+    size_t              run;
+
+    while ( text < end )
+    {
+        run = RB_Find_Markup_Char( text, end - text );
+        memcpy( o, text, run );
+        o += run;
+        text += run;
+        if ( text < end )
+        {
+            switch ( *text )
+            {
+            case '<':
+                memcpy( o, "&lt;", 4 );
+                o += 4;
+                break;
+            case '>':
+                memcpy( o, "&gt;", 4 );
+                o += 4;
+                break;
+            case '&':
+                memcpy( o, "&amp;", 5 );
+                o += 5;
+                break;
+            default:
+                *o++ = *text;
+            }
+            ++text;
+        }
+    }
+    return o - out;
+}
+
+static void Report(
+    const char *name,
+    size_t length,
+    int repeats,
+    clock_t start,
+    size_t out_length )
+{
+    double              seconds =
+        ( double ) ( clock(  ) - start ) / CLOCKS_PER_SEC;
+
+    printf( "%-10s %8.2f GB/s  (%lu bytes out)\n", name,
+            seconds > 0 ? ( double ) length * repeats / seconds / 1e9 : 0.0,
+            ( unsigned long ) out_length );
+}
+
+int main(
+    int argc,
+    char **argv )
+{
+    size_t              megabytes = ( argc > 1 ) ? atoi( argv[1] ) : 64;
+    int                 repeats = ( argc > 2 ) ? atoi( argv[2] ) : 10;
+    size_t              length = megabytes * 1024 * 1024;
+    size_t              sample_length = strlen( sample );
+    size_t              out_length = 0;
+    char               *text = malloc( length );
+    char               *out = malloc( length * 5 );
+    size_t              i;
+    int                 r;
+    clock_t             start;
+    static const struct
+    {
+        enum RB_Markup_Scanner scanner;
+        const char         *name;
+    } scanners[] =
+    {
+        {
+        RB_SCAN_PLAIN, "plain"},
+        {
+        RB_SCAN_SSE2, "sse2"},
+        {
+        RB_SCAN_AVX2, "avx2"}
+    };
+
+    if ( !text || !out )
+    {
+        fprintf( stderr, "Out of memory!\n" );
+        return EXIT_FAILURE;
+    }
+    /* No newlines, they never reach the generators. */
+    for ( i = 0; i < length; ++i )
+    {
+        char                c = sample[i % sample_length];
+
+        text[i] = ( c == '\n' ) ? ' ' : c;
+    }
+
+    start = clock(  );
+    for ( r = 0; r < repeats; ++r )
+    {
+        out_length = Escape_Per_Char( text, length, out );
+    }
+    Report( "per char", length, repeats, start, out_length );
+
+    for ( i = 0; i < sizeof( scanners ) / sizeof( scanners[0] ); ++i )
+    {
+        if ( RB_Use_Markup_Scanner( scanners[i].scanner ) )
+        {
+            start = clock(  );
+            for ( r = 0; r < repeats; ++r )
+            {
+                out_length = Escape_Runs( text, length, out );
+            }
+            Report( scanners[i].name, length, repeats, start, out_length );
+        }
+    }
+
+    free( text );
+    free( out );
+    return EXIT_SUCCESS;
+}
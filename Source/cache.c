@@ -0,0 +1,1873 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Cache
+ * FUNCTION
+ *   A persistent cache of the analysis of the source files, used
+ *   with the --cache option.  For each source file the cache
+ *   directory holds one file with the headers that were found in
+ *   it, including the lines and the analysed items of each header.
+ *   When the source file has not changed since the previous run,
+ *   these headers are used instead of analysing the file again.
+ *
+ *   An entry is used when
+ *   * it was made with the same version of ROBODoc, the same
+ *     robodoc.rc file, and the same options,
+ *   * and the source file has the same size and modification
+ *     time as when the entry was made, or, if these differ or
+ *     can not be trusted, the same content.
+ *
+ *   A modification time is only trusted when it is older than the
+ *   entry itself.  A file that is changed within the same second
+ *   in which it was analysed is therefore still recognised.
+ *
+ *   The entries are only written for source files that gave no
+ *   warnings, so a run that uses the cache gives the same
+ *   warnings as a run that does not.
+ *
+ *   With --multidoc the cache also holds, for each documentation
+ *   directory, an output manifest.  It records for each part which
+ *   documentation files were generated from it, and a hash of the
+ *   content of its headers.  A part whose content did not change
+ *   is not generated again, as long as its documentation files
+ *   are still there, and the structure of the whole document is
+ *   the same.  The structure is everything that ends up in more
+ *   than one documentation file: the names, labels, and
+ *   documentation files of all headers, and so of all links.
+ *   If it changes, all documentation is generated again.
+ *****
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "robodoc.h"
+#include "cache.h"
+#include "globals.h"
+#include "headertypes.h"
+#include "items.h"
+#include "file.h"
+#include "document.h"
+#include "roboconfig.h"
+#include "util.h"
+#include "intern.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+/****id* Cache/RB_CACHE_MAGIC
+ * FUNCTION
+ *   The first bytes of each cache entry.  The last one is the
+ *   version of the format, change it whenever the format changes.
+ * SOURCE
+ */
+
+#define RB_CACHE_MAGIC      "RBC\001"
+#define RB_CACHE_MAGIC_SIZE 4
+
+/*******/
+
+
+/****id* Cache/RB_OUTPUT_MAGIC
+ * FUNCTION
+ *   The first bytes of each output manifest, see RB_CACHE_MAGIC.
+ * SOURCE
+ */
+
+#define RB_OUTPUT_MAGIC     "RBO\001"
+#define RB_OUTPUT_MAGIC_SIZE 4
+
+/*******/
+
+
+/****id* Cache/RB_CACHE_STAT_OFFSET
+ * FUNCTION
+ *   The offset of the size, modification time, content hash and
+ *   time of writing of the source file in a cache entry.  They
+ *   follow the magic and the configuration hash, and are
+ *   updated in place by Refresh_Entry().
+ * SOURCE
+ */
+
+#define RB_CACHE_STAT_OFFSET ( RB_CACHE_MAGIC_SIZE + 8 )
+
+/*******/
+
+
+/****id* Cache/RB_FNV_OFFSET
+ * FUNCTION
+ *   Start value and prime of the 64 bit FNV-1a hash.
+ * SOURCE
+ */
+
+#define RB_FNV_OFFSET       14695981039346656037ULL
+#define RB_FNV_PRIME        1099511628211ULL
+
+/*******/
+
+
+/****is* Cache/RB_Cache_Reader
+ * FUNCTION
+ *   The position in a cache entry that is being read.
+ *   failed is set as soon as something is read beyond the
+ *   end of the entry, or something does not make sense.
+ * SOURCE
+ */
+
+struct RB_Cache_Reader
+{
+    unsigned char      *data;
+    size_t              size;
+    size_t              position;
+    int                 failed;
+};
+
+/*******/
+
+
+/****if* Cache/Hash_Bytes
+ * FUNCTION
+ *   Add a number of bytes to a 64 bit FNV-1a hash.
+ * SYNOPSIS
+ */
+static unsigned long long Hash_Bytes(
+    unsigned long long hash,
+    const void *data,
+    size_t length )
+/*
+ * INPUTS
+ *   o hash   -- the hash so far, RB_FNV_OFFSET to start with.
+ *   o data   -- the bytes.
+ *   o length -- the number of bytes.
+ * RESULT
+ *   The new hash.
+ * SOURCE
+ */
+{
+    const unsigned char *bytes = data;
+    size_t              i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        hash ^= bytes[i];
+        hash *= RB_FNV_PRIME;
+    }
+    return hash;
+}
+
+/*******/
+
+
+/****if* Cache/Hash_String
+ * FUNCTION
+ *   Add a string, including its terminating '\0', to a hash.
+ * SOURCE
+ */
+
+static unsigned long long Hash_String(
+    unsigned long long hash,
+    const char *string )
+{
+    return Hash_Bytes( hash, string, strlen( string ) + 1 );
+}
+
+/*******/
+
+
+/****if* Cache/Hash_File
+ * FUNCTION
+ *   Add the content of a file to a hash.  Nothing is added if
+ *   the file can not be read.
+ * SOURCE
+ */
+
+static unsigned long long Hash_File(
+    unsigned long long hash,
+    char *file_name )
+{
+    FILE               *file = fopen( file_name, "rb" );
+
+    if ( file )
+    {
+        char                block[4096];
+        size_t              n;
+
+        while ( ( n = fread( block, 1, sizeof( block ), file ) ) > 0 )
+        {
+            hash = Hash_Bytes( hash, block, n );
+        }
+        fclose( file );
+    }
+    return hash;
+}
+
+/*******/
+
+
+/****if* Cache/Is_Ignored_Option
+ * FUNCTION
+ *   Check if an option has no influence on the analysis of the
+ *   source files, and should not invalidate the cache.
+ * SYNOPSIS
+ */
+static int Is_Ignored_Option(
+    char *option,
+    int *has_parameter )
+/*
+ * INPUTS
+ *   o option -- the option.
+ * OUTPUT
+ *   o has_parameter -- TRUE if the option is followed by a
+ *                      parameter that should be ignored too.
+ * RESULT
+ *   TRUE if the option should be ignored.
+ * SOURCE
+ */
+{
+    *has_parameter = FALSE;
+    /* The names of the source files are part of the key of
+     * the entries, so --src does not matter either. */
+    if ( ( strcmp( option, "--jobs" ) == 0 ) ||
+         ( strcmp( option, "--cache" ) == 0 ) ||
+         ( strcmp( option, "--src" ) == 0 ) ||
+         ( strcmp( option, "--doc" ) == 0 ) )
+    {
+        *has_parameter = TRUE;
+        return TRUE;
+    }
+    return ( strcmp( option, "--tell" ) == 0 ) ||
+        ( strcmp( option, "--debug" ) == 0 );
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Create
+ * FUNCTION
+ *   Open the cache directory, and create it if it does not
+ *   exist yet.  The configuration hash is computed from the
+ *   version of ROBODoc, the content of the robodoc.rc file,
+ *   and all the options (from the command line and the
+ *   robodoc.rc file) that can influence the analysis.
+ * SYNOPSIS
+ */
+struct RB_Cache    *RB_Cache_Create(
+    char *directory,
+    char *rc_file_name )
+/*
+ * INPUTS
+ *   o directory    -- the name of the cache directory.
+ *   o rc_file_name -- the robodoc.rc file that was used, or NULL.
+ * RESULT
+ *   The cache.
+ * SOURCE
+ */
+{
+    struct RB_Cache    *cache = malloc( sizeof( struct RB_Cache ) );
+    struct stat         dirstat;
+    unsigned long long  hash = RB_FNV_OFFSET;
+    unsigned int        i;
+
+    RB_Mem_Check( cache );
+    if ( stat( directory, &dirstat ) != 0 )
+    {
+        int                 result;
+
+#if defined(__MINGW32__)
+        result = mkdir( directory );
+#else
+        result = mkdir( directory, 0770 );
+#endif
+        if ( result != 0 )
+        {
+            perror( NULL );
+            RB_Panic( "Can't create directory %s\n", directory );
+        }
+    }
+    else if ( !S_ISDIR( dirstat.st_mode ) )
+    {
+        RB_Panic( "%s is not a directory\n", directory );
+    }
+    cache->directory = RB_StrDup( directory );
+
+    hash = Hash_String( hash, RB_CACHE_MAGIC VERSION );
+    if ( rc_file_name )
+    {
+        hash = Hash_File( hash, rc_file_name );
+    }
+    /* The first option is the name of the program. */
+    for ( i = 1; i < configuration.options.number; ++i )
+    {
+        int                 has_parameter;
+
+        if ( Is_Ignored_Option( configuration.options.names[i],
+                                &has_parameter ) )
+        {
+            if ( has_parameter )
+            {
+                ++i;
+            }
+        }
+        else
+        {
+            hash = Hash_String( hash, configuration.options.names[i] );
+        }
+    }
+    cache->config_hash = hash;
+    return cache;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Free
+ * FUNCTION
+ *   Free a cache.
+ * SOURCE
+ */
+
+void RB_Cache_Free(
+    struct RB_Cache *cache )
+{
+    if ( cache )
+    {
+        free( cache->directory );
+        free( cache );
+    }
+}
+
+/*******/
+
+
+/****if* Cache/Put_Bytes
+ * FUNCTION
+ *   Append a number of bytes to a cache buffer.
+ * SOURCE
+ */
+
+static void Put_Bytes(
+    struct RB_Cache_Buffer *buffer,
+    const void *data,
+    size_t length )
+{
+    if ( length == 0 )
+    {
+        return;
+    }
+    if ( buffer->size + length > buffer->allocated )
+    {
+        buffer->allocated = 2 * buffer->allocated + length + 256;
+        buffer->data = realloc( buffer->data, buffer->allocated );
+        RB_Mem_Check( buffer->data );
+    }
+    memcpy( buffer->data + buffer->size, data, length );
+    buffer->size += length;
+}
+
+/*******/
+
+
+/****if* Cache/Encode_Number
+ * FUNCTION
+ *   Store a number in a number of bytes, least significant
+ *   byte first, so the entries do not depend on the byte
+ *   order of the machine.
+ * SOURCE
+ */
+
+static void Encode_Number(
+    unsigned char *bytes,
+    unsigned long long value,
+    int no_bytes )
+{
+    int                 i;
+
+    for ( i = 0; i < no_bytes; ++i )
+    {
+        bytes[i] = ( unsigned char ) ( value & 0xFF );
+        value >>= 8;
+    }
+}
+
+/*******/
+
+
+/****if* Cache/Put_Wide
+ * FUNCTION
+ *   Append a 64 bit number to a cache buffer.
+ * SOURCE
+ */
+
+static void Put_Wide(
+    struct RB_Cache_Buffer *buffer,
+    unsigned long long value )
+{
+    unsigned char       bytes[8];
+
+    Encode_Number( bytes, value, 8 );
+    Put_Bytes( buffer, bytes, 8 );
+}
+
+/*******/
+
+
+/****if* Cache/Put_Int
+ * FUNCTION
+ *   Append a 32 bit number to a cache buffer.
+ * SOURCE
+ */
+
+static void Put_Int(
+    struct RB_Cache_Buffer *buffer,
+    long value )
+{
+    unsigned char       bytes[4];
+
+    Encode_Number( bytes, ( unsigned long ) value, 4 );
+    Put_Bytes( buffer, bytes, 4 );
+}
+
+/*******/
+
+
+/****if* Cache/Put_String
+ * FUNCTION
+ *   Append a string to a cache buffer: its length, or -1 for
+ *   NULL, followed by the characters.
+ * SOURCE
+ */
+
+static void Put_String(
+    struct RB_Cache_Buffer *buffer,
+    char *string )
+{
+    if ( string )
+    {
+        size_t              length = strlen( string );
+
+        Put_Int( buffer, ( long ) length );
+        Put_Bytes( buffer, string, length );
+    }
+    else
+    {
+        Put_Int( buffer, -1 );
+    }
+}
+
+/*******/
+
+
+/****if* Cache/Get_Number
+ * FUNCTION
+ *   Read a number that was stored with Encode_Number().
+ * SOURCE
+ */
+
+static unsigned long long Get_Number(
+    struct RB_Cache_Reader *reader,
+    int no_bytes )
+{
+    unsigned long long  value = 0;
+    int                 i;
+
+    if ( reader->failed || reader->size - reader->position < ( size_t ) no_bytes )
+    {
+        reader->failed = TRUE;
+        return 0;
+    }
+    for ( i = no_bytes - 1; i >= 0; --i )
+    {
+        value = ( value << 8 ) | reader->data[reader->position + i];
+    }
+    reader->position += no_bytes;
+    return value;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Int
+ * FUNCTION
+ *   Read a number that was stored with Put_Int().
+ * SOURCE
+ */
+
+static long Get_Int(
+    struct RB_Cache_Reader *reader )
+{
+    unsigned long       value = ( unsigned long ) Get_Number( reader, 4 );
+
+    /* Restore the sign. */
+    if ( value & 0x80000000UL )
+    {
+        return -( long ) ( ( ~value & 0x7FFFFFFFUL ) + 1 );
+    }
+    return ( long ) value;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Count
+ * FUNCTION
+ *   Read the number of things that follow.  It should not be
+ *   negative, and each of the things takes at least one byte.
+ * SOURCE
+ */
+
+static int Get_Count(
+    struct RB_Cache_Reader *reader )
+{
+    long                count = Get_Int( reader );
+
+    if ( count < 0 || ( size_t ) count > reader->size - reader->position )
+    {
+        reader->failed = TRUE;
+        return 0;
+    }
+    return ( int ) count;
+}
+
+/*******/
+
+
+/****if* Cache/Get_String_Data
+ * FUNCTION
+ *   Read a string that was stored with Put_String(), without
+ *   copying it.
+ * SYNOPSIS
+ */
+static char        *Get_String_Data(
+    struct RB_Cache_Reader *reader,
+    size_t *length )
+/*
+ * OUTPUT
+ *   o length -- the length of the string.
+ * RESULT
+ *   The string in the data of the reader, it is not '\0'
+ *   terminated.  NULL if there is no string.
+ * SOURCE
+ */
+{
+    long                stored_length = Get_Int( reader );
+    char               *data;
+
+    if ( reader->failed || stored_length < 0 )
+    {
+        return NULL;
+    }
+    if ( ( size_t ) stored_length > reader->size - reader->position )
+    {
+        reader->failed = TRUE;
+        return NULL;
+    }
+    data = ( char * ) reader->data + reader->position;
+    reader->position += stored_length;
+    *length = ( size_t ) stored_length;
+    return data;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Arena_String
+ * FUNCTION
+ *   Read a string that was stored with Put_String() into an
+ *   arena.
+ * INPUTS
+ *   o reader -- the reader.
+ *   o arena  -- the arena, or NULL to allocate the copy with
+ *               malloc().
+ * RESULT
+ *   A copy of the string, or NULL.
+ * SOURCE
+ */
+
+static char        *Get_Arena_String(
+    struct RB_Cache_Reader *reader,
+    struct RB_Arena *arena )
+{
+    size_t              length;
+    char               *data = Get_String_Data( reader, &length );
+
+    if ( !data )
+    {
+        return NULL;
+    }
+    return arena ? RB_Arena_StrDupLen( arena, data, length )
+        : RB_StrDupLen( data, length );
+}
+
+/*******/
+
+
+/****if* Cache/Get_Interned_String
+ * FUNCTION
+ *   Read a string that was stored with Put_String(), and intern
+ *   it.
+ * RESULT
+ *   The interned string, or NULL.
+ * SOURCE
+ */
+
+static char        *Get_Interned_String(
+    struct RB_Cache_Reader *reader )
+{
+    size_t              length;
+    char               *data = Get_String_Data( reader, &length );
+
+    return data ? RB_Intern_StrLen( data, length ) : NULL;
+}
+
+/*******/
+
+
+/****if* Cache/Get_String
+ * FUNCTION
+ *   Read a string that was stored with Put_String().
+ * RESULT
+ *   A copy of the string, or NULL.
+ * SOURCE
+ */
+
+static char        *Get_String(
+    struct RB_Cache_Reader *reader )
+{
+    return Get_Arena_String( reader, NULL );
+}
+
+/*******/
+
+
+/****if* Cache/Entry_File_Name
+ * FUNCTION
+ *   Compute the name of the file in which the cache entry of a
+ *   source file, or the output manifest of a documentation
+ *   directory, is stored.  It is the hash of the configuration
+ *   and the name of the file or directory, so runs with different
+ *   options can share a cache directory.  Both are also stored
+ *   in the entry, in case two names have the same hash.
+ * SYNOPSIS
+ */
+static char        *Entry_File_Name(
+    struct RB_Cache *cache,
+    char *name,
+    char *extension )
+/*
+ * INPUTS
+ *   o cache     -- the cache.
+ *   o name      -- the name of the source file or directory.
+ *   o extension -- "rbc" for source files, "rbo" for manifests.
+ * SOURCE
+ */
+{
+    unsigned long long  hash = Hash_Bytes( RB_FNV_OFFSET,
+                                           &( cache->config_hash ),
+                                           sizeof( cache->config_hash ) );
+    char               *file_name =
+        malloc( strlen( cache->directory ) + strlen( extension ) + 32 );
+
+    RB_Mem_Check( file_name );
+    hash = Hash_String( hash, name );
+    sprintf( file_name, "%s/%08lx%08lx.%s", cache->directory,
+             ( unsigned long ) ( hash >> 32 ),
+             ( unsigned long ) ( hash & 0xFFFFFFFFUL ), extension );
+    return file_name;
+}
+
+/*******/
+
+
+/****if* Cache/Hash_Source
+ * FUNCTION
+ *   Compute the hash of the content of a source file.
+ * SOURCE
+ */
+
+static unsigned long long Hash_Source(
+    struct RB_Source_Reader *reader )
+{
+    return Hash_Bytes( RB_FNV_OFFSET, reader->data, reader->size );
+}
+
+/*******/
+
+
+/****if* Cache/Read_Entry_File
+ * FUNCTION
+ *   Read a complete cache entry into memory.
+ * SYNOPSIS
+ */
+static int Read_Entry_File(
+    char *file_name,
+    struct RB_Cache_Reader *reader )
+/*
+ * RESULT
+ *   TRUE if the file could be read.
+ * SOURCE
+ */
+{
+    FILE               *file = fopen( file_name, "rb" );
+    struct stat         filestat;
+
+    if ( !file )
+    {
+        return FALSE;
+    }
+    if ( fstat( fileno( file ), &filestat ) != 0 )
+    {
+        fclose( file );
+        return FALSE;
+    }
+    reader->size = ( size_t ) filestat.st_size;
+    reader->position = 0;
+    reader->failed = FALSE;
+    reader->data = malloc( reader->size + 1 );
+    RB_Mem_Check( reader->data );
+    if ( fread( reader->data, 1, reader->size, file ) != reader->size )
+    {
+        free( reader->data );
+        reader->data = NULL;
+        fclose( file );
+        return FALSE;
+    }
+    fclose( file );
+    return TRUE;
+}
+
+/*******/
+
+
+/****if* Cache/Write_Entry_File
+ * FUNCTION
+ *   Write a cache entry.  It is first written to a temporary
+ *   file that is then renamed, so another run never sees half
+ *   an entry.  Failures are ignored, the entry is then simply
+ *   not there the next time.
+ * SOURCE
+ */
+
+static void Write_Entry_File(
+    char *file_name,
+    unsigned char *data,
+    size_t size )
+{
+    char               *temp_name = malloc( strlen( file_name ) + 32 );
+    FILE               *file;
+
+    RB_Mem_Check( temp_name );
+    sprintf( temp_name, "%s.%ld.tmp", file_name, ( long ) getpid(  ) );
+    file = fopen( temp_name, "wb" );
+    if ( file )
+    {
+        int                 ok = ( fwrite( data, 1, size, file ) == size );
+
+        ok = ( fclose( file ) == 0 ) && ok;
+#if defined( _WIN32 )
+        remove( file_name );
+#endif
+        if ( !ok || rename( temp_name, file_name ) != 0 )
+        {
+            remove( temp_name );
+        }
+    }
+    free( temp_name );
+}
+
+/*******/
+
+
+/****if* Cache/Refresh_Entry
+ * FUNCTION
+ *   Store the new size and modification time of a source file
+ *   whose content did not change, so the next run does not have
+ *   to compare the content again.
+ * SOURCE
+ */
+
+static void Refresh_Entry(
+    struct RB_Cache_Entry *entry,
+    struct RB_Cache_Reader *reader )
+{
+    unsigned char      *stat_data = reader->data + RB_CACHE_STAT_OFFSET;
+
+    Encode_Number( stat_data, entry->size, 8 );
+    Encode_Number( stat_data + 8, entry->mtime, 8 );
+    Encode_Number( stat_data + 24, ( unsigned long long ) time( NULL ), 8 );
+    Write_Entry_File( entry->file_name, reader->data, reader->size );
+}
+
+/*******/
+
+
+/****if* Cache/Get_Item
+ * FUNCTION
+ *   Read an item of a header.  The item type, the kinds and pipe
+ *   modes of its lines, and its line indices are checked, because
+ *   the generators use them to index arrays.  A damaged entry
+ *   must not get that far.
+ * SYNOPSIS
+ */
+static struct RB_Item *Get_Item(
+    struct RB_Cache_Reader *reader,
+    struct RB_Arena *arena,
+    struct RB_header *header )
+/*
+ * INPUTS
+ *   o reader -- the reader.
+ *   o arena  -- the arena of the part the header belongs to.
+ *   o header -- the header, with its lines already read.
+ * RESULT
+ *   The item, or NULL if the entry is damaged.
+ * SOURCE
+ */
+{
+    long                type = Get_Int( reader );
+    struct RB_Item     *item;
+    int                 i;
+
+    if ( ( type < 0 ) || ( type >= ( long ) configuration.items.number ) )
+    {
+        reader->failed = TRUE;
+        return NULL;
+    }
+    item = RB_Create_Item( arena, ( enum ItemType ) type );
+    item->begin_index = ( int ) Get_Int( reader );
+    item->end_index = ( int ) Get_Int( reader );
+    item->max_line_number = ( int ) Get_Int( reader );
+    if ( ( item->begin_index < 0 ) ||
+         ( item->end_index < item->begin_index ) ||
+         ( item->end_index >= header->no_lines ) ||
+         ( item->max_line_number < 0 ) ||
+         ( item->max_line_number > header->line_number + header->no_lines ) )
+    {
+        reader->failed = TRUE;
+        return NULL;
+    }
+    item->no_lines = Get_Count( reader );
+    item->lines = RB_Arena_Calloc( arena, item->no_lines + 1,
+                                   sizeof( struct RB_Item_Line * ) );
+    for ( i = 0; i < item->no_lines && !reader->failed; ++i )
+    {
+        struct RB_Item_Line *itemline =
+            RB_Arena_Alloc( arena, sizeof( struct RB_Item_Line ) );
+        long                kind;
+        long                pipe_mode;
+
+        itemline->line = Get_Arena_String( reader, arena );
+        kind = Get_Int( reader );
+        itemline->format = Get_Int( reader );
+        pipe_mode = Get_Int( reader );
+        itemline->line_number = ( int ) Get_Int( reader );
+        if ( ( kind < ITEM_LINE_RAW ) || ( kind > ITEM_LINE_INCLUDE ) ||
+             ( pipe_mode < TEST ) || ( pipe_mode > UNKNOWN ) )
+        {
+            reader->failed = TRUE;
+            return NULL;
+        }
+        itemline->kind = ( enum ItemLineKind ) kind;
+        itemline->pipe_mode = ( T_RB_DocType ) pipe_mode;
+        item->lines[i] = itemline;
+    }
+    return reader->failed ? NULL : item;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Header
+ * FUNCTION
+ *   Read a header that was stored with RB_Cache_Add_Header().
+ * SYNOPSIS
+ */
+static struct RB_header *Get_Header(
+    struct RB_Cache_Reader *reader,
+    struct RB_Arena *arena,
+    int *added )
+/*
+ * INPUTS
+ *   o reader -- the reader.
+ *   o arena  -- the arena of the part the header belongs to.
+ * OUTPUT
+ *   o added -- TRUE if the header is to be added to the part.
+ * RESULT
+ *   The header, or NULL if the entry is damaged.
+ * SOURCE
+ */
+{
+    struct RB_header   *header = RB_Alloc_Header( arena );
+    int                 i;
+
+    header->no_names = Get_Count( reader );
+    header->names =
+        RB_Arena_Calloc( arena, header->no_names + 1, sizeof( char * ) );
+    for ( i = 0; i < header->no_names; ++i )
+    {
+        header->names[i] = Get_Interned_String( reader );
+    }
+    header->name = header->no_names ? header->names[0] : NULL;
+    header->line_number = ( int ) Get_Int( reader );
+    *added = ( int ) Get_Int( reader );
+    if ( *added && !reader->failed )
+    {
+        struct RB_Item     *last_item = NULL;
+        int                 no_items;
+
+        header->htype =
+            RB_FindHeaderType( ( unsigned char ) Get_Int( reader ) );
+        header->is_internal = ( int ) Get_Int( reader );
+        header->function_name = Get_Interned_String( reader );
+        header->module_name = Get_Interned_String( reader );
+        header->no_lines = Get_Count( reader );
+        header->lines =
+            RB_Arena_Calloc( arena, header->no_lines + 1,
+                             sizeof( struct RB_header_lines ) );
+        for ( i = 0; i < header->no_lines; ++i )
+        {
+            header->lines[i].line_number = ( int ) Get_Int( reader );
+            header->lines[i].line = Get_Arena_String( reader, arena );
+        }
+        no_items = Get_Count( reader );
+        for ( i = 0; i < no_items && !reader->failed; ++i )
+        {
+            struct RB_Item     *item = Get_Item( reader, arena, header );
+
+            if ( !item )
+            {
+                break;
+            }
+            if ( last_item )
+            {
+                last_item->next = item;
+            }
+            else
+            {
+                header->items = item;
+            }
+            last_item = item;
+        }
+        if ( !header->htype || !header->function_name ||
+             !header->module_name )
+        {
+            reader->failed = TRUE;
+        }
+    }
+    if ( reader->failed || !header->name )
+    {
+        /* Get_Headers() releases the memory. */
+        reader->failed = TRUE;
+        return NULL;
+    }
+    return header;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Headers
+ * FUNCTION
+ *   Read the headers of a cache entry into the arena of its part.
+ * RESULT
+ *   TRUE if all headers could be read.
+ * SOURCE
+ */
+
+static int Get_Headers(
+    struct RB_Cache_Entry *entry,
+    struct RB_Cache_Reader *reader,
+    struct RB_Arena *arena )
+{
+    int                 i;
+    struct RB_Arena_Mark mark;
+
+    entry->last_line_number = ( int ) Get_Int( reader );
+    entry->no_headers = Get_Count( reader );
+    entry->headers =
+        calloc( entry->no_headers + 1, sizeof( struct RB_header * ) );
+    entry->added = calloc( entry->no_headers + 1, sizeof( int ) );
+    RB_Mem_Check( entry->headers );
+    RB_Mem_Check( entry->added );
+    RB_Mark_Arena( arena, &mark );
+    for ( i = 0; i < entry->no_headers && !reader->failed; ++i )
+    {
+        entry->headers[i] =
+            Get_Header( reader, arena, &( entry->added[i] ) );
+    }
+    if ( reader->failed || reader->position != reader->size )
+    {
+        RB_Release_Arena( arena, &mark );
+        free( entry->headers );
+        free( entry->added );
+        entry->headers = NULL;
+        entry->added = NULL;
+        entry->no_headers = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*******/
+
+
+/****if* Cache/Is_Source_Unchanged
+ * FUNCTION
+ *   Check if the source file is still the same as when the
+ *   cache entry was written.
+ * SYNOPSIS
+ */
+static int Is_Source_Unchanged(
+    struct RB_Cache_Entry *entry,
+    struct RB_Cache_Reader *reader,
+    struct RB_Part *part )
+/*
+ * INPUTS
+ *   o entry  -- the entry, with the current size and modification
+ *               time of the source file.
+ *   o reader -- positioned just after the configuration hash.
+ *   o part   -- the part of the source file.
+ * SOURCE
+ */
+{
+    unsigned long long  size = Get_Number( reader, 8 );
+    unsigned long long  mtime = Get_Number( reader, 8 );
+    unsigned long long  content_hash = Get_Number( reader, 8 );
+    unsigned long long  written = Get_Number( reader, 8 );
+    char               *source_name = Get_String( reader );
+    int                 unchanged = FALSE;
+
+    if ( reader->failed || !source_name ||
+         strcmp( source_name, entry->source_name ) != 0 ||
+         size != entry->size )
+    {
+        /* Not the same file, or it changed. */
+    }
+    else if ( mtime == entry->mtime && mtime < written )
+    {
+        unchanged = TRUE;
+    }
+    else
+    {
+        struct RB_Source_Reader *source = part->filename->source;
+
+        if ( source )
+        {
+            /* Kept by the directory scan, and still unchanged. */
+            unchanged = ( Hash_Source( source ) == content_hash );
+        }
+        else
+        {
+            FILE               *filehandle = RB_Open_Source( part );
+
+            source = RB_Read_Source( filehandle );
+            fclose( filehandle );
+            unchanged = ( Hash_Source( source ) == content_hash );
+            RB_Free_Source_Reader( source );
+        }
+        if ( unchanged && entry->mtime < ( unsigned long long ) time( NULL ) )
+        {
+            Refresh_Entry( entry, reader );
+        }
+    }
+    free( source_name );
+    return unchanged;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Lookup
+ * FUNCTION
+ *   Look for the cache entry of the source file of a part.
+ *   This has to be done before the source file is read, so a
+ *   change that is made while it is read is noticed the next
+ *   time.
+ * SYNOPSIS
+ */
+struct RB_Cache_Entry *RB_Cache_Lookup(
+    struct RB_Cache *cache,
+    struct RB_Part *part )
+/*
+ * INPUTS
+ *   o cache -- the cache.
+ *   o part  -- the part.
+ * RESULT
+ *   The entry.  If hit is TRUE it contains the headers of the
+ *   source file, otherwise the source file has to be analysed,
+ *   and the headers can be added with RB_Cache_Add_Header() and
+ *   stored with RB_Cache_Store().
+ * SOURCE
+ */
+{
+    struct RB_Cache_Entry *entry = calloc( 1, sizeof( struct RB_Cache_Entry ) );
+    struct stat         filestat;
+    struct RB_Cache_Reader reader;
+
+    RB_Mem_Check( entry );
+    entry->source_name = RB_StrDup( Get_Fullname( part->filename ) );
+    entry->file_name = Entry_File_Name( cache, entry->source_name, "rbc" );
+    if ( stat( entry->source_name, &filestat ) != 0 )
+    {
+        /* RB_Open_Source() will complain. */
+        return entry;
+    }
+    entry->size = ( unsigned long long ) filestat.st_size;
+    entry->mtime = ( unsigned long long ) filestat.st_mtime;
+
+    if ( Read_Entry_File( entry->file_name, &reader ) )
+    {
+        if ( reader.size >= RB_CACHE_MAGIC_SIZE &&
+             memcmp( reader.data, RB_CACHE_MAGIC, RB_CACHE_MAGIC_SIZE ) == 0 )
+        {
+            reader.position = RB_CACHE_MAGIC_SIZE;
+            if ( Get_Number( &reader, 8 ) == cache->config_hash &&
+                 Is_Source_Unchanged( entry, &reader, part ) )
+            {
+                entry->hit = Get_Headers( entry, &reader, &( part->arena ) );
+            }
+        }
+        free( reader.data );
+    }
+    return entry;
+}
+
+/*******/
+
+
+/****if* Cache/Put_Header
+ * FUNCTION
+ *   Append a header to a cache buffer.  Of headers that were
+ *   not added to their part only the names are stored.
+ * SOURCE
+ */
+
+static void Put_Header(
+    struct RB_Cache_Buffer *buffer,
+    struct RB_header *header,
+    int added )
+{
+    int                 i;
+
+    Put_Int( buffer, header->no_names );
+    for ( i = 0; i < header->no_names; ++i )
+    {
+        Put_String( buffer, header->names[i] );
+    }
+    Put_Int( buffer, header->line_number );
+    Put_Int( buffer, added );
+    if ( added )
+    {
+        struct RB_Item     *item;
+        int                 no_items = 0;
+
+        Put_Int( buffer, header->htype->typeCharacter );
+        Put_Int( buffer, header->is_internal );
+        Put_String( buffer, header->function_name );
+        Put_String( buffer, header->module_name );
+        Put_Int( buffer, header->no_lines );
+        for ( i = 0; i < header->no_lines; ++i )
+        {
+            Put_Int( buffer, header->lines[i].line_number );
+            Put_String( buffer, header->lines[i].line );
+        }
+        for ( item = header->items; item; item = item->next )
+        {
+            ++no_items;
+        }
+        Put_Int( buffer, no_items );
+        for ( item = header->items; item; item = item->next )
+        {
+            Put_Int( buffer, item->type );
+            Put_Int( buffer, item->begin_index );
+            Put_Int( buffer, item->end_index );
+            Put_Int( buffer, item->max_line_number );
+            Put_Int( buffer, item->no_lines );
+            for ( i = 0; i < item->no_lines; ++i )
+            {
+                struct RB_Item_Line *itemline = item->lines[i];
+
+                Put_String( buffer, itemline->line );
+                Put_Int( buffer, itemline->kind );
+                Put_Int( buffer, itemline->format );
+                /* The pipe mode is only set for pipe lines */
+                Put_Int( buffer, ( itemline->kind == ITEM_LINE_PIPE ) ?
+                         itemline->pipe_mode : UNKNOWN );
+                Put_Int( buffer, itemline->line_number );
+            }
+        }
+    }
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Add_Header
+ * FUNCTION
+ *   Add a header that was found in a source file to the cache
+ *   entry of the file.  This should be done for all headers, in
+ *   the order in which they were found.  Of the headers that were
+ *   not added to the part only the names are stored.
+ * SYNOPSIS
+ */
+void RB_Cache_Add_Header(
+    struct RB_Cache_Entry *entry,
+    struct RB_header *header,
+    int added )
+/*
+ * INPUTS
+ *   o entry  -- the cache entry.
+ *   o header -- the header, if it was added its items
+ *               should have been analysed.
+ *   o added  -- TRUE if the header was added to the part.
+ * SOURCE
+ */
+{
+    Put_Header( &( entry->records ), header, added );
+    ++entry->no_records;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Hash_Source
+ * FUNCTION
+ *   Remember the hash of the content of a source file in its
+ *   cache entry.  This has to be done before the source file is
+ *   analysed, because the analysis changes the content in place
+ *   (line ends, trailing asterisks), and Is_Source_Unchanged()
+ *   hashes the file as it is on disk.
+ * SYNOPSIS
+ */
+void RB_Cache_Hash_Source(
+    struct RB_Cache_Entry *entry,
+    struct RB_Source_Reader *reader )
+/*
+ * INPUTS
+ *   o entry  -- the entry of the source file.
+ *   o reader -- the content of the source file, not read yet.
+ * SOURCE
+ */
+{
+    entry->content_hash = Hash_Source( reader );
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Store
+ * FUNCTION
+ *   Write the cache entry of a source file that was analysed.
+ *   Its content hash must have been set with
+ *   RB_Cache_Hash_Source().
+ * SYNOPSIS
+ */
+void RB_Cache_Store(
+    struct RB_Cache *cache,
+    struct RB_Cache_Entry *entry,
+    int last_line_number )
+/*
+ * INPUTS
+ *   o cache  -- the cache.
+ *   o entry  -- the entry with all the headers of the source file.
+ *   o last_line_number -- the number of lines that were read.
+ * SOURCE
+ */
+{
+    struct RB_Cache_Buffer buffer = { NULL, 0, 0 };
+
+    Put_Bytes( &buffer, RB_CACHE_MAGIC, RB_CACHE_MAGIC_SIZE );
+    Put_Wide( &buffer, cache->config_hash );
+    assert( buffer.size == RB_CACHE_STAT_OFFSET );
+    Put_Wide( &buffer, entry->size );
+    Put_Wide( &buffer, entry->mtime );
+    Put_Wide( &buffer, entry->content_hash );
+    Put_Wide( &buffer, ( unsigned long long ) time( NULL ) );
+    Put_String( &buffer, entry->source_name );
+    Put_Int( &buffer, last_line_number );
+    Put_Int( &buffer, entry->no_records );
+    Put_Bytes( &buffer, entry->records.data, entry->records.size );
+    Write_Entry_File( entry->file_name, buffer.data, buffer.size );
+    free( buffer.data );
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Free_Entry
+ * FUNCTION
+ *   Free a cache entry.  The headers it contains are not freed,
+ *   they are owned by whoever used them.
+ * SOURCE
+ */
+
+void RB_Cache_Free_Entry(
+    struct RB_Cache_Entry *entry )
+{
+    free( entry->file_name );
+    free( entry->source_name );
+    free( entry->headers );
+    free( entry->added );
+    free( entry->records.data );
+    free( entry );
+}
+
+/*******/
+
+
+/****if* Cache/Hash_Name
+ * FUNCTION
+ *   Add a string that might be NULL to a hash.
+ * SOURCE
+ */
+
+static unsigned long long Hash_Name(
+    unsigned long long hash,
+    char *name )
+{
+    return name ? Hash_String( hash, name ) : Hash_Bytes( hash, "", 0 );
+}
+
+/*******/
+
+
+/****if* Cache/Unique_Name
+ * FUNCTION
+ *   The unique name of a header that might be NULL.
+ * SOURCE
+ */
+
+static char        *Unique_Name(
+    struct RB_header *header )
+{
+    return header ? header->unique_name : NULL;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Hash_Structure
+ * FUNCTION
+ *   Compute a hash of everything about a document that is used
+ *   by more than one of its documentation files: the names of
+ *   all source and documentation files, and the names, types,
+ *   labels and places in the hierarchy of all headers.  All
+ *   links are derived from these.  The content of the headers
+ *   is not included, see RB_Cache_Hash_Part().
+ * SYNOPSIS
+ */
+unsigned long long RB_Cache_Hash_Structure(
+    struct RB_Cache *cache,
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o cache    -- the cache.
+ *   o document -- the document, with all headers collected,
+ *                 linked and named.
+ * RESULT
+ *   The hash.
+ * SOURCE
+ */
+{
+    unsigned long long  hash = cache->config_hash;
+    struct RB_Part     *i_part;
+    unsigned long       i;
+
+    if ( document->css )
+    {
+        hash = Hash_File( hash, document->css );
+    }
+    if ( document->js )
+    {
+        hash = Hash_File( hash, document->js );
+    }
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        hash = Hash_String( hash, Get_Fullname( i_part->filename ) );
+        hash = Hash_String( hash, RB_Get_FullDocname( i_part->filename ) );
+    }
+    for ( i = 0; i < document->no_headers; ++i )
+    {
+        struct RB_header   *header = document->headers[i];
+        unsigned char       flags[2];
+        int                 j;
+
+        for ( j = 0; j < header->no_names; ++j )
+        {
+            hash = Hash_Name( hash, header->names[j] );
+        }
+        hash = Hash_Name( hash, header->function_name );
+        hash = Hash_Name( hash, header->module_name );
+        hash = Hash_Name( hash, header->unique_name );
+        hash = Hash_Name( hash, header->file_name );
+        hash = Hash_Name( hash,
+                          RB_Get_FullDocname( header->owner->filename ) );
+        hash = Hash_Name( hash, Unique_Name( header->parent ) );
+        hash = Hash_Name( hash, Unique_Name( header->first_child ) );
+        hash = Hash_Name( hash, Unique_Name( header->next_sibling ) );
+        flags[0] = header->htype->typeCharacter;
+        flags[1] = ( unsigned char ) header->is_internal;
+        hash = Hash_Bytes( hash, flags, sizeof( flags ) );
+    }
+    return hash;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Hash_Part
+ * FUNCTION
+ *   Compute a hash of the content of the headers of a part.
+ *   Together with the structure of the document it determines
+ *   the documentation of the part.
+ * SYNOPSIS
+ */
+unsigned long long RB_Cache_Hash_Part(
+    struct RB_Part *part )
+/*
+ * INPUTS
+ *   o part -- the part.
+ * RESULT
+ *   The hash.
+ * SOURCE
+ */
+{
+    struct RB_Cache_Buffer buffer = { NULL, 0, 0 };
+    struct RB_header   *header;
+    unsigned long long  hash;
+
+    Put_String( &buffer, Get_Fullname( part->filename ) );
+    Put_String( &buffer, RB_Get_FullDocname( part->filename ) );
+    for ( header = part->headers; header; header = header->next )
+    {
+        Put_Header( &buffer, header, TRUE );
+        Put_String( &buffer, header->unique_name );
+        Put_String( &buffer, header->file_name );
+    }
+    hash = Hash_Bytes( RB_FNV_OFFSET, buffer.data, buffer.size );
+    free( buffer.data );
+    return hash;
+}
+
+/*******/
+
+
+/****if* Cache/Compare_Output_Records
+ * FUNCTION
+ *   Compare two output records on their names, for qsort()
+ *   and bsearch().
+ * SOURCE
+ */
+
+static int Compare_Output_Records(
+    const void *p1,
+    const void *p2 )
+{
+    const struct RB_Output_Record *record1 = p1;
+    const struct RB_Output_Record *record2 = p2;
+
+    return strcmp( record1->unit_name, record2->unit_name );
+}
+
+/*******/
+
+
+/****if* Cache/Free_Output_Record
+ * FUNCTION
+ *   Free the content of an output record.
+ * SOURCE
+ */
+
+static void Free_Output_Record(
+    struct RB_Output_Record *record )
+{
+    int                 i;
+
+    for ( i = 0; i < record->no_files; ++i )
+    {
+        free( record->files[i].name );
+    }
+    free( record->files );
+    free( record->unit_name );
+    record->files = NULL;
+    record->unit_name = NULL;
+    record->no_files = 0;
+}
+
+/*******/
+
+
+/****if* Cache/Get_Output_Records
+ * FUNCTION
+ *   Read the output records of the previous run from a manifest.
+ *   They are sorted on their names.  If the manifest is damaged
+ *   no records are read.
+ * SOURCE
+ */
+
+static void Get_Output_Records(
+    struct RB_Output_Manifest *manifest,
+    struct RB_Cache_Reader *reader )
+{
+    int                 no_records = Get_Count( reader );
+    struct RB_Output_Record *records =
+        calloc( no_records + 1, sizeof( struct RB_Output_Record ) );
+    int                 i;
+    int                 j;
+
+    RB_Mem_Check( records );
+    for ( i = 0; i < no_records && !reader->failed; ++i )
+    {
+        struct RB_Output_Record *record = &( records[i] );
+
+        record->unit_name = Get_String( reader );
+        record->input_hash = Get_Number( reader, 8 );
+        record->no_files = Get_Count( reader );
+        record->files =
+            calloc( record->no_files + 1, sizeof( struct RB_Output_File ) );
+        RB_Mem_Check( record->files );
+        for ( j = 0; j < record->no_files; ++j )
+        {
+            record->files[j].name = Get_String( reader );
+            record->files[j].size = Get_Number( reader, 8 );
+            record->files[j].mtime = Get_Number( reader, 8 );
+            if ( !record->files[j].name )
+            {
+                reader->failed = TRUE;
+            }
+        }
+        if ( !record->unit_name )
+        {
+            reader->failed = TRUE;
+        }
+    }
+    if ( reader->failed || reader->position != reader->size )
+    {
+        for ( i = 0; i < no_records; ++i )
+        {
+            Free_Output_Record( &( records[i] ) );
+        }
+        free( records );
+        return;
+    }
+    qsort( records, no_records, sizeof( struct RB_Output_Record ),
+           Compare_Output_Records );
+    manifest->old_records = records;
+    manifest->no_old_records = no_records;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Open_Outputs
+ * FUNCTION
+ *   Read the output manifest of a documentation directory.  It
+ *   lists, for each documentation file that was written by the
+ *   previous run, from what input it was generated.  Nothing of
+ *   it is used if the structure of the document changed.
+ * SYNOPSIS
+ */
+struct RB_Output_Manifest *RB_Cache_Open_Outputs(
+    struct RB_Cache *cache,
+    char *docroot,
+    unsigned long long structure_hash,
+    int no_units )
+/*
+ * INPUTS
+ *   o cache          -- the cache.
+ *   o docroot        -- the documentation directory.
+ *   o structure_hash -- see RB_Cache_Hash_Structure().
+ *   o no_units       -- the number of units (parts, index) of
+ *                       which the outputs are recorded.
+ * RESULT
+ *   The manifest.
+ * SOURCE
+ */
+{
+    struct RB_Output_Manifest *manifest =
+        calloc( 1, sizeof( struct RB_Output_Manifest ) );
+    struct RB_Cache_Reader reader;
+    char                cwd[TEMP_BUF_SIZE];
+
+    RB_Mem_Check( manifest );
+    /* The same relative directory in another working directory
+     * is another documentation directory. */
+    if ( ( docroot[0] != '/' ) && getcwd( cwd, sizeof( cwd ) ) )
+    {
+        manifest->docroot = malloc( strlen( cwd ) + strlen( docroot ) + 2 );
+        RB_Mem_Check( manifest->docroot );
+        sprintf( manifest->docroot, "%s/%s", cwd, docroot );
+    }
+    else
+    {
+        manifest->docroot = RB_StrDup( docroot );
+    }
+    manifest->file_name = Entry_File_Name( cache, manifest->docroot, "rbo" );
+    manifest->config_hash = cache->config_hash;
+    manifest->structure_hash = structure_hash;
+    manifest->no_records = no_units;
+    manifest->records =
+        calloc( no_units + 1, sizeof( struct RB_Output_Record ) );
+    RB_Mem_Check( manifest->records );
+
+    if ( Read_Entry_File( manifest->file_name, &reader ) )
+    {
+        if ( reader.size >= RB_OUTPUT_MAGIC_SIZE &&
+             memcmp( reader.data, RB_OUTPUT_MAGIC,
+                     RB_OUTPUT_MAGIC_SIZE ) == 0 )
+        {
+            char               *name;
+
+            reader.position = RB_OUTPUT_MAGIC_SIZE;
+            if ( ( Get_Number( &reader, 8 ) == cache->config_hash ) &&
+                 ( Get_Number( &reader, 8 ) == structure_hash ) )
+            {
+                name = Get_String( &reader );
+                if ( name && strcmp( name, manifest->docroot ) == 0 )
+                {
+                    Get_Output_Records( manifest, &reader );
+                }
+                free( name );
+            }
+        }
+        free( reader.data );
+    }
+    return manifest;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Outputs_Up_To_Date
+ * FUNCTION
+ *   Check whether the documentation files of a unit are still
+ *   up to date.  That is the case if the previous run generated
+ *   them from the same input, and they were not changed or
+ *   removed since.  If so the record of the previous run is
+ *   kept for the next run.
+ * SYNOPSIS
+ */
+int RB_Cache_Outputs_Up_To_Date(
+    struct RB_Output_Manifest *manifest,
+    int unit,
+    char *unit_name,
+    unsigned long long input_hash )
+/*
+ * INPUTS
+ *   o manifest   -- the manifest.
+ *   o unit       -- the number of the unit.
+ *   o unit_name  -- the name of the unit, for parts the name
+ *                   of their documentation file.
+ *   o input_hash -- the hash of the input of the unit.
+ * RESULT
+ *   TRUE if the documentation files do not have to be generated.
+ * SOURCE
+ */
+{
+    struct RB_Output_Record key;
+    struct RB_Output_Record *old_record;
+    struct RB_Output_Record *record;
+    int                 i;
+
+    if ( !manifest->old_records )
+    {
+        return FALSE;
+    }
+    key.unit_name = unit_name;
+    old_record = bsearch( &key, manifest->old_records,
+                          manifest->no_old_records,
+                          sizeof( struct RB_Output_Record ),
+                          Compare_Output_Records );
+    if ( !old_record || old_record->input_hash != input_hash )
+    {
+        return FALSE;
+    }
+    for ( i = 0; i < old_record->no_files; ++i )
+    {
+        struct RB_Output_File *file = &( old_record->files[i] );
+        struct stat         filestat;
+
+        if ( ( stat( file->name, &filestat ) != 0 ) ||
+             ( ( unsigned long long ) filestat.st_size != file->size ) ||
+             ( ( unsigned long long ) filestat.st_mtime != file->mtime ) )
+        {
+            return FALSE;
+        }
+    }
+    record = &( manifest->records[unit] );
+    record->unit_name = RB_StrDup( unit_name );
+    record->input_hash = input_hash;
+    record->no_files = old_record->no_files;
+    record->files =
+        calloc( record->no_files + 1, sizeof( struct RB_Output_File ) );
+    RB_Mem_Check( record->files );
+    for ( i = 0; i < record->no_files; ++i )
+    {
+        record->files[i] = old_record->files[i];
+        record->files[i].name = RB_StrDup( old_record->files[i].name );
+    }
+    return TRUE;
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Set_Outputs
+ * FUNCTION
+ *   Record the documentation files that were generated for a
+ *   unit, and from what input.
+ * SYNOPSIS
+ */
+void RB_Cache_Set_Outputs(
+    struct RB_Output_Manifest *manifest,
+    int unit,
+    char *unit_name,
+    unsigned long long input_hash,
+    struct RB_Output_List *list )
+/*
+ * INPUTS
+ *   o manifest   -- the manifest.
+ *   o unit       -- the number of the unit.
+ *   o unit_name  -- the name of the unit.
+ *   o input_hash -- the hash of the input of the unit.
+ *   o list       -- the files that were written, see
+ *                   RB_Start_Output_List().
+ * SOURCE
+ */
+{
+    struct RB_Output_Record *record = &( manifest->records[unit] );
+    int                 i;
+
+    Free_Output_Record( record );
+    record->unit_name = RB_StrDup( unit_name );
+    record->input_hash = input_hash;
+    record->no_files = list->no_names;
+    record->files =
+        calloc( record->no_files + 1, sizeof( struct RB_Output_File ) );
+    RB_Mem_Check( record->files );
+    for ( i = 0; i < record->no_files; ++i )
+    {
+        struct RB_Output_File *file = &( record->files[i] );
+        struct stat         filestat;
+
+        file->name = RB_StrDup( list->names[i] );
+        if ( stat( file->name, &filestat ) == 0 )
+        {
+            file->size = ( unsigned long long ) filestat.st_size;
+            file->mtime = ( unsigned long long ) filestat.st_mtime;
+        }
+        else
+        {
+            /* Never up to date. */
+            Free_Output_Record( record );
+            return;
+        }
+    }
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Save_Outputs
+ * FUNCTION
+ *   Write the manifest with the records of all units that were
+ *   generated, or were still up to date.
+ * SOURCE
+ */
+
+void RB_Cache_Save_Outputs(
+    struct RB_Output_Manifest *manifest )
+{
+    struct RB_Cache_Buffer buffer = { NULL, 0, 0 };
+    int                 no_records = 0;
+    int                 i;
+    int                 j;
+
+    for ( i = 0; i < manifest->no_records; ++i )
+    {
+        if ( manifest->records[i].unit_name )
+        {
+            ++no_records;
+        }
+    }
+    Put_Bytes( &buffer, RB_OUTPUT_MAGIC, RB_OUTPUT_MAGIC_SIZE );
+    Put_Wide( &buffer, manifest->config_hash );
+    Put_Wide( &buffer, manifest->structure_hash );
+    Put_String( &buffer, manifest->docroot );
+    Put_Int( &buffer, no_records );
+    for ( i = 0; i < manifest->no_records; ++i )
+    {
+        struct RB_Output_Record *record = &( manifest->records[i] );
+
+        if ( record->unit_name )
+        {
+            Put_String( &buffer, record->unit_name );
+            Put_Wide( &buffer, record->input_hash );
+            Put_Int( &buffer, record->no_files );
+            for ( j = 0; j < record->no_files; ++j )
+            {
+                Put_String( &buffer, record->files[j].name );
+                Put_Wide( &buffer, record->files[j].size );
+                Put_Wide( &buffer, record->files[j].mtime );
+            }
+        }
+    }
+    Write_Entry_File( manifest->file_name, buffer.data, buffer.size );
+    free( buffer.data );
+}
+
+/*******/
+
+
+/****f* Cache/RB_Cache_Free_Outputs
+ * FUNCTION
+ *   Free an output manifest.
+ * SOURCE
+ */
+
+void RB_Cache_Free_Outputs(
+    struct RB_Output_Manifest *manifest )
+{
+    int                 i;
+
+    for ( i = 0; i < manifest->no_records; ++i )
+    {
+        Free_Output_Record( &( manifest->records[i] ) );
+    }
+    for ( i = 0; i < manifest->no_old_records; ++i )
+    {
+        Free_Output_Record( &( manifest->old_records[i] ) );
+    }
+    free( manifest->records );
+    free( manifest->old_records );
+    free( manifest->file_name );
+    free( manifest->docroot );
+    free( manifest );
+}
+
+/*******/
@@ -0,0 +1,233 @@
+#ifndef ROBODOC_CACHE_H
+#define ROBODOC_CACHE_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "headers.h"
+#include "part.h"
+#include "document.h"
+#include "reader.h"
+#include "util.h"
+
+/****s* Cache/RB_Cache
+ * FUNCTION
+ *   A directory with the analysis results of earlier runs.
+ *   See RB_Cache_Create().
+ * ATTRIBUTES
+ *   o directory   -- the name of the directory.
+ *   o config_hash -- hash of everything besides the source file
+ *                    itself that influences the analysis.
+ * SOURCE
+ */
+
+struct RB_Cache
+{
+    char               *directory;
+    unsigned long long  config_hash;
+};
+
+/*******/
+
+
+/****s* Cache/RB_Cache_Buffer
+ * FUNCTION
+ *   A growing block of memory that holds a cache entry in the
+ *   format in which it is written to disk.
+ * SOURCE
+ */
+
+struct RB_Cache_Buffer
+{
+    unsigned char      *data;
+    size_t              size;
+    size_t              allocated;
+};
+
+/*******/
+
+
+/****s* Cache/RB_Cache_Entry
+ * FUNCTION
+ *   The cache entry of one source file.  It is created by
+ *   RB_Cache_Lookup() before the source file is read.
+ * ATTRIBUTES
+ *   o file_name   -- the file the entry is stored in.
+ *   o source_name -- the name of the source file.
+ *   o size        -- the size of the source file.
+ *   o mtime       -- the modification time of the source file.
+ *   o content_hash -- the hash of the content of the source file,
+ *                    see RB_Cache_Hash_Source().
+ *   o hit         -- TRUE if the entry could be used.  The
+ *                    headers are then in headers.
+ *   o headers     -- all the headers that were found in the source
+ *                    file, in the order in which they were found.
+ *   o added       -- for each of the headers, TRUE if it was added
+ *                    to the part and FALSE if only its names were
+ *                    kept (for the check for duplicates).
+ *   o no_headers  -- the number of headers.
+ *   o last_line_number -- the number of lines that were read from
+ *                    the source file.
+ *   o records     -- the headers that are to be stored, see
+ *                    RB_Cache_Add_Header().
+ *   o no_records  -- the number of headers in records.
+ * SOURCE
+ */
+
+struct RB_Cache_Entry
+{
+    char               *file_name;
+    char               *source_name;
+    unsigned long long  size;
+    unsigned long long  mtime;
+    unsigned long long  content_hash;
+    int                 hit;
+    struct RB_header  **headers;
+    int                *added;
+    int                 no_headers;
+    int                 last_line_number;
+    struct RB_Cache_Buffer records;
+    int                 no_records;
+};
+
+/*******/
+
+/****s* Cache/RB_Output_File
+ * FUNCTION
+ *   A documentation file, and its size and modification time
+ *   right after it was written.
+ * SOURCE
+ */
+
+struct RB_Output_File
+{
+    char               *name;
+    unsigned long long  size;
+    unsigned long long  mtime;
+};
+
+/*******/
+
+
+/****s* Cache/RB_Output_Record
+ * FUNCTION
+ *   The documentation files that were generated for a unit of
+ *   a document (a part, or the index).
+ * ATTRIBUTES
+ *   o unit_name  -- the name of the unit, NULL if nothing was
+ *                   recorded for it.
+ *   o input_hash -- the hash of the input of the unit.
+ *   o files      -- the files that were written.
+ *   o no_files   -- the number of files.
+ * SOURCE
+ */
+
+struct RB_Output_Record
+{
+    char               *unit_name;
+    unsigned long long  input_hash;
+    struct RB_Output_File *files;
+    int                 no_files;
+};
+
+/*******/
+
+
+/****s* Cache/RB_Output_Manifest
+ * FUNCTION
+ *   What was generated in a documentation directory by the
+ *   previous run, and what is generated by this run.
+ *   See RB_Cache_Open_Outputs().
+ * ATTRIBUTES
+ *   o file_name      -- the file the manifest is stored in.
+ *   o docroot        -- the documentation directory, made absolute.
+ *   o config_hash    -- see RB_Cache.
+ *   o structure_hash -- see RB_Cache_Hash_Structure().
+ *   o old_records    -- the records of the previous run, sorted on
+ *                       their names, or NULL if they can not be used.
+ *   o no_old_records -- the number of old records.
+ *   o records        -- the records of this run, one per unit.
+ *   o no_records     -- the number of units.
+ * SOURCE
+ */
+
+struct RB_Output_Manifest
+{
+    char               *file_name;
+    char               *docroot;
+    unsigned long long  config_hash;
+    unsigned long long  structure_hash;
+    struct RB_Output_Record *old_records;
+    int                 no_old_records;
+    struct RB_Output_Record *records;
+    int                 no_records;
+};
+
+/*******/
+
+struct RB_Cache    *RB_Cache_Create(
+    char *directory,
+    char *rc_file_name );
+void                RB_Cache_Free(
+    struct RB_Cache *cache );
+struct RB_Cache_Entry *RB_Cache_Lookup(
+    struct RB_Cache *cache,
+    struct RB_Part *part );
+void                RB_Cache_Add_Header(
+    struct RB_Cache_Entry *entry,
+    struct RB_header *header,
+    int added );
+void                RB_Cache_Hash_Source(
+    struct RB_Cache_Entry *entry,
+    struct RB_Source_Reader *reader );
+void                RB_Cache_Store(
+    struct RB_Cache *cache,
+    struct RB_Cache_Entry *entry,
+    int last_line_number );
+void                RB_Cache_Free_Entry(
+    struct RB_Cache_Entry *entry );
+unsigned long long  RB_Cache_Hash_Structure(
+    struct RB_Cache *cache,
+    struct RB_Document *document );
+unsigned long long  RB_Cache_Hash_Part(
+    struct RB_Part *part );
+struct RB_Output_Manifest *RB_Cache_Open_Outputs(
+    struct RB_Cache *cache,
+    char *docroot,
+    unsigned long long structure_hash,
+    int no_units );
+int                 RB_Cache_Outputs_Up_To_Date(
+    struct RB_Output_Manifest *manifest,
+    int unit,
+    char *unit_name,
+    unsigned long long input_hash );
+void                RB_Cache_Set_Outputs(
+    struct RB_Output_Manifest *manifest,
+    int unit,
+    char *unit_name,
+    unsigned long long input_hash,
+    struct RB_Output_List *list );
+void                RB_Cache_Save_Outputs(
+    struct RB_Output_Manifest *manifest );
+void                RB_Cache_Free_Outputs(
+    struct RB_Output_Manifest *manifest );
+
+#endif /* ROBODOC_CACHE_H */
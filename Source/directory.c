@@ -46,6 +46,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "globals.h"
 #include "roboconfig.h"
+#include "jobs.h"
+#include "reader.h"
 
 #if defined _DIRENT_HAVE_D_TYPE
      /* Empty */
@@ -71,7 +73,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #define RB_CBUFFERSIZE 8191
-char                content_buffer[RB_CBUFFERSIZE + 1];
+static ROBO_THREAD_LOCAL char content_buffer[RB_CBUFFERSIZE + 1];
+
+/*****/
+
+
+/****iv* Directory/no_kept_sources
+ * FUNCTION
+ *   The number of source files that the current directory scan
+ *   tried to keep mapped into memory.  Only the first
+ *   RB_MAX_KEPT_SOURCES are kept, see Reserve_Kept_Source().
+ * SOURCE
+ */
+
+#define RB_MAX_KEPT_SOURCES 16384
+static int          no_kept_sources = 0;
 
 /*****/
 
@@ -79,6 +95,10 @@ char                content_buffer[RB_CBUFFERSIZE + 1];
 /* Local functions */
 static int          RB_Is_PathCharacter(
     int c );
+static int          Is_Source_File(
+    struct RB_Path *path,
+    char *filename,
+    struct RB_Source_Reader **source );
 
 
 /****f* Directory/RB_FileType
@@ -265,7 +285,8 @@ void RB_Free_RB_Directory(
  */
 struct RB_Directory *RB_Get_RB_Directory(
     char *arg_rootpath_name,
-    char *arg_docroot_name )
+    char *arg_docroot_name,
+    int no_jobs )
 /*
  * INPUTS
  *   arg_rootpath -- the name a the directory to get,
@@ -274,6 +295,8 @@ struct RB_Directory *RB_Get_RB_Directory(
  *                       file are stored in.  This directory is
  *                       skipped while scanning for sourcefiles.
  *                       It can be NULL.
+ *   no_jobs      -- the number of directories that can be scanned
+ *                   at the same time, see RB_Fill_Directory().
  * RESULT
  *   A freshly allocated RB_Directory filled with source files.
  * SOURCE
@@ -293,7 +316,8 @@ struct RB_Directory *RB_Get_RB_Directory(
         doc_path = RB_Get_RB_Path( arg_docroot_name );
     }
 
-    RB_Fill_Directory( rb_directory, rb_directory->first_path, doc_path );
+    RB_Fill_Directory( rb_directory, rb_directory->first_path, doc_path,
+                       no_jobs );
     if ( ( RB_Number_Of_Filenames( rb_directory ) > 0 ) &&
          ( RB_Number_Of_Paths( rb_directory ) > 0 ) )
     {
@@ -369,35 +393,130 @@ struct RB_Directory *RB_Get_RB_SingleFileDirectory(
 /*******/
 
 
-/****f* Directory/RB_Fill_Directory
- * NAME
- *   RB_Fill_Directory -- fill a RB_Directory structure
+/****is* Directory/RB_Directory_Scan
+ * FUNCTION
+ *   The scan of one directory of the source tree, see
+ *   RB_Fill_Directory().
+ * ATTRIBUTES
+ *   o directory -- the RB_Directory that is filled.
+ *   o path      -- the directory that is scanned.
+ *   o doc_path  -- the path to the documentation files, or NULL.
+ *   o log       -- when several directories are scanned at the same
+ *                  time, the messages of the scan and the changes
+ *                  to directory, in the order in which a serial scan
+ *                  would make them.
+ * SOURCE
+ */
+
+struct RB_Directory_Scan
+{
+    struct RB_Directory *directory;
+    struct RB_Path     *path;
+    struct RB_Path     *doc_path;
+    struct RB_Message_Log log;
+};
+
+/*******/
+
+
+/****is* Directory/RB_Scanned_File
+ * FUNCTION
+ *   A source file that was found by the scan of a directory, and
+ *   that still has to be added to the RB_Directory.
+ * SOURCE
+ */
+
+struct RB_Scanned_File
+{
+    struct RB_Directory *directory;
+    struct RB_Filename *filename;
+};
+
+/*******/
+
+
+/****if* Directory/Insert_Scanned_File
+ * FUNCTION
+ *   Add a source file that was found by a parallel scan to the
+ *   RB_Directory.  Called when the log of the scan is replayed.
  * SYNOPSIS
  */
-void RB_Fill_Directory(
-    struct RB_Directory *arg_rb_directory,
-    struct RB_Path *arg_path,
-    struct RB_Path *arg_doc_path )
+static void Insert_Scanned_File(
+    void *data )
 /*
+ * INPUTS
+ *   o data -- the RB_Scanned_File, it is freed.
+ * SOURCE
+ */
+{
+    struct RB_Scanned_File *file = data;
+
+    RB_Directory_Insert_RB_Filename( file->directory, file->filename );
+    free( file );
+}
+
+/*******/
+
+
+/****if* Directory/Insert_Scanned_Path
  * FUNCTION
- *   Walks through all the files in the directory pointed to
- *   by arg_path and adds all the files to arg_rb_directory.
- *   This is a recursive function.
+ *   Add a subdirectory that was scanned in parallel to the
+ *   RB_Directory, followed by everything that was found in it.
+ *   Called when the log of the scan of its parent is replayed.
+ * SYNOPSIS
+ */
+static void Insert_Scanned_Path(
+    void *data )
+/*
  * INPUTS
- *   o arg_rb_directory  -- the result.
- *   o arg_path          -- the current path that is scanned.
- *   o arg_doc_path      -- the path to the documentation files.
- * RESULT
- *   a RB_Directory structure filled with all sourcefiles and 
- *   subdirectories in arg_path.
- * NOTE
- *   This a is a recursive function.
+ *   o data -- the RB_Directory_Scan of the subdirectory, it is
+ *             freed.
+ * SOURCE
+ */
+{
+    struct RB_Directory_Scan *scan = data;
+
+    RB_Directory_Insert_RB_Path( scan->directory, scan->path );
+    RB_Replay_Message_Log( &( scan->log ) );
+    free( scan );
+}
+
+/*******/
+
+
+/****if* Directory/Scan_Directory
+ * FUNCTION
+ *   Walk through all the files in a directory and add all the
+ *   source files and subdirectories to the RB_Directory.
+ *
+ *   Without a job queue the subdirectories are scanned right away.
+ *   With one, each subdirectory becomes a new job, and the scan
+ *   logs its messages and the changes to the RB_Directory instead
+ *   of making them.  The log of a subdirectory is replayed at the
+ *   point in the log of its parent where a serial scan would have
+ *   scanned it.
+ * SYNOPSIS
+ */
+static void Scan_Directory(
+    struct RB_Job_Queue *queue,
+    void *job )
+/*
+ * INPUTS
+ *   o queue -- the job queue, or NULL.
+ *   o job   -- the RB_Directory_Scan.
  * SOURCE
  */
 {
+    struct RB_Directory_Scan *scan = job;
+    struct RB_Path     *arg_path = scan->path;
+    struct RB_Path     *arg_doc_path = scan->doc_path;
     struct dirent      *a_direntry;
     DIR                *a_dirstream;
 
+    if ( queue )
+    {
+        RB_Start_Message_Log( &( scan->log ) );
+    }
     RB_Say( "Scanning %s\n", SAY_INFO, arg_path->name );
     a_dirstream = opendir( arg_path->name );
 
@@ -411,14 +530,21 @@ void RB_Fill_Directory(
             file_type = RB_FileType( arg_path->name, a_direntry );
             if ( file_type == RB_FT_FILE )
             {
+                struct RB_Source_Reader *source = NULL;
+
                 /* It is a regular file. See if it is a sourcefile. */
-                if ( RB_Is_Source_File( arg_path, a_direntry->d_name ) )
+                if ( Is_Source_File( arg_path, a_direntry->d_name, &source ) )
                 {
                     /* It is, so we add it to the directory tree */
-                    RB_Directory_Insert_RB_Filename( arg_rb_directory,
-                                                     RB_Get_RB_Filename
-                                                     ( a_direntry->d_name,
-                                                       arg_path ) );
+                    struct RB_Scanned_File *file =
+                        malloc( sizeof( struct RB_Scanned_File ) );
+
+                    RB_Mem_Check( file );
+                    file->directory = scan->directory;
+                    file->filename =
+                        RB_Get_RB_Filename( a_direntry->d_name, arg_path );
+                    file->filename->source = source;
+                    RB_Defer( Insert_Scanned_File, file );
                 }
                 else
                 {
@@ -457,10 +583,27 @@ void RB_Fill_Directory(
                                               arg_doc_path->name ) )
                                  || !arg_doc_path )
                             {
-                                RB_Directory_Insert_RB_Path( arg_rb_directory,
-                                                             rb_path );
-                                RB_Fill_Directory( arg_rb_directory, rb_path,
-                                                   arg_doc_path );
+                                struct RB_Directory_Scan *subscan =
+                                    malloc( sizeof
+                                            ( struct RB_Directory_Scan ) );
+
+                                RB_Mem_Check( subscan );
+                                subscan->directory = scan->directory;
+                                subscan->path = rb_path;
+                                subscan->doc_path = arg_doc_path;
+                                if ( queue )
+                                {
+                                    RB_Defer( Insert_Scanned_Path, subscan );
+                                    RB_Queue_Job( queue, subscan );
+                                }
+                                else
+                                {
+                                    RB_Directory_Insert_RB_Path( scan->
+                                                                 directory,
+                                                                 rb_path );
+                                    Scan_Directory( NULL, subscan );
+                                    free( subscan );
+                                }
                             }
                             else
                             {
@@ -476,27 +619,154 @@ void RB_Fill_Directory(
                 /* Not a file and also not a directory */
             }
         }
+        closedir( a_dirstream );
+    }
+    if ( queue )
+    {
+        RB_Stop_Message_Log(  );
     }
-    closedir( a_dirstream );
 }
 
-/*****/
+/*******/
 
-/****f* Directory/RB_Is_Source_File
+
+/****f* Directory/RB_Fill_Directory
  * NAME
- *   RB_Is_Source_File -- Is a file a sourcefile?
+ *   RB_Fill_Directory -- fill a RB_Directory structure
  * SYNOPSIS
  */
-int RB_Is_Source_File(
-    struct RB_Path *path,
-    char *filename )
+void RB_Fill_Directory(
+    struct RB_Directory *arg_rb_directory,
+    struct RB_Path *arg_path,
+    struct RB_Path *arg_doc_path,
+    int no_jobs )
 /*
  * FUNCTION
- *   This functions examines the content of a file to
- *   see whether or not it is a sourcefile.
+ *   Walks through all the files in the directory pointed to
+ *   by arg_path and its subdirectories and adds all the files
+ *   to arg_rb_directory.
  *
- *   Currently it checks if there are no nul characters
- *   in the first 8191 characters of the file.
+ *   With more than one job the directories are scanned by a pool
+ *   of threads, so that reading one directory, and looking into
+ *   its files to see if they are source files, overlaps with
+ *   reading others.  The files and paths are added to
+ *   arg_rb_directory, and the messages are printed, in the same
+ *   order as with a single job.
+ * INPUTS
+ *   o arg_rb_directory  -- the result.
+ *   o arg_path          -- the current path that is scanned.
+ *   o arg_doc_path      -- the path to the documentation files.
+ *   o no_jobs           -- the number of directories that can be
+ *                          scanned at the same time.
+ * RESULT
+ *   a RB_Directory structure filled with all sourcefiles and 
+ *   subdirectories in arg_path.
+ * SOURCE
+ */
+{
+    struct RB_Directory_Scan scan;
+
+    no_kept_sources = 0;
+    scan.directory = arg_rb_directory;
+    scan.path = arg_path;
+    scan.doc_path = arg_doc_path;
+    if ( no_jobs > 1 )
+    {
+        RB_Run_Job_Queue( no_jobs, Scan_Directory, &scan );
+        RB_Replay_Message_Log( &( scan.log ) );
+    }
+    else
+    {
+        Scan_Directory( NULL, &scan );
+    }
+}
+
+/*****/
+
+/****if* Directory/Is_Source_Content
+ * FUNCTION
+ *   Look at the start of a file to see whether it is a source
+ *   file.  It is if there are no nul characters in it.
+ * SYNOPSIS
+ */
+static int Is_Source_Content(
+    char *content,
+    size_t size )
+/*
+ * INPUTS
+ *   o content -- the first characters of the file.
+ *   o size    -- the number of characters, at most RB_CBUFFERSIZE.
+ * RESULT
+ *   TRUE if it is a source file, FALSE otherwise.
+ * SOURCE
+ */
+{
+    if ( size > 10 )
+    {
+        return ( memchr( content, '\0', size ) == NULL );
+    }
+    else
+    {
+        /* A file with only 9 characters can not
+           contain any source plus documentation. */
+        return FALSE;
+    }
+}
+
+/*****/
+
+
+/****if* Directory/Reserve_Kept_Source
+ * FUNCTION
+ *   Count one more source file that the directory scan keeps
+ *   mapped into memory for the analyser.  The number of mappings
+ *   a process can have is limited, so only the first
+ *   RB_MAX_KEPT_SOURCES files of a scan are kept, the others are
+ *   read again by the analyser.
+ * SYNOPSIS
+ */
+static int Reserve_Kept_Source(
+    void )
+/*
+ * RESULT
+ *   TRUE if the file can be kept.
+ * SOURCE
+ */
+{
+#if !defined( ROBO_NO_THREADS ) && !defined( _WIN32 )
+    /* The scan can run on several threads, see RB_Fill_Directory() */
+    return __sync_add_and_fetch( &no_kept_sources, 1 ) <=
+        RB_MAX_KEPT_SOURCES;
+#else
+    return ++no_kept_sources <= RB_MAX_KEPT_SOURCES;
+#endif
+}
+
+/*****/
+
+
+/****if* Directory/Is_Source_File
+ * FUNCTION
+ *   See RB_Is_Source_File().  If the caller asks for it, the file
+ *   is mapped into memory instead of read, and the mapping is
+ *   kept if it is a source file.  The analyser then does not have
+ *   to open and read the file again.
+ * SYNOPSIS
+ */
+static int Is_Source_File(
+    struct RB_Path *path,
+    char *filename,
+    struct RB_Source_Reader **source )
+/*
+ * INPUTS
+ *   o path     -- the path of the file.
+ *   o filename -- the name of the file.
+ * OUTPUT
+ *   o source   -- if it is not NULL, and the file is a source file,
+ *                 it is set to the mapped file, or to NULL if the
+ *                 file could not be mapped.
+ * RESULT
+ *   TRUE if it is a source file, FALSE otherwise.
  * SOURCE
  */
 {
@@ -527,28 +797,35 @@ int RB_Is_Source_File(
             strcat( content_buffer, filename );
             if ( ( file = fopen( content_buffer, "rb" ) ) )
             {
-                int                 no_read;
-                no_read =
-                    fread( content_buffer, sizeof( char ), RB_CBUFFERSIZE,
-                           file );
-                if ( no_read > 10 )
-                {
-                    char               *c;
+                struct RB_Source_Reader *reader = NULL;
 
-                    for ( c = content_buffer; no_read; --no_read, c++ )
+                if ( source && Reserve_Kept_Source(  ) )
+                {
+                    reader = RB_Map_Source( file );
+                }
+                if ( reader )
+                {
+                    is_source =
+                        Is_Source_Content( reader->data,
+                                           ( reader->size < RB_CBUFFERSIZE ) ?
+                                           reader->size : RB_CBUFFERSIZE );
+                    if ( is_source )
                     {
-                        if ( *c == 0 )
-                        {
-                            is_source = 0;
-                            break;
-                        }
+                        *source = reader;
+                    }
+                    else
+                    {
+                        RB_Free_Source_Reader( reader );
                     }
                 }
                 else
                 {
-                    /* A file with only 9 characters can not
-                       contain any source plus documentation. */
-                    is_source = 0;
+                    size_t              no_read;
+
+                    no_read =
+                        fread( content_buffer, sizeof( char ),
+                               RB_CBUFFERSIZE, file );
+                    is_source = Is_Source_Content( content_buffer, no_read );
                 }
                 fclose( file );
             }
@@ -571,13 +848,37 @@ int RB_Is_Source_File(
 /*****/
 
 
+/****f* Directory/RB_Is_Source_File
+ * NAME
+ *   RB_Is_Source_File -- Is a file a sourcefile?
+ * SYNOPSIS
+ */
+int RB_Is_Source_File(
+    struct RB_Path *path,
+    char *filename )
+/*
+ * FUNCTION
+ *   This functions examines the content of a file to
+ *   see whether or not it is a sourcefile.
+ *
+ *   Currently it checks if there are no nul characters
+ *   in the first 8191 characters of the file.
+ * SOURCE
+ */
+{
+    return Is_Source_File( path, filename, NULL );
+}
+
+/*****/
+
+
 /****f* Directory/RB_To_Be_Skipped
  * FUNCTION
  *   Test if a file should not be included in the list of source files
  *   that are scanned for documentation. 
  *
  *   This test is done based on the wildcard expressions specified
- *   in configuration.ignore_files.
+ *   in configuration.ignore_files, see RB_Compile_Wildcards().
  * SYNOPSIS
  */
 int RB_To_Be_Skipped(
@@ -588,18 +889,8 @@ int RB_To_Be_Skipped(
  * SOURCE
  */
 {
-    unsigned int        i;
-    int                 skip = FALSE;
-
-    for ( i = 0; i < configuration.ignore_files.number; ++i )
-    {
-        if ( RB_Match( filename, configuration.ignore_files.names[i] ) )
-        {
-            skip = TRUE;
-            break;
-        }
-    }
-    return skip;
+    return RB_Match_Wildcards( &( configuration.ignore_file_patterns ),
+                               filename ) >= 0;
 }
 
 /******/
@@ -611,7 +902,7 @@ int RB_To_Be_Skipped(
  *   because it does not match a pattern in "accept files:"
  *
  *   This test is done based on the wildcard expressions specified
- *   in configuration.accept_files.
+ *   in configuration.accept_files, see RB_Compile_Wildcards().
  * SYNOPSIS
  */
 int RB_Not_Accepted(
@@ -622,23 +913,24 @@ int RB_Not_Accepted(
  * SOURCE
  */
 {
-    unsigned int        i;
     int                 skip = FALSE;
 
     skip = RB_To_Be_Skipped( filename );
 
     if ( !skip && configuration.accept_files.number > 0 )
     {
-        skip = TRUE;
-        for ( i = 0; i < configuration.accept_files.number; ++i )
+        int                 i =
+            RB_Match_Wildcards( &( configuration.accept_file_patterns ),
+                                filename );
+
+        if ( i >= 0 )
         {
-            if ( RB_Match( filename, configuration.accept_files.names[i] ) )
-            {
-                RB_Say( "accept >%s< with >%s<\n", SAY_INFO, filename,
-                        configuration.accept_files.names[i] );
-                skip = FALSE;
-                break;
-            }
+            RB_Say( "accept >%s< with >%s<\n", SAY_INFO, filename,
+                    configuration.accept_files.names[i] );
+        }
+        else
+        {
+            skip = TRUE;
         }
     }
     return skip;
@@ -87,7 +87,8 @@ typedef enum
 
 struct RB_Directory *RB_Get_RB_Directory(
     char *arg_rootpath,
-    char *arg_docroot_name );
+    char *arg_docroot_name,
+    int no_jobs );
 struct RB_Directory *RB_Get_RB_SingleFileDirectory(
     char *arg_fullpath );
 void                RB_Dump_RB_Directory(
@@ -104,7 +105,8 @@ void                RB_Directory_Insert_RB_Filename(
 void                RB_Fill_Directory(
     struct RB_Directory *arg_rb_directory,
     struct RB_Path *arg_path,
-    struct RB_Path *arg_doc_path );
+    struct RB_Path *arg_doc_path,
+    int no_jobs );
 int                 RB_Is_Source_File(
     struct RB_Path *path,
     char *filename );
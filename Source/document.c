@@ -55,6 +55,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "headers.h"
 #include "links.h"
 #include "util.h"
+#include "intern.h"
 #include <string.h>
 #include "generator.h"
 #include "file.h"
@@ -82,6 +83,7 @@ void RB_Document_Add_Part(
  */
 {
     part->next = document->parts;
+    part->document = document;
     document->parts = part;
 }
 
@@ -107,11 +109,52 @@ void RB_Free_RB_Document_Parts(
 }
 
 
+/****if* Document/Free_Header_Names
+ * FUNCTION
+ *   Free the header name index of a document, and leave it
+ *   empty.
+ * SYNOPSIS
+ */
+static void Free_Header_Names(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document.
+ * SOURCE
+ */
+{
+    if ( document->header_names )
+    {
+        unsigned long       i;
+
+        for ( i = 0; i <= document->header_names_mask; ++i )
+        {
+            struct RB_Header_Name *entry;
+            struct RB_Header_Name *next_entry;
+
+            for ( entry = document->header_names[i]; entry;
+                  entry = next_entry )
+            {
+                next_entry = entry->next;
+                free( entry );
+            }
+        }
+        free( document->header_names );
+    }
+    document->header_names = NULL;
+    document->header_names_mask = 0;
+    document->no_header_names = 0;
+}
+
+/*******/
+
+
 /* TODO Documentation */
 void RB_Free_RB_Document(
     struct RB_Document *document )
 {
-    RB_Free_RB_Document_Parts( document );
+    /* The headers live in the arenas of the parts, so they are
+     * freed first. */
     if ( document->headers )
     {
         unsigned long       i;
@@ -123,9 +166,146 @@ void RB_Free_RB_Document(
         }
         free( document->headers );
     }
+    RB_Free_RB_Document_Parts( document );
+    RB_Free_Arena( &( document->arena ) );
+    Free_Header_Names( document );
     free( document );
 }
 
+
+/****if* Document/Compare_Line_Numbers
+ * FUNCTION
+ *   Compare two headers on the line they start on, for qsort().
+ * SOURCE
+ */
+
+static int Compare_Line_Numbers(
+    const void *h1,
+    const void *h2 )
+{
+    const struct RB_header *header_1 = *( struct RB_header * const * ) h1;
+    const struct RB_header *header_2 = *( struct RB_header * const * ) h2;
+
+    return ( header_1->line_number > header_2->line_number ) -
+        ( header_1->line_number < header_2->line_number );
+}
+
+/*******/
+
+
+/****if* Document/Restore_Source_Order
+ * FUNCTION
+ *   Put the headers of a part back in the order in which they
+ *   were found in the source file.
+ * SYNOPSIS
+ */
+static void Restore_Source_Order(
+    struct RB_Part *part )
+/*
+ * INPUTS
+ *   o part -- the part.
+ * SOURCE
+ */
+{
+    struct RB_header   *i_header;
+    struct RB_header  **headers;
+    unsigned long       count = 0;
+    unsigned long       i;
+
+    for ( i_header = part->headers; i_header; i_header = i_header->next )
+    {
+        ++count;
+    }
+    if ( count < 2 )
+    {
+        return;
+    }
+    headers = malloc( count * sizeof( struct RB_header * ) );
+    RB_Mem_Check( headers );
+    for ( i = 0, i_header = part->headers; i_header;
+          i_header = i_header->next, ++i )
+    {
+        headers[i] = i_header;
+    }
+    qsort( headers, count, sizeof( struct RB_header * ),
+           Compare_Line_Numbers );
+    for ( i = 0; i + 1 < count; ++i )
+    {
+        headers[i]->next = headers[i + 1];
+    }
+    headers[count - 1]->next = NULL;
+    part->headers = headers[0];
+    part->last_header = headers[count - 1];
+    free( headers );
+}
+
+/*******/
+
+
+/****f* Document/RB_Document_Reset
+ * FUNCTION
+ *   Undo everything that was derived from the headers of the
+ *   parts while the documentation was generated: the table with
+ *   all headers, the header name index, the links between the
+ *   headers, their unique names, and the names of the
+ *   documentation files.  The parts and their headers are kept,
+ *   so the documentation can be generated again after some of
+ *   the parts were analysed again.
+ * SYNOPSIS
+ */
+void RB_Document_Reset(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document.
+ * NOTES
+ *   The header name index is emptied as well, the headers have
+ *   to be added to it again in part order.  The headers of each
+ *   part are put back in the order of the source file.
+ * SOURCE
+ */
+{
+    struct RB_Part     *i_part;
+    struct RB_Path     *i_path;
+
+    free( document->headers );
+    document->headers = NULL;
+    document->no_headers = 0;
+    Free_Header_Names( document );
+
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        struct RB_Filename *filename = i_part->filename;
+        struct RB_header   *i_header;
+
+        /* RB_Document_Sort_Headers() sorted them */
+        Restore_Source_Order( i_part );
+        for ( i_header = i_part->headers;
+              i_header; i_header = i_header->next )
+        {
+            i_header->parent = NULL;
+            i_header->first_child = NULL;
+            i_header->next_sibling = NULL;
+            free( i_header->unique_name );
+            i_header->unique_name = NULL;
+            /* Points to an interned name */
+            i_header->file_name = NULL;
+        }
+        free( filename->docname );
+        filename->docname = NULL;
+        free( filename->fulldocname );
+        filename->fulldocname = NULL;
+    }
+    for ( i_path = document->srctree->first_path; i_path;
+          i_path = i_path->next )
+    {
+        free( i_path->docname );
+        i_path->docname = NULL;
+    }
+}
+
+/*******/
+
 /****f* Document/RB_Document_Create_Parts
  * FUNCTION
  *   Create all the parts of a document based on the sourcefiles in
@@ -161,7 +341,8 @@ void RB_Document_Create_Parts(
  * FUNCTION
  *   Fill the file_name attribute of all headers based either on the
  *   part or the singledoc name.   The file_name tells in which file
- *   the documentation for the header is to be stored.
+ *   the documentation for the header is to be stored.  It is
+ *   interned, so all headers in the same file share it.
  * SYNOPSIS
  */
 void RB_Fill_Header_Filename(
@@ -182,15 +363,18 @@ void RB_Fill_Header_Filename(
         {
             if ( document->actions.do_singledoc )
             {
-                i_header->file_name = document->singledoc_name;
+                i_header->file_name =
+                    RB_Intern_String( document->singledoc_name );
             }
             else if ( document->actions.do_multidoc )
             {
-                i_header->file_name = RB_Get_FullDocname( i_part->filename );
+                i_header->file_name =
+                    RB_Intern_String( RB_Get_FullDocname( i_part->filename ) );
             }
             else if ( document->actions.do_singlefile )
             {
-                i_header->file_name = document->singledoc_name;
+                i_header->file_name =
+                    RB_Intern_String( document->singledoc_name );
             }
             else
             {
@@ -503,70 +687,225 @@ void RB_Document_Collect_Headers(
 
 /*******/
 
-/* TODO Documentation */
+/****f* Document/RB_Document_Add_Header_Name
+ * FUNCTION
+ *   Add a header to the header name index of a document.  The
+ *   table is doubled in size whenever it gets more than half full.
+ * SYNOPSIS
+ */
+void RB_Document_Add_Header_Name(
+    struct RB_Document *document,
+    struct RB_header *header )
+/*
+ * INPUTS
+ *   o document -- the document.
+ *   o header   -- the header, header->name should be set.
+ * SEE ALSO
+ *   RB_Part_Add_Header(), RB_Document_Check_For_Duplicate()
+ * SOURCE
+ */
+{
+    struct RB_Header_Name *entry;
+    unsigned long       bucket;
+
+    if ( !header->name )
+    {
+        return;
+    }
+
+    if ( 2 * ( document->no_header_names + 1 ) >
+         document->header_names_mask + 1 )
+    {
+        /* Grow the table and redistribute the entries */
+        unsigned long       new_mask =
+            RB_Hash_Table_Size( document->no_header_names + 1 ) - 1;
+        struct RB_Header_Name **new_names =
+            calloc( new_mask + 1, sizeof( struct RB_Header_Name * ) );
+        unsigned long       i;
+
+        if ( !new_names )
+        {
+            RB_Panic( "Out of memory! %s()\n",
+                      "RB_Document_Add_Header_Name" );
+        }
+        if ( document->header_names )
+        {
+            for ( i = 0; i <= document->header_names_mask; ++i )
+            {
+                struct RB_Header_Name *next_entry;
+
+                for ( entry = document->header_names[i]; entry;
+                      entry = next_entry )
+                {
+                    next_entry = entry->next;
+                    bucket = entry->hash & new_mask;
+                    entry->next = new_names[bucket];
+                    new_names[bucket] = entry;
+                }
+            }
+            free( document->header_names );
+        }
+        document->header_names = new_names;
+        document->header_names_mask = new_mask;
+    }
+
+    entry = malloc( sizeof( struct RB_Header_Name ) );
+    if ( !entry )
+    {
+        RB_Panic( "Out of memory! %s()\n", "RB_Document_Add_Header_Name" );
+    }
+    entry->header = header;
+    entry->hash = RB_Hash_String( header->name, strlen( header->name ) );
+    entry->sequence = document->no_header_names;
+    bucket = entry->hash & document->header_names_mask;
+    entry->next = document->header_names[bucket];
+    document->header_names[bucket] = entry;
+    ++( document->no_header_names );
+}
 
+/*******/
+
+
+/****f* Document/RB_Document_Check_For_Duplicate
+ * FUNCTION
+ *   Check if there already is a header with one of the names of
+ *   the given header.  Only the headers that were added to one of
+ *   the parts of the document are considered.
+ * SYNOPSIS
+ */
 struct RB_header   *RB_Document_Check_For_Duplicate(
     struct RB_Document *arg_document,
     struct RB_header *hdr )
+/*
+ * INPUTS
+ *   o arg_document -- the document.
+ *   o hdr          -- the header to be checked.
+ * RESULT
+ *   The header that was added first and has a name equal to one
+ *   of the names of hdr, or NULL if there is no such header.
+ * SOURCE
+ */
 {
-    struct RB_Part     *i_part;
+    struct RB_header   *duplicate = NULL;
+    unsigned long       duplicate_sequence = 0;
+    int                 i;
 
-    for ( i_part = arg_document->parts; i_part; i_part = i_part->next )
+    if ( !arg_document->header_names )
     {
-        struct RB_header   *i_header;
+        return NULL;
+    }
 
-        for ( i_header = i_part->headers; i_header;
-              i_header = i_header->next )
+    for ( i = 0; i < hdr->no_names; i++ )
+    {
+        struct RB_Header_Name *entry;
+        unsigned long       hash =
+            RB_Hash_String( hdr->names[i], strlen( hdr->names[i] ) );
+
+        for ( entry =
+              arg_document->header_names[hash &
+                                         arg_document->header_names_mask];
+              entry; entry = entry->next )
         {
-            int                 i;
-
-            if ( hdr == i_header )
-                continue;
-
-            for ( i = 0; i < hdr->no_names; i++ )
-                if ( strcmp( hdr->names[i], i_header->name ) == 0 )
-                    return i_header;
+            if ( ( entry->hash == hash ) &&
+                 ( entry->header != hdr ) &&
+                 ( !duplicate || ( entry->sequence < duplicate_sequence ) )
+                 && ( hdr->names[i] == entry->header->name ) )
+            {
+                duplicate = entry->header;
+                duplicate_sequence = entry->sequence;
+            }
         }
     }
-    return NULL;
+    return duplicate;
 }
 
+/*******/
 
-/*  TODO Documentation 
- If A is called   qqqq/ffff and B is called  ffff/zzzz then A is the
- parent of B
-*/
 
+/****f* Document/RB_Document_Link_Headers
+ * FUNCTION
+ *   Find the parent of each header.
+ *   If A is called   qqqq/ffff and B is called  ffff/zzzz then A is the
+ *   parent of B.  If there are several headers with the function name
+ *   ffff, the one that comes last in document->headers is used.
+ *
+ *   To avoid comparing every header with every other header the
+ *   function names are first stored in a hash table.  Each bucket
+ *   is a chain of header indices ordered from high to low, so the
+ *   first match found is the last one in document->headers.
+ * SYNOPSIS
+ */
 void RB_Document_Link_Headers(
     struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document, RB_Document_Collect_Headers() must
+ *                 have been called.
+ * SOURCE
+ */
 {
     unsigned long       i;
-    unsigned long       j;
-    struct RB_header   *parent;
-    struct RB_header   *child;
-    char               *parent_name;
-    char               *child_name;
+    unsigned long       mask;
+    long               *buckets;
+    long               *chain;
 
     RB_Say( "Linking all %d headers.\n", SAY_INFO, document->no_headers );
+    if ( document->no_headers == 0 )
+    {
+        return;
+    }
+
+    mask = RB_Hash_Table_Size( document->no_headers ) - 1;
+    buckets = malloc( ( mask + 1 ) * sizeof( long ) );
+    chain = malloc( document->no_headers * sizeof( long ) );
+    if ( !buckets || !chain )
+    {
+        RB_Panic( "Out of memory! %s()\n", "RB_Document_Link_Headers" );
+    }
+    for ( i = 0; i <= mask; i++ )
+    {
+        buckets[i] = -1;
+    }
+
+    /* Index all function names */
     for ( i = 0; i < document->no_headers; i++ )
     {
-        parent = ( document->headers )[i];
-        parent_name = parent->function_name;
-        for ( j = 0; j < document->no_headers; j++ )
+        char               *parent_name =
+            ( document->headers )[i]->function_name;
+        unsigned long       bucket =
+            RB_Hash_String( parent_name, strlen( parent_name ) ) & mask;
+
+        chain[i] = buckets[bucket];
+        buckets[bucket] = i;
+    }
+
+    /* And look up the parent of each header */
+    for ( i = 0; i < document->no_headers; i++ )
+    {
+        struct RB_header   *child = ( document->headers )[i];
+        char               *child_name = child->module_name;
+        long                j;
+
+        j = buckets[RB_Hash_String( child_name, strlen( child_name ) ) &
+                    mask];
+        for ( ; j >= 0; j = chain[j] )
         {
-            if ( i != j )
+            /* The names are interned */
+            if ( ( ( unsigned long ) j != i ) &&
+                 ( child_name == ( document->headers )[j]->function_name ) )
             {
-                child = ( document->headers )[j];
-                child_name = child->module_name;
-                if ( strcmp( child_name, parent_name ) == 0 )
-                {
-                    child->parent = parent;
-                }
+                child->parent = ( document->headers )[j];
+                break;
             }
         }
     }
+
+    free( chain );
+    free( buckets );
 }
 
+/*******/
+
 
 /****f* Document/RB_Loop_Check
  * FUNCTION
@@ -632,6 +971,51 @@ void RB_Loop_Check(
 /*******/
 
 
+/****f* Document/RB_Document_Link_Children
+ * FUNCTION
+ *   Store for each header the list of its childern, so the header
+ *   hierarchy can be walked from the top down without searching
+ *   all headers for the childern of each header.
+ *   The childern of a header are in the same order as they are
+ *   in document->headers.
+ * SYNOPSIS
+ */
+void RB_Document_Link_Children(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document, RB_Loop_Check() must have been
+ *                 called.
+ * NOTES
+ *   Headers that are added or reordered afterwards are not in
+ *   the lists.
+ * SOURCE
+ */
+{
+    long                i;
+
+    for ( i = 0; i < ( long ) document->no_headers; i++ )
+    {
+        ( document->headers )[i]->first_child = NULL;
+        ( document->headers )[i]->next_sibling = NULL;
+    }
+    /* Walk backwards, so prepending keeps the childern in order */
+    for ( i = ( long ) document->no_headers - 1; i >= 0; i-- )
+    {
+        struct RB_header   *header = ( document->headers )[i];
+        struct RB_header   *parent = header->parent;
+
+        if ( parent )
+        {
+            header->next_sibling = parent->first_child;
+            parent->first_child = header;
+        }
+    }
+}
+
+/*******/
+
+
 /* TODO Documentation */
 void RB_Document_Split_Parts(
     struct RB_Document *document )
@@ -689,6 +1073,9 @@ void RB_Document_Split_Parts(
             }
             i_part->headers = NULL;
             i_part->last_header = NULL;
+            /* The headers moved, but their memory stays with the
+             * document. */
+            RB_Move_Arena( &( document->arena ), &( i_part->arena ) );
         }
         /* Remove old part from document */
         RB_Free_RB_Document_Parts( document );
@@ -827,7 +1214,7 @@ FILE               *RB_Open_SingleDocumentation(
     }
     RB_Add_Extension( document->extension, name );
 
-    file = fopen( name, "w" );
+    file = RB_Open_Output_File( name );
     if ( file )
     {
         /* File opened  */
@@ -864,6 +1251,9 @@ struct RB_Document *RB_Get_RB_Document(
         document->parts = NULL;
         document->links = NULL;
         document->headers = NULL;
+        document->header_names = NULL;
+        document->header_names_mask = 0;
+        document->no_header_names = 0;
         document->doctype = UNKNOWN;
         document->actions = No_Actions();
         document->srctree = NULL;
@@ -874,6 +1264,9 @@ struct RB_Document *RB_Get_RB_Document(
         document->charset = NULL;
         document->extension = NULL;
         document->first_section_level = 1;
+        document->no_jobs = 1;
+        document->cache = NULL;
+        RB_Init_Arena( &( document->arena ) );
         document->doctype_name = NULL;
         document->doctype_location = NULL;
     }
@@ -29,6 +29,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdio.h>
 #include "robodoc.h"
+#include "arena.h"
+
+/****s* Document/RB_Header_Name
+ * FUNCTION
+ *   An entry in the header name index of a document.  The index is
+ *   a hash table that maps the name of a header to the header.  It is
+ *   used to quickly find duplicate headers during the analysis.
+ * ATTRIBUTES
+ *   * next     -- next entry in the same bucket.
+ *   * header   -- the header.
+ *   * hash     -- the full hash value of header->name.
+ *   * sequence -- the order in which the header was added.
+ * SOURCE
+ */
+
+struct RB_Header_Name
+{
+    struct RB_Header_Name *next;
+    struct RB_header   *header;
+    unsigned long       hash;
+    unsigned long       sequence;
+};
+
+/*****/
 
 /****s* Document/RB_Document
  * NAME
@@ -47,6 +71,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *   * parts    -- linked list of all parts.
  *   * no_headers -- total number of headers
  *   * headers  -- array of pointers to all the headers.
+ *   * header_names -- hash table with all the headers added to
+ *               the parts so far, indexed on the header name.
+ *   * header_names_mask -- the size of header_names minus one.
+ *   * no_header_names -- number of entries in header_names.
  *   * srctree  -- the list of all sourcefiles in the srcroot.
  *   * doctype  -- the kind of documentation to be generated.
  *   * actions  -- what to de while analysing en generating.
@@ -60,6 +88,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *                            If set to 2 the first section will be 1.1
  *   * extension -- the extension used for the documentation
  *                files.
+ *   * no_jobs  -- the number of threads used to analyse the
+ *               source files and generate the documentation files,
+ *               see RB_Run_Jobs().
+ *   * cache    -- the cache with the analysis of earlier runs,
+ *               or NULL, see RB_Cache_Lookup().
+ *   * arena    -- the memory of the headers of parts that were
+ *               removed from the document, see
+ *               RB_Document_Split_Parts().
  *   * css      -- the cascading style sheet to be used.
  *   * js       -- the javascript to be used.
  *   * cur_part -- unused   TODO remove.
@@ -73,10 +109,16 @@ struct RB_Document
     struct RB_link     *links;
     unsigned long       no_headers;
     struct RB_header  **headers;
+    struct RB_Header_Name **header_names;
+    unsigned long       header_names_mask;
+    unsigned long       no_header_names;
     struct RB_Directory *srctree;
     T_RB_DocType        doctype;        /* HTML RTF etc */
     actions_t           actions;
     int                 first_section_level;  /* TODO document use of first_section_level in manual */
+    int                 no_jobs;
+    struct RB_Cache    *cache;
+    struct RB_Arena     arena;
     long                debugmode;      /* TODO This should not be in document */
     char               *singledoc_name;
     struct RB_Path     *srcroot;        /* TODO Better make this a char* */
@@ -100,6 +142,8 @@ struct RB_Document *RB_Get_RB_Document(
     void );
 void                RB_Free_RB_Document(
     struct RB_Document *document );
+void                RB_Document_Reset(
+    struct RB_Document *document );
 void                RB_Document_Add_Part(
     struct RB_Document *document,
     struct RB_Part *part );
@@ -119,9 +163,14 @@ void                RB_Document_Collect_Headers(
     struct RB_Document *document );
 void                RB_Document_Link_Headers(
     struct RB_Document *document );
+void                RB_Document_Link_Children(
+    struct RB_Document *document );
 void                RB_Fill_Header_Filename(
     struct RB_Document *document );
 
+void                RB_Document_Add_Header_Name(
+    struct RB_Document *document,
+    struct RB_header *header );
 struct RB_header   *RB_Document_Check_For_Duplicate(
     struct RB_Document *arg_document,
     struct RB_header *hdr );
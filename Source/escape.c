@@ -0,0 +1,331 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Escape
+ * FUNCTION
+ *   Find the characters that have to be escaped in HTML and XML
+ *   output: '<', '>', and '&'.  '\n' and '\t' are found too, they
+ *   should never end up in the output, and the generators check
+ *   this.
+ *
+ *   Most text contains only a few of these characters, so
+ *   RB_Generate_Chars() spends most of its time looking for them.
+ *   On x86 processors this is done 16 (SSE2) or 32 (AVX2)
+ *   characters at a time.  Which one is used is decided at runtime
+ *   by RB_Init_Markup_Scanner(), depending on what the processor
+ *   supports.  On other processors, or with other compilers,
+ *   the characters are checked one at a time.
+ *
+ *   Define ROBO_NO_SIMD to always use the portable version.
+ *****
+ */
+
+#include <string.h>
+#include "escape.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+#if !defined( ROBO_NO_SIMD ) && \
+    ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( defined( __clang__ ) || \
+      ( defined( __GNUC__ ) && \
+        ( ( __GNUC__ > 4 ) || \
+          ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ >= 9 ) ) ) ) )
+#define ROBO_MARKUP_SIMD
+#include <immintrin.h>
+#endif
+
+
+/****iv* Escape/markup_chars
+ * FUNCTION
+ *   For each character TRUE if RB_Find_Markup_Char() stops at it.
+ * SOURCE
+ */
+
+static const unsigned char markup_chars[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0
+    /* The rest is 0 */
+};
+
+/*******/
+
+
+/****if* Escape/Find_Markup_Char_Plain
+ * FUNCTION
+ *   Portable version of RB_Find_Markup_Char().
+ * SOURCE
+ */
+
+static size_t Find_Markup_Char_Plain(
+    const char *text,
+    size_t length )
+{
+    size_t              i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        if ( markup_chars[( unsigned char ) text[i]] )
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/*******/
+
+
+#ifdef ROBO_MARKUP_SIMD
+
+/****if* Escape/Find_Markup_Char_SSE2
+ * FUNCTION
+ *   SSE2 version of RB_Find_Markup_Char().  Compares 16 characters
+ *   with each of the markup characters, and uses the mask of the
+ *   result to find the first one that matched.
+ * SOURCE
+ */
+
+__attribute__ ( ( target( "sse2" ) ) )
+static size_t Find_Markup_Char_SSE2(
+    const char *text,
+    size_t length )
+{
+    const __m128i       lt = _mm_set1_epi8( '<' );
+    const __m128i       gt = _mm_set1_epi8( '>' );
+    const __m128i       amp = _mm_set1_epi8( '&' );
+    const __m128i       nl = _mm_set1_epi8( '\n' );
+    const __m128i       tab = _mm_set1_epi8( '\t' );
+    size_t              i;
+
+    for ( i = 0; i + 16 <= length; i += 16 )
+    {
+        __m128i             chars =
+            _mm_loadu_si128( ( const __m128i * ) ( text + i ) );
+        __m128i             found =
+            _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chars, lt ),
+                                        _mm_cmpeq_epi8( chars, gt ) ),
+                          _mm_or_si128( _mm_cmpeq_epi8( chars, amp ),
+                                        _mm_or_si128( _mm_cmpeq_epi8
+                                                      ( chars, nl ),
+                                                      _mm_cmpeq_epi8
+                                                      ( chars, tab ) ) ) );
+        unsigned int        mask = ( unsigned int ) _mm_movemask_epi8( found );
+
+        if ( mask )
+        {
+            return i + __builtin_ctz( mask );
+        }
+    }
+    return i + Find_Markup_Char_Plain( text + i, length - i );
+}
+
+/*******/
+
+
+/****if* Escape/Find_Markup_Char_AVX2
+ * FUNCTION
+ *   AVX2 version of RB_Find_Markup_Char(), the same as the SSE2
+ *   version but for 32 characters at a time.
+ * SOURCE
+ */
+
+__attribute__ ( ( target( "avx2" ) ) )
+static size_t Find_Markup_Char_AVX2(
+    const char *text,
+    size_t length )
+{
+    const __m256i       lt = _mm256_set1_epi8( '<' );
+    const __m256i       gt = _mm256_set1_epi8( '>' );
+    const __m256i       amp = _mm256_set1_epi8( '&' );
+    const __m256i       nl = _mm256_set1_epi8( '\n' );
+    const __m256i       tab = _mm256_set1_epi8( '\t' );
+    size_t              i;
+
+    for ( i = 0; i + 32 <= length; i += 32 )
+    {
+        __m256i             chars =
+            _mm256_loadu_si256( ( const __m256i * ) ( text + i ) );
+        __m256i             found =
+            _mm256_or_si256( _mm256_or_si256
+                             ( _mm256_cmpeq_epi8( chars, lt ),
+                               _mm256_cmpeq_epi8( chars, gt ) ),
+                             _mm256_or_si256( _mm256_cmpeq_epi8
+                                              ( chars, amp ),
+                                              _mm256_or_si256
+                                              ( _mm256_cmpeq_epi8
+                                                ( chars, nl ),
+                                                _mm256_cmpeq_epi8
+                                                ( chars, tab ) ) ) );
+        unsigned int        mask =
+            ( unsigned int ) _mm256_movemask_epi8( found );
+
+        if ( mask )
+        {
+            return i + __builtin_ctz( mask );
+        }
+    }
+    /* The rest is less than 32 characters */
+    return i + Find_Markup_Char_SSE2( text + i, length - i );
+}
+
+/*******/
+
+#endif /* ROBO_MARKUP_SIMD */
+
+
+/****iv* Escape/markup_scanner
+ * FUNCTION
+ *   The implementation RB_Find_Markup_Char() uses, and its name.
+ * SOURCE
+ */
+
+static size_t       (
+    *markup_scanner ) (
+    const char *,
+    size_t ) = Find_Markup_Char_Plain;
+static const char  *markup_scanner_name = "plain";
+
+/*******/
+
+
+/****f* Escape/RB_Use_Markup_Scanner
+ * FUNCTION
+ *   Select the implementation of RB_Find_Markup_Char().
+ * SYNOPSIS
+ */
+int RB_Use_Markup_Scanner(
+    enum RB_Markup_Scanner scanner )
+/*
+ * INPUTS
+ *   o scanner -- the implementation to use.
+ * RESULT
+ *   TRUE if the processor supports it, FALSE otherwise.  In that
+ *   case nothing is changed.
+ * SOURCE
+ */
+{
+    switch ( scanner )
+    {
+    case RB_SCAN_PLAIN:
+        markup_scanner = Find_Markup_Char_Plain;
+        markup_scanner_name = "plain";
+        return 1;
+#ifdef ROBO_MARKUP_SIMD
+    case RB_SCAN_SSE2:
+        __builtin_cpu_init(  );
+        if ( __builtin_cpu_supports( "sse2" ) )
+        {
+            markup_scanner = Find_Markup_Char_SSE2;
+            markup_scanner_name = "sse2";
+            return 1;
+        }
+        break;
+    case RB_SCAN_AVX2:
+        __builtin_cpu_init(  );
+        if ( __builtin_cpu_supports( "avx2" ) )
+        {
+            markup_scanner = Find_Markup_Char_AVX2;
+            markup_scanner_name = "avx2";
+            return 1;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*******/
+
+
+/****f* Escape/RB_Init_Markup_Scanner
+ * FUNCTION
+ *   Select the fastest implementation of RB_Find_Markup_Char()
+ *   the processor supports.
+ * SYNOPSIS
+ */
+void RB_Init_Markup_Scanner(
+    void )
+/*
+ * SOURCE
+ */
+{
+    if ( !RB_Use_Markup_Scanner( RB_SCAN_AVX2 ) &&
+         !RB_Use_Markup_Scanner( RB_SCAN_SSE2 ) )
+    {
+        RB_Use_Markup_Scanner( RB_SCAN_PLAIN );
+    }
+}
+
+/*******/
+
+
+/****f* Escape/RB_Get_Markup_Scanner_Name
+ * FUNCTION
+ *   Get the name of the implementation that is used by
+ *   RB_Find_Markup_Char().
+ * SYNOPSIS
+ */
+const char         *RB_Get_Markup_Scanner_Name(
+    void )
+/*
+ * RESULT
+ *   "plain", "sse2", or "avx2".
+ * SOURCE
+ */
+{
+    return markup_scanner_name;
+}
+
+/*******/
+
+
+/****f* Escape/RB_Find_Markup_Char
+ * FUNCTION
+ *   Find the first character in a text that has to be escaped in
+ *   HTML or XML, see markup_chars.
+ * SYNOPSIS
+ */
+size_t RB_Find_Markup_Char(
+    const char *text,
+    size_t length )
+/*
+ * INPUTS
+ *   o text   -- the text, it does not have to be terminated
+ *               with a '\0'.
+ *   o length -- the number of characters in the text.
+ * RESULT
+ *   The position of the first character that has to be escaped,
+ *   or length if there is none.
+ * SOURCE
+ */
+{
+    return markup_scanner( text, length );
+}
+
+/*******/
@@ -0,0 +1,51 @@
+#ifndef ROBODOC_ESCAPE_H
+#define ROBODOC_ESCAPE_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stddef.h>
+
+/****d* Escape/RB_Markup_Scanner
+ * FUNCTION
+ *   The implementations of RB_Find_Markup_Char().
+ *   o RB_SCAN_PLAIN -- one character at a time, works everywhere.
+ *   o RB_SCAN_SSE2  -- 16 characters at a time.
+ *   o RB_SCAN_AVX2  -- 32 characters at a time.
+ * SOURCE
+ */
+
+enum RB_Markup_Scanner
+{ RB_SCAN_PLAIN, RB_SCAN_SSE2, RB_SCAN_AVX2 };
+
+/*******/
+
+void                RB_Init_Markup_Scanner(
+    void );
+int                 RB_Use_Markup_Scanner(
+    enum RB_Markup_Scanner scanner );
+const char         *RB_Get_Markup_Scanner_Name(
+    void );
+size_t              RB_Find_Markup_Char(
+    const char *text,
+    size_t length );
+
+#endif /* ROBODOC_ESCAPE_H */
@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <dmalloc.h>
 #endif
 #include "util.h"
+#include "reader.h"
 
 /****h* ROBODoc/Filename
  * NAME
@@ -62,6 +63,7 @@ struct RB_Filename* RB_Get_RB_Filename( char *arg_filename, struct RB_Path *arg_
     rb_filename->fulldocname = 0;
     strcpy( rb_filename->name, arg_filename );
     rb_filename->path = arg_rb_path;
+    rb_filename->source = NULL;
     return rb_filename;
 }
 
@@ -106,9 +108,54 @@ RB_Free_RB_Filename( struct RB_Filename *arg_rb_filename )
     {
         free( arg_rb_filename->fulldocname );
     }
+    RB_Free_Kept_Source( arg_rb_filename );
     free( arg_rb_filename );
 }
 
+
+/****f* Filename/RB_Take_Kept_Source
+ * SYNOPSIS
+ */
+struct RB_Source_Reader *RB_Take_Kept_Source( struct RB_Filename *arg_rb_filename )
+/*
+ * FUNCTION
+ *   Take over the content of the file that the directory scan
+ *   kept, so the file does not have to be opened and read again.
+ * RESULT
+ *   The reader, free it with RB_Free_Source_Reader(), or NULL if
+ *   nothing was kept.
+ * SOURCE
+ */
+{
+    struct RB_Source_Reader *source = arg_rb_filename->source;
+
+    arg_rb_filename->source = NULL;
+    return source;
+}
+
+/*****/
+
+
+/****f* Filename/RB_Free_Kept_Source
+ * SYNOPSIS
+ */
+void RB_Free_Kept_Source( struct RB_Filename *arg_rb_filename )
+/*
+ * FUNCTION
+ *   Free the content of the file that the directory scan kept,
+ *   if it is not going to be analysed.
+ * SOURCE
+ */
+{
+    if ( arg_rb_filename->source )
+    {
+        RB_Free_Source_Reader( arg_rb_filename->source );
+        arg_rb_filename->source = NULL;
+    }
+}
+
+/*****/
+
 /* Set the fulldoc name, this is used in singledoc mode
  * since there the docname is preset by the user and not
  * derived from the sourcefile name.
@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "path.h"
 #include "links.h"
 
+struct RB_Source_Reader;
+
 /****s* Filename/RB_Filename
  * NAME
  *   RB_Filename --
@@ -39,6 +41,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *            the path for this file.
  *   * link   The link used to represent this file while in multidoc
  *            mode.
+ *   * source The content of the file, if the directory scan kept it
+ *            for the analyser, otherwise NULL.  See
+ *            RB_Take_Kept_Source().
  * SOURCE
  */
 
@@ -51,6 +56,7 @@ struct RB_Filename
     char               *fulldocname;
     struct RB_Path     *path;
     struct RB_link     *link;
+    struct RB_Source_Reader *source;
 };
 
 /******/
@@ -61,6 +67,10 @@ struct RB_Filename *RB_Get_RB_Filename(
     struct RB_Path *arg_rb_path );
 void                RB_Free_RB_Filename(
     struct RB_Filename *arg_rb_filename );
+struct RB_Source_Reader *RB_Take_Kept_Source(
+    struct RB_Filename *arg_rb_filename );
+void                RB_Free_Kept_Source(
+    struct RB_Filename *arg_rb_filename );
 
 /* */
 char               *Get_Fullname(
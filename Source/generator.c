@@ -97,6 +97,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "part.h"
 #include "file.h"
 #include "roboconfig.h"
+#include "escape.h"
+#include "jobs.h"
+#include "cache.h"
 
 /* Generators */
 #include "html_generator.h"
@@ -126,6 +129,11 @@ static void         Generate_Item_Line(
 void                Generate_Char(
     FILE *dest_doc,
     int cur_char );
+static void         Init_Plain_Chars(
+    void );
+static size_t       Extra_Quiet_Length(
+    int item_type,
+    char *text );
 static void         Generate_Index(
     struct RB_Document *document );
 
@@ -133,6 +141,11 @@ static void         Generate_Header(
     FILE *f,
     struct RB_header *header,
     char *docname );
+static void         Generate_Section_Start(
+    FILE *document_file,
+    struct RB_header *header,
+    struct RB_Document *document,
+    int depth );
 
 static void         Generate_Begin_Paragraph(
     FILE *dest_doc );
@@ -157,8 +170,58 @@ static void         Generate_End_List(
 static void         Pipe_Line(
     FILE *dest_doc,
     char *arg_line );
+static void         Generate_Part_Documentation(
+    struct RB_Document *document,
+    struct RB_Part *i_part );
+static void         Generate_Part_Job(
+    void *data,
+    int job );
+static int          Can_Generate_In_Parallel(
+    struct RB_Document *document );
+static int          Has_External_Items(
+    struct RB_header *header );
+static void         Update_Part_Documentation(
+    struct RB_Document *document,
+    struct RB_Part *i_part,
+    struct RB_Output_Manifest *outputs,
+    int unit );
+
+static ROBO_THREAD_LOCAL char piping = FALSE;
+
+/****is* Generator/RB_Generation
+ * FUNCTION
+ *   The parts of a document that are generated in parallel,
+ *   see RB_Generate_MultiDoc().
+ * ATTRIBUTES
+ *   o document -- the document.
+ *   o parts    -- all the parts of the document, in order.
+ *   o no_parts -- the number of parts.
+ *   o logs     -- the messages of the generation of each part.
+ *   o outputs  -- the output manifest, or NULL.
+ * SOURCE
+ */
+
+struct RB_Generation
+{
+    struct RB_Document *document;
+    struct RB_Part    **parts;
+    int                 no_parts;
+    struct RB_Message_Log *logs;
+    struct RB_Output_Manifest *outputs;
+};
 
-static char         piping = FALSE;
+/*******/
+
+/****v* Generator/plain_chars
+ * FUNCTION
+ *   For each character TRUE if it is written as it is in the
+ *   current output mode.  Set by Init_Plain_Chars().
+ * SOURCE
+ */
+
+static unsigned char plain_chars[256];
+
+/*******/
 
 
 /* TODO Documentation */
@@ -1320,6 +1383,12 @@ void RB_Generate_Documentation(
 {
     RB_SetCurrentFile( NULL );
 
+    Init_Plain_Chars(  );
+    if ( output_mode == HTML )
+    {
+        RB_HTML_Init_Source_Lexer(  );
+    }
+
     if ( document->actions.do_singledoc )
     {
         RB_Generate_SingleDoc( document );
@@ -1351,7 +1420,10 @@ void RB_Generate_MultiDoc(
  */
 {
     struct RB_Part     *i_part;
-    FILE               *document_file = NULL;
+    struct RB_Output_Manifest *outputs = NULL;
+    unsigned long long  structure_hash = 0;
+    int                 no_parts = 0;
+    int                 index_up_to_date = FALSE;
 
     RB_Document_Determine_DocFilePaths( document );
     RB_Document_Create_DocFilePaths( document );
@@ -1371,6 +1443,7 @@ void RB_Generate_MultiDoc(
     }
     RB_Document_Link_Headers( document );
     RB_Loop_Check( document );
+    RB_Document_Link_Children( document );
     RB_Fill_Header_Filename( document );
     RB_Name_Headers( document->headers, document->no_headers );
     RB_Sort_Items( document->headers, document->no_headers );
@@ -1381,66 +1454,360 @@ void RB_Generate_MultiDoc(
         RB_Create_JS( document );
     }
 
-
-    for ( i_part = document->parts; i_part != NULL; i_part = i_part->next )
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        ++no_parts;
+    }
+    /* Only generate what changed since the previous run.  Not when
+     * two parts share a manual page, the page has to be written
+     * by both of them. */
+    if ( document->cache &&
+         !( ( output_mode == TROFF ) &&
+            RB_TROFF_Has_Shared_Pages( document ) ) )
     {
+        structure_hash = RB_Cache_Hash_Structure( document->cache, document );
+        /* One unit per part, and one for the index. */
+        outputs = RB_Cache_Open_Outputs( document->cache,
+                                         document->docroot->name,
+                                         structure_hash, no_parts + 1 );
+    }
 
-        char               *srcname = Get_Fullname( i_part->filename );
-        char               *relname = RB_Get_Filename ( i_part->filename );
-        char               *docname = RB_Get_FullDocname( i_part->filename );
+    if ( ( document->no_jobs > 1 ) && Can_Generate_In_Parallel( document ) )
+    {
+        struct RB_Generation generation;
+        int                 i;
 
-        /* Nothing found in this part, do not generate it */
-        if ( i_part->headers == 0 )
-            continue;
+        generation.document = document;
+        generation.no_parts = no_parts;
+        generation.outputs = outputs;
+        generation.parts =
+            malloc( ( generation.no_parts + 1 ) *
+                    sizeof( struct RB_Part * ) );
+        generation.logs = malloc( ( generation.no_parts + 1 ) *
+                                  sizeof( struct RB_Message_Log ) );
+        if ( !generation.parts || !generation.logs )
+        {
+            RB_Panic( "Out of memory! %s()\n", "RB_Generate_MultiDoc" );
+        }
+        for ( i = 0, i_part = document->parts; i_part;
+              i_part = i_part->next, ++i )
+        {
+            generation.parts[i] = i_part;
+            /* Fill in the cached names before the threads share them. */
+            Get_Fullname( i_part->filename );
+            RB_Get_FullDocname( i_part->filename );
+        }
+        RB_Run_Jobs( document->no_jobs, generation.no_parts,
+                     Generate_Part_Job, &generation );
+        for ( i = 0; i < generation.no_parts; ++i )
+        {
+            RB_Replay_Message_Log( &( generation.logs[i] ) );
+        }
+        free( generation.parts );
+        free( generation.logs );
+    }
+    else
+    {
+        int                 i;
 
+        for ( i = 0, i_part = document->parts; i_part != NULL;
+              i_part = i_part->next, ++i )
+        {
+            Update_Part_Documentation( document, i_part, outputs, i );
+        }
+    }
 
-        if ( output_mode != TROFF )
+    if ( document->actions.do_index )
+    {
+        /* The index only depends on the structure of the document. */
+        if ( outputs )
+        {
+            index_up_to_date =
+                RB_Cache_Outputs_Up_To_Date( outputs, no_parts, "",
+                                             structure_hash );
+        }
+        if ( index_up_to_date )
         {
-            document_file = RB_Open_Documentation( i_part );
-            RB_Generate_Doc_Start( document,
-                                   document_file, srcname, relname, 1,
-                                   docname, document->charset );
+            RB_Say( "The index is up to date\n", SAY_INFO );
+        }
+        else
+        {
+            struct RB_Output_List list = { NULL, 0, 0 };
 
-            Generate_Begin_Navigation( document_file );
-            if ( document->actions.do_one_file_per_header )
-            {
-                RB_HTML_Generate_Nav_Bar_One_File_Per_Header( document,
-                                                              document_file,
-                                                              i_part->
-                                                              headers );
-            }
-            else
+            RB_Start_Output_List( &list );
+            Generate_Index( document );
+            RB_Stop_Output_List(  );
+            if ( outputs )
             {
-                Generate_IndexMenu( document_file, docname, document );
+                RB_Cache_Set_Outputs( outputs, no_parts, "", structure_hash,
+                                      &list );
             }
-            Generate_End_Navigation( document_file );
+            RB_Free_Output_List( &list );
+        }
+    }
 
-            Generate_Begin_Content( document_file );
+    if ( outputs )
+    {
+        RB_Cache_Save_Outputs( outputs );
+        RB_Cache_Free_Outputs( outputs );
+    }
+    RB_Free_Links(  );
+}
 
-            if ( ( document->actions.do_toc ) && document->no_headers )
-            {
-                RB_Generate_TOC_2( document_file,
-                                   document->headers, document->no_headers,
-                                   i_part, docname );
-            }
-            RB_Generate_Part( document_file, document, i_part );
-            Generate_End_Content( document_file );
+/*****/
+
+
+/****if* Generator/Generate_Part_Documentation
+ * FUNCTION
+ *   Create the documentation file for a single part, or in
+ *   case of TROFF the manual pages for all its headers.
+ * SYNOPSIS
+ */
+static void Generate_Part_Documentation(
+    struct RB_Document *document,
+    struct RB_Part *i_part )
+/*
+ * INPUTS
+ *   o document -- pointer to the RB_Document structure.
+ *   o i_part   -- the part.
+ * SOURCE
+ */
+{
+    FILE               *document_file = NULL;
+    char               *srcname = Get_Fullname( i_part->filename );
+    char               *relname = RB_Get_Filename( i_part->filename );
+    char               *docname = RB_Get_FullDocname( i_part->filename );
+
+    /* Nothing found in this part, do not generate it */
+    if ( i_part->headers == 0 )
+    {
+        return;
+    }
+
+    /* Each part starts with a clean formatting state, no matter
+     * which part was generated before it. */
+    piping = FALSE;
+    if ( output_mode == HTML )
+    {
+        RB_HTML_Reset_Source_State(  );
+    }
+
+    if ( output_mode != TROFF )
+    {
+        document_file = RB_Open_Documentation( i_part );
+        RB_Generate_Doc_Start( document,
+                               document_file, srcname, relname, 1,
+                               docname, document->charset );
 
-            RB_Generate_Doc_End( document_file, docname, srcname );
-            fclose( document_file );
+        Generate_Begin_Navigation( document_file );
+        if ( document->actions.do_one_file_per_header )
+        {
+            RB_HTML_Generate_Nav_Bar_One_File_Per_Header( document,
+                                                          document_file,
+                                                          i_part->headers );
         }
         else
         {
-            RB_Generate_Part( document_file, document, i_part );
+            Generate_IndexMenu( document_file, docname, document );
         }
+        Generate_End_Navigation( document_file );
+
+        Generate_Begin_Content( document_file );
+
+        if ( ( document->actions.do_toc ) && document->no_headers )
+        {
+            RB_Generate_TOC_2( document_file,
+                               document->headers, document->no_headers,
+                               i_part, docname );
+        }
+        RB_Generate_Part( document_file, document, i_part );
+        Generate_End_Content( document_file );
+
+        RB_Generate_Doc_End( document_file, docname, srcname );
+        RB_Close_Output_File( document_file );
+    }
+    else
+    {
+        RB_Generate_Part( document_file, document, i_part );
     }
+}
 
-    if ( document->actions.do_index )
+/*****/
+
+
+/****if* Generator/Update_Part_Documentation
+ * FUNCTION
+ *   Create the documentation of a part, unless the output
+ *   manifest shows that the documentation that was generated by
+ *   the previous run is still up to date.  The documentation
+ *   files are recorded in the manifest, unless there were
+ *   warnings, which should be given again by the next run.
+ *   Parts with items that use other files or run commands are
+ *   always generated, their output can not be predicted.
+ * SYNOPSIS
+ */
+static void Update_Part_Documentation(
+    struct RB_Document *document,
+    struct RB_Part *i_part,
+    struct RB_Output_Manifest *outputs,
+    int unit )
+/*
+ * INPUTS
+ *   o document -- pointer to the RB_Document structure.
+ *   o i_part   -- the part.
+ *   o outputs  -- the output manifest, or NULL to always generate
+ *                 the documentation.
+ *   o unit     -- the number of the part.
+ * SOURCE
+ */
+{
+    struct RB_Output_List list = { NULL, 0, 0 };
+    char               *docname;
+    unsigned long long  input_hash;
+    struct RB_header   *header;
+    int                 warnings;
+
+    if ( !outputs || !i_part->headers )
     {
-        Generate_Index( document );
+        Generate_Part_Documentation( document, i_part );
+        return;
+    }
+    for ( header = i_part->headers; header; header = header->next )
+    {
+        if ( Has_External_Items( header ) )
+        {
+            Generate_Part_Documentation( document, i_part );
+            return;
+        }
     }
 
-    RB_Free_Links(  );
+    docname = RB_Get_FullDocname( i_part->filename );
+    input_hash = RB_Cache_Hash_Part( i_part );
+    if ( RB_Cache_Outputs_Up_To_Date( outputs, unit, docname, input_hash ) )
+    {
+        RB_Say( "%s is up to date\n", SAY_INFO, docname );
+        return;
+    }
+    warnings = RB_Thread_Warnings(  );
+    RB_Start_Output_List( &list );
+    Generate_Part_Documentation( document, i_part );
+    RB_Stop_Output_List(  );
+    if ( RB_Thread_Warnings(  ) == warnings )
+    {
+        RB_Cache_Set_Outputs( outputs, unit, docname, input_hash, &list );
+    }
+    RB_Free_Output_List( &list );
+}
+
+/*****/
+
+
+/****if* Generator/Generate_Part_Job
+ * FUNCTION
+ *   Generate the documentation of one part on one of the threads
+ *   of the job pool.  All messages go to the message log of the
+ *   part.
+ * SYNOPSIS
+ */
+static void Generate_Part_Job(
+    void *data,
+    int job )
+/*
+ * INPUTS
+ *   o data -- the RB_Generation.
+ *   o job  -- the index of the part.
+ * SOURCE
+ */
+{
+    struct RB_Generation *generation = data;
+
+    RB_Start_Message_Log( &( generation->logs[job] ) );
+    Update_Part_Documentation( generation->document,
+                               generation->parts[job],
+                               generation->outputs, job );
+    RB_Stop_Message_Log(  );
+}
+
+/*****/
+
+
+/****if* Generator/Can_Generate_In_Parallel
+ * FUNCTION
+ *   Check whether the parts of a document can be generated in
+ *   parallel.  This is not the case if one of the headers has an
+ *   item that runs a tool, DOT, or a command, or includes a file.
+ *   These change the working directory of the whole program and
+ *   DOT files are numbered in the order in which they are created.
+ *   Neither can they if two TROFF headers share a manual page.
+ * SYNOPSIS
+ */
+static int Can_Generate_In_Parallel(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document, with all headers collected.
+ * RESULT
+ *   TRUE if the parts can be generated in parallel, FALSE otherwise.
+ * SOURCE
+ */
+{
+    unsigned long       i;
+
+    if ( ( output_mode == TROFF ) && RB_TROFF_Has_Shared_Pages( document ) )
+    {
+        return FALSE;
+    }
+    for ( i = 0; i < document->no_headers; ++i )
+    {
+        if ( Has_External_Items( document->headers[i] ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*****/
+
+
+/****if* Generator/Has_External_Items
+ * FUNCTION
+ *   Check whether one of the items of a header runs a tool, DOT,
+ *   or a command, or includes a file.
+ * SYNOPSIS
+ */
+static int Has_External_Items(
+    struct RB_header *header )
+/*
+ * INPUTS
+ *   o header -- the header.
+ * RESULT
+ *   TRUE if it has such an item, FALSE otherwise.
+ * SOURCE
+ */
+{
+    struct RB_Item     *item;
+
+    for ( item = header->items; item; item = item->next )
+    {
+        int                 line_nr;
+
+        for ( line_nr = 0; line_nr < item->no_lines; ++line_nr )
+        {
+            switch ( item->lines[line_nr]->kind )
+            {
+            case ITEM_LINE_TOOL_START:
+            case ITEM_LINE_DOT_START:
+            case ITEM_LINE_DOT_FILE:
+            case ITEM_LINE_EXEC:
+            case ITEM_LINE_INCLUDE:
+                return TRUE;
+            default:
+                break;
+            }
+        }
+    }
+    return FALSE;
 }
 
 /*****/
@@ -1478,6 +1845,7 @@ void RB_Generate_SingleDoc(
     }
     RB_Document_Link_Headers( document );
     RB_Loop_Check( document );
+    RB_Document_Link_Children( document );
     RB_Fill_Header_Filename( document );
     RB_Name_Headers( document->headers, document->no_headers );
     RB_Sort_Items( document->headers, document->no_headers );
@@ -1525,7 +1893,7 @@ void RB_Generate_SingleDoc(
 
     RB_Generate_Doc_End( document_file, "singledoc",
                          document->srcroot->name );
-    fclose( document_file );
+    RB_Close_Output_File( document_file );
 
     RB_Free_Links(  );
 }
@@ -1540,7 +1908,6 @@ void RB_Generate_SingleDoc(
  *   header hierarchy.  First the top level header's documentation
  *   is generated then, the documentation for all it's childern, then
  *   the next top level header's documentation is generated.
- *   This is a recursive proces.
  *   The idea is to create something like:
  *     1. Parentheader1
  *     1.1 Child1
@@ -1566,6 +1933,16 @@ void RB_Generate_Sections(
 
     depth = document->first_section_level;
 
+    /* The document can be generated more than once, see --watch */
+    if ( output_mode == HTML )
+    {
+        RB_HTML_Reset_Section_Counters(  );
+    }
+    else if ( output_mode == ASCII )
+    {
+        RB_ASCII_Reset_Section_Counters(  );
+    }
+
     RB_Say( "Generating Sections\n", SAY_INFO );
     for ( i = 0; i < document->no_headers; ++i )
     {
@@ -1585,42 +1962,36 @@ void RB_Generate_Sections(
 
 
 
-/****f* Generator/RB_Generate_Section
+/****f* Generator/Generate_Section_Start
  * FUNCTION
- *   Generate the documentation for a header and all
- *   its childern.
- * INPUTS
- *   o document_file -- destination file
- *   o parent -- the parent of the header for which the documentation
- *               is to be generated.
- *   o document -- pointer to the RB_Document structure.
- *   o depth -- level of sectioning ( 1  1.1  1.1.1  etc)
+ *   Generate the start of the section of a header, and the
+ *   documentation of the header itself.
  * SYNOPSIS
  */
-void RB_Generate_Section(
+static void Generate_Section_Start(
     FILE *document_file,
-    struct RB_header *parent,
+    struct RB_header *header,
     struct RB_Document *document,
     int depth )
 /*
- * NOTE
- *   This is a recursive function.
- * SEE ALSO
- *    RB_Generate_Sections
+ * INPUTS
+ *   o document_file -- destination file
+ *   o header -- the header for which the section is started.
+ *   o document -- pointer to the RB_Document structure.
+ *   o depth -- level of sectioning ( 1  1.1  1.1.1  etc)
  * SOURCE
  */
 {
-    unsigned long       i;
     char               *headername;
 
     /* We pass either modulename/name or just the name */
     if ( course_of_action.do_sectionnameonly )
     {
-        headername = parent->function_name;
+        headername = header->function_name;
     }
     else
     {
-        headername = parent->name;
+        headername = header->name;
     }
 
     switch ( output_mode )
@@ -1628,51 +1999,99 @@ void RB_Generate_Section(
     case XMLDOCBOOK:
         {
             RB_Generate_BeginSection( document_file, depth, headername,
-                                      parent );
+                                      header );
             /* Docbook output does not like the labels to be
              * generated before the <section> part
              */
-            Generate_Label( document_file, parent->unique_name );
-            Generate_Label( document_file, parent->name );
+            Generate_Label( document_file, header->unique_name );
+            Generate_Label( document_file, header->name );
         }
         break;
         /* lowtexx 21.09.2005 11:37 */
     case LATEX:
         {
             RB_Generate_BeginSection( document_file, depth, headername,
-                                      parent );
+                                      header );
             /* We have to start section before labeling in latex */
-            Generate_Label( document_file, parent->unique_name );
-            Generate_Label( document_file, parent->name );
+            Generate_Label( document_file, header->unique_name );
+            Generate_Label( document_file, header->name );
         }
         break;
         /* --- */
     default:
         {
-            Generate_Label( document_file, parent->unique_name );
-            Generate_Label( document_file, parent->name );
+            Generate_Label( document_file, header->unique_name );
+            Generate_Label( document_file, header->name );
             RB_Generate_BeginSection( document_file, depth, headername,
-                                      parent );
+                                      header );
         }
         break;
     }
 
-    RB_Generate_Nav_Bar( document, document_file, parent );
-    RB_Generate_Index_Entry( document_file, document->doctype, parent );
-    Generate_Header( document_file, parent, document->singledoc_name );
-    for ( i = 0; i < document->no_headers; ++i )
+    RB_Generate_Nav_Bar( document, document_file, header );
+    RB_Generate_Index_Entry( document_file, document->doctype, header );
+    Generate_Header( document_file, header, document->singledoc_name );
+}
+
+/******/
+
+
+/****f* Generator/RB_Generate_Section
+ * FUNCTION
+ *   Generate the documentation for a header and all
+ *   its childern.
+ * INPUTS
+ *   o document_file -- destination file
+ *   o parent -- the parent of the header for which the documentation
+ *               is to be generated.
+ *   o document -- pointer to the RB_Document structure.
+ *   o depth -- level of sectioning ( 1  1.1  1.1.1  etc)
+ * SYNOPSIS
+ */
+void RB_Generate_Section(
+    FILE *document_file,
+    struct RB_header *parent,
+    struct RB_Document *document,
+    int depth )
+/*
+ * NOTE
+ *   The subtree is walked depth first using the first_child,
+ *   next_sibling, and parent links of the headers, so the header
+ *   hierarchy can be of any depth. RB_Document_Link_Children() must
+ *   have been called.
+ * SEE ALSO
+ *    RB_Generate_Sections
+ * SOURCE
+ */
+{
+    struct RB_header   *header = parent;
+
+    for ( ;; )
     {
-        struct RB_header *header = ( document->headers )[i];
-        if ( header->parent == parent )
+        Generate_Section_Start( document_file, header, document, depth );
+        if ( header->first_child )
         {
-            RB_Generate_Section( document_file, header, document, depth + 1 );
+            header = header->first_child;
+            ++depth;
+            continue;
         }
-        else
+        /* Close sections until we find one that has a next sibling */
+        for ( ;; )
         {
-            /* Leeg */
+            RB_Generate_EndSection( document_file, depth, header->name );
+            if ( header == parent )
+            {
+                return;
+            }
+            if ( header->next_sibling )
+            {
+                header = header->next_sibling;
+                break;
+            }
+            header = header->parent;
+            --depth;
         }
     }
-    RB_Generate_EndSection( document_file, depth, parent->name );
 }
 
 /******/
@@ -1882,7 +2301,7 @@ static void Generate_Item(
   * SOURCE
   */
 {
-    static int          dot_nr = 1;
+    static ROBO_THREAD_LOCAL int dot_nr = 1;
     int                 line_nr;
     char               *dot_type = NULL;
     FILE               *tool = NULL;    /* Pipe handler to the tool we use */
@@ -2129,9 +2548,8 @@ static void Generate_Header(
     for ( cur_item = header->items; cur_item; cur_item = cur_item->next )
     {
         enum ItemType       item_type = cur_item->type;
-        char               *name = configuration.items.names[item_type];
 
-        if ( Is_Ignore_Item( name ) )
+        if ( Is_Ignore_Item( item_type ) )
         {
             /* User does not want this item */
         }
@@ -2470,9 +2888,16 @@ static void Generate_Item_Line(
     struct RB_header *fnames )
 {
     char               *cur_char = line;
-    char               *object_name = NULL;
-    char               *label_name = NULL;
-    char               *file_name = NULL;
+    /* The TROFF generator can shorten the line, this is harmless
+     * as RB_Find_Link() never matches past a '\0'. */
+    char               *line_end = line + strlen( line );
+    /* Plain characters are not written one by one, they are
+     * collected in a run that starts here and written as a whole
+     * before anything else is written. */
+    char               *run = line;
+    /* RB_HTML_Extra() has nothing to do before this character */
+    char               *quiet_end = line;
+    struct RB_Link_Match match;
 
     enum EIL_State
     { SKIP_ALPHANUM, SKIP_SPACE, SEARCH_LINK_START_WORD, SEARCH_LINK }
@@ -2613,14 +3038,17 @@ static void Generate_Item_Line(
 
         if ( ( ( state == SEARCH_LINK ) ||
                ( state == SEARCH_LINK_START_WORD ) ) &&
-             Find_Link( cur_char, &object_name, &label_name, &file_name ) )
+             RB_Find_Link( cur_char, line_end - cur_char, &match ) )
         {
+            char               *object_name = match.link->object_name;
+
             /* We found a link, so we can stop searching for one
              * for now.
              */
             state = SKIP_SPACE;
+            fwrite( run, 1, cur_char - run, dest_doc );
 
-            if ( object_name && fnames->no_names > 0 )
+            if ( fnames->no_names > 0 )
             {
                 extern char        *function_name(
     char * );
@@ -2634,14 +3062,16 @@ static void Generate_Item_Line(
                 if ( i < fnames->no_names )
                 {
                     RB_Generate_False_Link( dest_doc, object_name );
-                    cur_char += strlen( object_name ) - 1;
+                    cur_char += match.length - 1;
                 }
                 else
                 {
                     Generate_Link( dest_doc, docname,
-                                   file_name, label_name, object_name );
-                    cur_char += strlen( object_name ) - 1;
+                                   match.link->file_name,
+                                   match.link->label_name, object_name );
+                    cur_char += match.length - 1;
                 }
+                run = cur_char + 1;
             }
             else
             {
@@ -2650,23 +3080,38 @@ static void Generate_Item_Line(
         }
         else
         {
-            int                 res =
-                RB_HTML_Extra( dest_doc, item_type, cur_char,
-                               ( cur_char == line ) ? 0 : *( cur_char - 1 ) );
+            /* convert from signed to unsigned */
+            unsigned char       c2 = *cur_char;
+            int                 res = -1;
+
+            if ( cur_char >= quiet_end )
+            {
+                fwrite( run, 1, cur_char - run, dest_doc );
+                run = cur_char;
+                res = RB_HTML_Extra( dest_doc, item_type, cur_char,
+                                     ( cur_char ==
+                                       line ) ? 0 : *( cur_char - 1 ) );
+                if ( res < 0 )
+                {
+                    quiet_end = cur_char + 1 +
+                        Extra_Quiet_Length( item_type, cur_char + 1 );
+                }
+            }
 
             if ( res >= 0 )
             {
                 cur_char += res;
+                run = cur_char + 1;
             }
-            else
+            else if ( !plain_chars[c2] )
             {
-                /* convert from signed to unsigned */
-                unsigned char       c2 = *cur_char;
-
+                fwrite( run, 1, cur_char - run, dest_doc );
                 Generate_Char( dest_doc, c2 );
+                run = cur_char + 1;
             }
         }
     }
+    fwrite( run, 1, cur_char - run, dest_doc );
 
     /* TODO Move to the RTF_Generator */
     switch ( output_mode )
@@ -2806,6 +3251,157 @@ void Generate_Char(
 }
 
 
+/****f* Generator/RB_Generate_Chars
+ * FUNCTION
+ *   Generate a number of characters in the current output mode.
+ *   Runs of plain characters (see plain_chars) are copied to the
+ *   output in one go, all other characters are escaped by
+ *   Generate_Char().  For HTML and XML the runs are found with
+ *   RB_Find_Markup_Char().
+ * SYNOPSIS
+ */
+void RB_Generate_Chars(
+    FILE *dest_doc,
+    const char *text,
+    size_t length )
+/*
+ * INPUTS
+ *   * dest_doc -- destination file.
+ *   * text     -- the characters, they do not have to be terminated
+ *                 with a '\0'.
+ *   * length   -- the number of characters.
+ * SOURCE
+ */
+{
+    const char         *end = text + length;
+    const char         *run;
+
+    while ( text < end )
+    {
+        run = text;
+        if ( ( output_mode == HTML ) || ( output_mode == XMLDOCBOOK ) )
+        {
+            text += RB_Find_Markup_Char( text, end - text );
+        }
+        else
+        {
+            while ( ( text < end ) && plain_chars[( unsigned char ) *text] )
+            {
+                ++text;
+            }
+        }
+        fwrite( run, 1, text - run, dest_doc );
+        if ( text < end )
+        {
+            Generate_Char( dest_doc, ( unsigned char ) *text );
+            ++text;
+        }
+    }
+}
+
+/******/
+
+
+/****if* Generator/Init_Plain_Chars
+ * FUNCTION
+ *   Fill the plain_chars table for the current output mode.
+ *   A character is plain if the generator of the output mode
+ *   writes it as it is, without looking at or changing any
+ *   state.  The TROFF generator keeps state for every character,
+ *   so it has no plain characters.
+ * SYNOPSIS
+ */
+static void Init_Plain_Chars(
+    void )
+/*
+ * SOURCE
+ */
+{
+    char               *escaped = NULL;
+    unsigned int        c;
+
+    switch ( output_mode )
+    {
+    case TEST:
+        escaped = "";
+        break;
+    case XMLDOCBOOK:
+    case HTML:
+        /* Keep this the same as the characters RB_Find_Markup_Char()
+         * looks for. */
+        escaped = "<>&\n\t";
+        RB_Init_Markup_Scanner(  );
+        break;
+    case LATEX:
+        escaped = "&_%^{}$#<>|~\\\n\t";
+        break;
+    case RTF:
+        escaped = "\\{}\n\t";
+        break;
+    case ASCII:
+        escaped = "";
+        break;
+    case TROFF:
+    case UNKNOWN:
+    default:
+        break;
+    }
+
+    for ( c = 0; c < 256; ++c )
+    {
+        /* The test generator converts latin1 to utf8 */
+        plain_chars[c] = ( escaped != NULL ) && ( c != '\0' ) &&
+            ( strchr( escaped, ( int ) c ) == NULL ) &&
+            ( ( output_mode != TEST ) || ( c < 0x80 ) );
+    }
+}
+
+/******/
+
+
+/****if* Generator/Extra_Quiet_Length
+ * FUNCTION
+ *   Count the characters for which RB_HTML_Extra() has nothing to
+ *   do, so Generate_Item_Line() does not have to call it for every
+ *   character.
+ * SYNOPSIS
+ */
+static size_t Extra_Quiet_Length(
+    int item_type,
+    char *text )
+/*
+ * INPUTS
+ *   * item_type -- the type of the item the text belongs to.
+ *   * text      -- the rest of the line.
+ * RESULT
+ *   The number of characters at the start of text that can be
+ *   skipped.
+ * SOURCE
+ */
+{
+    switch ( output_mode )
+    {
+    case HTML:
+        return RB_HTML_Extra_Quiet_Length( item_type, text );
+    case TROFF:
+        /* RB_TROFF_Generate_Extra() can change the line */
+        return 0;
+    case TEST:
+    case XMLDOCBOOK:
+    case LATEX:
+    case RTF:
+    case ASCII:
+        return strlen( text );
+    case UNKNOWN:
+    default:
+        assert( 0 );
+    }
+    return 0;
+}
+
+/******/
+
+
 /****f* Generator/RB_Get_SubIndex_FileName
  * FUNCTION
  *   Get the name of the master index file for a specific
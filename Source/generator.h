@@ -113,6 +113,10 @@ void                RB_Generate_SingleDoc(
     struct RB_Document *document );
 void                RB_Generate_MultiDoc(
     struct RB_Document *document );
+void                RB_Generate_Chars(
+    FILE *dest_doc,
+    const char *text,
+    size_t length );
 void                Generate_Link(
     FILE *dest_doc,
     char *docname,
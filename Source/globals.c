@@ -45,7 +45,7 @@ int                 number_of_warnings = 0;
 /* Pointer to the name of the current file that is being analysed,
    use by RB_Panic */
 
-char               *current_file = 0;
+ROBO_THREAD_LOCAL char *current_file = 0;
 
 /****v* Globals/document_title
  * NAME
@@ -113,14 +113,15 @@ char                line_buffer[MAX_LINE_LEN];
 
 /****v* Globals/myLine
  * NAME
- *   myLine -- dynamic buffer for current line
+ *   myLine -- the current line
  * FUNCTION
- *   Temporary storage area for lines
- *   that are read from an input file.
+ *   The line of the source file that is being analysed.
+ *   It points into the RB_Source_Reader of the file, so it
+ *   is only valid while the file is being analysed.
  * SOURCE
  */
 
-char               *myLine = NULL;
+ROBO_THREAD_LOCAL char *myLine = NULL;
 
 /*******/
 
@@ -133,7 +134,7 @@ char               *myLine = NULL;
  * SOURCE
  */
 
-int                 readChars = 0;
+ROBO_THREAD_LOCAL int readChars = 0;
 
 /*******/
 
@@ -147,7 +148,7 @@ int                 readChars = 0;
  * SOURCE
  */
 
-int                 line_number = 0;
+ROBO_THREAD_LOCAL int line_number = 0;
 
 /*******/
 
@@ -179,7 +180,7 @@ char               *use_source_comments = NULL;
  * FUNCTION
  *   Frees all resources used by robodoc.
  * SEE ALSO
- *   RB_Free_Header(), RB_Free_Link()
+ *   RB_Free_Header(), RB_Free_Links()
  * SOURCE
  */
 
@@ -187,10 +188,6 @@ void RB_Close_The_Shop(
     void )
 {
 /* TODO    if (link_index) { free(link_index); } */
-    if ( myLine )
-    {
-        free( myLine );
-    }
 }
 
 /******/
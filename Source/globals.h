@@ -80,14 +80,14 @@ extern char        *use_source_comments;
 extern int          number_of_warnings;
 extern unsigned int link_index_size;
 extern struct RB_link **link_index;
-extern char        *current_file;
+extern ROBO_THREAD_LOCAL char *current_file;
 extern T_RB_DocType output_mode;
 extern actions_t    course_of_action;
-extern int          line_number;
+extern ROBO_THREAD_LOCAL int line_number;
 extern char         line_buffer[MAX_LINE_LEN];
 extern char        *whoami;
-extern char        *myLine;
-extern int          readChars;
+extern ROBO_THREAD_LOCAL char *myLine;
+extern ROBO_THREAD_LOCAL int readChars;
 extern long         debugmode;
 
 #endif /* ROBODOC_GLOBALS_H */
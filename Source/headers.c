@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 #include "robodoc.h"
@@ -46,9 +47,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define NO_MARKER_LOCKED 100000
 #define NO_MARKER        100002
 
-static int          locked_header_marker = NO_MARKER_LOCKED;
-static int          locked_end_marker    = NO_MARKER_LOCKED;
-static int          locked_remark_marker = NO_MARKER_LOCKED;
+static ROBO_THREAD_LOCAL int locked_header_marker = NO_MARKER_LOCKED;
+static ROBO_THREAD_LOCAL int locked_end_marker = NO_MARKER_LOCKED;
+static ROBO_THREAD_LOCAL int locked_remark_marker = NO_MARKER_LOCKED;
 
 /****v* Headers/header_markers
  * NAME
@@ -254,20 +255,457 @@ char               *robo_end[] = { "/*ROBODOC_END*", "*ROBODOC_END*", NULL };
 /****/
 
 
-/***f* Headers/RB_Is_Begin_Marker
+/****is* Headers/RB_Marker_State
  * FUNCTION
- *   Scan a line and see if any of the begin-of-a-header-markers 
- *   defined in header_markers can be found.
+ *   A state of a RB_Marker_Automaton.  It is reached after reading
+ *   the first characters of one or more markers.  Markers of each
+ *   kind, see RB_Marker_Kind, are numbered by their position in
+ *   their configuration block.
+ * ATTRIBUTES
+ *   o first -- for each kind, the number of the first marker that
+ *              ends in this state, or -1.
+ *   o last  -- for each kind, the number of the last marker that
+ *              ends in this state, or -1.
+ *   o below -- for each kind, the number of the first marker that
+ *              ends in this state or in a state after it, or -1.
+ * SOURCE
+ */
+
+struct RB_Marker_State
+{
+    int                 first[RB_NO_MARKER_KIND];
+    int                 last[RB_NO_MARKER_KIND];
+    int                 below[RB_NO_MARKER_KIND];
+};
+
+/*******/
+
+
+/****is* Headers/RB_Marker_Automaton
+ * FUNCTION
+ *   A number of sets of markers compiled into a single trie, see
+ *   Compile_Automaton().  Characters that only differ in case are
+ *   in the same class, so the markers are matched without regard
+ *   to case in a single pass over a line, see Match_Markers().
+ * ATTRIBUTES
+ *   o skip_whitespace -- if TRUE the markers are matched after the
+ *                        leading whitespace of a line.
+ *   o char_class      -- the class of each character, 0 for the
+ *                        characters that are not in any marker.
+ *   o no_classes      -- the number of classes.
+ *   o next            -- the state that follows state s on a
+ *                        character of class c is
+ *                        next[s * no_classes + c], or 0 if there
+ *                        is none.
+ *   o states          -- the states, 0 is the start state.
+ *   o no_states       -- the number of states.
+ *   o final           -- for each kind, the state in which each of
+ *                        its markers ends.
+ * SOURCE
+ */
+
+struct RB_Marker_Automaton
+{
+    int                 skip_whitespace;
+    int                 char_class[256];
+    int                 no_classes;
+    int                *next;
+    struct RB_Marker_State *states;
+    int                 no_states;
+    int                *final[RB_NO_MARKER_KIND];
+};
+
+/*******/
+
+
+/****is* Headers/RB_Marker_Match
+ * FUNCTION
+ *   What Match_Markers() found at the start of a line.
+ * ATTRIBUTES
+ *   o text        -- the line without its leading whitespace, if
+ *                    the automaton skips it.
+ *   o prefix      -- for each kind, the number of the first marker
+ *                    text starts with, or -1.
+ *   o prefix_end  -- the text after that marker.
+ *   o common      -- for each kind, the number of the first marker
+ *                    that text starts with or that starts with all
+ *                    of text, or -1.
+ *   o common_end  -- the text after the part text and that marker
+ *                    have in common.
+ *   o token_state -- the state reached on the text up to its first
+ *                    space, or -1 if no marker starts with it.
+ *   o token_end   -- that space or the end of text.
+ * SOURCE
+ */
+
+struct RB_Marker_Match
+{
+    char               *text;
+    int                 prefix[RB_NO_MARKER_KIND];
+    char               *prefix_end[RB_NO_MARKER_KIND];
+    int                 common[RB_NO_MARKER_KIND];
+    char               *common_end[RB_NO_MARKER_KIND];
+    int                 token_state;
+    char               *token_end;
+};
+
+/*******/
+
+
+/****iv* Headers/header_automaton
+ * FUNCTION
+ *   The compiled header markers, end markers, remark begin markers
+ *   and remark end markers.  All of them are matched after the
+ *   leading whitespace of a line.
+ * SOURCE
+ */
+
+static struct RB_Marker_Automaton header_automaton;
+
+/*******/
+
+
+/****iv* Headers/remark_automaton
+ * FUNCTION
+ *   The compiled remark markers.  They are matched at the very
+ *   start of a line.
+ * SOURCE
+ */
+
+static struct RB_Marker_Automaton remark_automaton;
+
+/*******/
+
+
+/****if* Headers/Add_Marker_State
+ * FUNCTION
+ *   Add a state, that no marker ends in yet, to an automaton.
  * SYNOPSIS
  */
-int RB_Is_Begin_Marker(
+static int Add_Marker_State(
+    struct RB_Marker_Automaton *automaton )
+/*
+ * RESULT
+ *   The number of the new state.
+ * SOURCE
+ */
+{
+    struct RB_Marker_State *state;
+    int                 kind;
+
+    state = &( automaton->states[automaton->no_states] );
+
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        state->first[kind] = -1;
+        state->last[kind] = -1;
+        state->below[kind] = -1;
+    }
+    return automaton->no_states++;
+}
+
+/*******/
+
+
+/****if* Headers/Compile_Automaton
+ * FUNCTION
+ *   Compile a number of sets of markers into a single
+ *   RB_Marker_Automaton.
+ * SYNOPSIS
+ */
+static void Compile_Automaton(
+    struct RB_Marker_Automaton *automaton,
+    int skip_whitespace,
+    struct Parameters **markers )
+/*
+ * INPUTS
+ *   o automaton       -- the automaton to fill.
+ *   o skip_whitespace -- if TRUE the markers are matched after the
+ *                        leading whitespace of a line.
+ *   o markers         -- for each RB_Marker_Kind its markers, or
+ *                        NULL if they are not part of this
+ *                        automaton.
+ * SOURCE
+ */
+{
+    int                 max_no_states = 1;
+    int                 kind;
+    unsigned int        i;
+    int                 c;
+    char               *m;
+
+    automaton->skip_whitespace = skip_whitespace;
+    automaton->no_classes = 1;
+    memset( automaton->char_class, 0, sizeof( automaton->char_class ) );
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        for ( i = 0; markers[kind] && ( i < markers[kind]->number ); ++i )
+        {
+            for ( m = markers[kind]->names[i]; *m; ++m )
+            {
+                ++max_no_states;
+                if ( automaton->char_class[( unsigned char ) *m] == 0 )
+                {
+                    /* All characters with the same tolower() */
+                    for ( c = 0; c < 256; ++c )
+                    {
+                        if ( tolower( ( char ) c ) == tolower( *m ) )
+                        {
+                            automaton->char_class[c] = automaton->no_classes;
+                        }
+                    }
+                    ++automaton->no_classes;
+                }
+            }
+        }
+    }
+
+    automaton->next =
+        calloc( max_no_states * automaton->no_classes, sizeof( int ) );
+    automaton->states = malloc( max_no_states *
+                                sizeof( struct RB_Marker_State ) );
+    RB_Mem_Check( automaton->next );
+    RB_Mem_Check( automaton->states );
+    automaton->no_states = 0;
+    Add_Marker_State( automaton );
+
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        automaton->final[kind] = NULL;
+        if ( markers[kind] == NULL )
+        {
+            continue;
+        }
+        automaton->final[kind] =
+            malloc( ( markers[kind]->number + 1 ) * sizeof( int ) );
+        RB_Mem_Check( automaton->final[kind] );
+        /* The markers are added in order, so the first marker that
+         * reaches a state is the one with the lowest number. */
+        for ( i = 0; i < markers[kind]->number; ++i )
+        {
+            int                 state = 0;
+
+            if ( automaton->states[state].below[kind] < 0 )
+            {
+                automaton->states[state].below[kind] = i;
+            }
+            for ( m = markers[kind]->names[i]; *m; ++m )
+            {
+                int                 c_class =
+                    automaton->char_class[( unsigned char ) *m];
+                int                *next =
+                    &( automaton->next[state * automaton->no_classes +
+                                       c_class] );
+
+                if ( *next == 0 )
+                {
+                    *next = Add_Marker_State( automaton );
+                }
+                state = *next;
+                if ( automaton->states[state].below[kind] < 0 )
+                {
+                    automaton->states[state].below[kind] = i;
+                }
+            }
+            if ( automaton->states[state].first[kind] < 0 )
+            {
+                automaton->states[state].first[kind] = i;
+            }
+            automaton->states[state].last[kind] = i;
+            automaton->final[kind][i] = state;
+        }
+    }
+}
+
+/*******/
+
+
+/****if* Headers/Free_Automaton
+ * FUNCTION
+ *   Free the memory used by a RB_Marker_Automaton.
+ * SOURCE
+ */
+
+static void Free_Automaton(
+    struct RB_Marker_Automaton *automaton )
+{
+    int                 kind;
+
+    free( automaton->next );
+    free( automaton->states );
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        free( automaton->final[kind] );
+        automaton->final[kind] = NULL;
+    }
+    automaton->next = NULL;
+    automaton->states = NULL;
+    automaton->no_states = 0;
+}
+
+/*******/
+
+
+/****if* Headers/Match_Markers
+ * FUNCTION
+ *   Find all the markers of an automaton that a line starts with.
+ *   This reads every character of the line at most once, no matter
+ *   how many markers there are.
+ * SYNOPSIS
+ */
+static void Match_Markers(
+    struct RB_Marker_Automaton *automaton,
+    char *line,
+    struct RB_Marker_Match *match )
+/*
+ * INPUTS
+ *   o automaton -- the compiled markers.
+ *   o line      -- the line.
+ * OUTPUT
+ *   o match     -- what was found.
+ * SOURCE
+ */
+{
+    char               *c = line;
+    int                 state = 0;
+    int                 in_token = TRUE;
+    int                 kind;
+
+    if ( automaton->skip_whitespace )
+    {
+        c = RB_Skip_Whitespace( line );
+    }
+    match->text = c;
+    match->token_state = -1;
+    match->token_end = NULL;
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        match->prefix[kind] = -1;
+        match->prefix_end[kind] = NULL;
+    }
+
+    for ( ;; )
+    {
+        struct RB_Marker_State *s = &( automaton->states[state] );
+
+        for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+        {
+            if ( ( s->first[kind] >= 0 ) &&
+                 ( ( match->prefix[kind] < 0 ) ||
+                   ( s->first[kind] < match->prefix[kind] ) ) )
+            {
+                match->prefix[kind] = s->first[kind];
+                match->prefix_end[kind] = c;
+            }
+        }
+        if ( in_token && ( ( *c == ' ' ) || ( *c == '\0' ) ) )
+        {
+            match->token_state = state;
+            match->token_end = c;
+            in_token = FALSE;
+        }
+        if ( *c == '\0' )
+        {
+            break;
+        }
+        state = automaton->next[state * automaton->no_classes +
+                                automaton->char_class[( unsigned char ) *c]];
+        if ( state == 0 )
+        {
+            break;
+        }
+        ++c;
+    }
+
+    for ( kind = 0; kind < RB_NO_MARKER_KIND; ++kind )
+    {
+        match->common[kind] = match->prefix[kind];
+        match->common_end[kind] = match->prefix_end[kind];
+        if ( *c == '\0' )
+        {
+            /* The whole text was read, so all markers that start
+             * with it have it in common with the line. */
+            int                 below = automaton->states[state].below[kind];
+
+            if ( ( below >= 0 ) &&
+                 ( ( match->common[kind] < 0 ) ||
+                   ( below < match->common[kind] ) ) )
+            {
+                match->common[kind] = below;
+                match->common_end[kind] = c;
+            }
+        }
+    }
+}
+
+/*******/
+
+
+/****f* Headers/RB_Compile_Markers
+ * FUNCTION
+ *   Compile the header, end and remark markers of the
+ *   configuration, so that RB_Is_Begin_Marker(),
+ *   RB_Match_Header_Marker(), RB_Match_Remark_Marker() and the
+ *   other functions that look for markers can find them all in a
+ *   single pass over a line.
+ * SOURCE
+ */
+
+void RB_Compile_Markers(
+    void )
+{
+    struct Parameters  *markers[RB_NO_MARKER_KIND];
+
+    markers[RB_BEGIN_MARKER] = &( configuration.header_markers );
+    markers[RB_END_MARKER] = &( configuration.end_markers );
+    markers[RB_REMARK_MARKER] = NULL;
+    markers[RB_REMARK_BEGIN_MARKER] =
+        &( configuration.remark_begin_markers );
+    markers[RB_REMARK_END_MARKER] = &( configuration.remark_end_markers );
+    Compile_Automaton( &header_automaton, TRUE, markers );
+
+    markers[RB_BEGIN_MARKER] = NULL;
+    markers[RB_END_MARKER] = NULL;
+    markers[RB_REMARK_MARKER] = &( configuration.remark_markers );
+    markers[RB_REMARK_BEGIN_MARKER] = NULL;
+    markers[RB_REMARK_END_MARKER] = NULL;
+    Compile_Automaton( &remark_automaton, FALSE, markers );
+}
+
+/*******/
+
+
+/****f* Headers/RB_Free_Markers
+ * FUNCTION
+ *   Free the markers compiled by RB_Compile_Markers().
+ * SOURCE
+ */
+
+void RB_Free_Markers(
+    void )
+{
+    Free_Automaton( &header_automaton );
+    Free_Automaton( &remark_automaton );
+}
+
+/*******/
+
+
+/****if* Headers/Is_Begin_Marker
+ * FUNCTION
+ *   See RB_Is_Begin_Marker().
+ * SYNOPSIS
+ */
+static int Is_Begin_Marker(
     char *cur_line,
+    struct RB_Marker_Match *match,
     char **type )
 /*
  * INPUTS
- *   cur_line -- line to be searched.
+ *   o cur_line -- line to be searched.
+ *   o match    -- the markers found at the start of cur_line.
  * OUTPUT
- *   type     -- the kind of header
+ *   o type     -- the kind of header
  * RESULT
  *   TRUE  -- a begin header was found
  *   FALSE -- no begin header was found.
@@ -275,7 +713,7 @@ int RB_Is_Begin_Marker(
  */
 {
     int                 found = FALSE;
-    unsigned int        marker = NO_MARKER;     /* for the assert */
+    int                 marker = -1;
     char               *cur_mchar = NULL;
     char               *cur_char = NULL;
 
@@ -285,23 +723,9 @@ int RB_Is_Begin_Marker(
              ( locked_header_marker == NO_MARKER_LOCKED ) )
            || !( course_of_action.do_lockheader ) ) )
     {
-        for ( marker = 0;
-              ( marker < configuration.header_markers.number ) && !found;
-              marker++ )
-        {
-            cur_mchar = configuration.header_markers.names[marker];
-            for ( found = TRUE, cur_char = RB_Skip_Whitespace( cur_line );
-                  *cur_mchar && *cur_char && found; cur_mchar++, cur_char++ )
-            {
-                if ( tolower( *cur_mchar ) != tolower( *cur_char ) )
-                    found = FALSE;
-            }
-            if ( *cur_mchar != '\0' )
-            {
-                /* It is not a complete match */
-                found = FALSE;
-            }
-        }
+        marker = match->prefix[RB_BEGIN_MARKER];
+        found = ( marker >= 0 );
+        cur_char = match->prefix_end[RB_BEGIN_MARKER];
     }
     else if ( ( course_of_action.do_lockheader ) &&
               ( locked_header_marker != NO_MARKER_LOCKED ) )
@@ -331,11 +755,11 @@ int RB_Is_Begin_Marker(
         /* start of an header but nothing else */
         found = FALSE;
     }
-    else if ( !found ) 
+    else if ( !found )
     {
         /* Not found */
     }
-    else 
+    else
     {
         /* We found the start of a header, now check the remaining
          * part. */
@@ -345,7 +769,7 @@ int RB_Is_Begin_Marker(
          */
         *type = cur_char;
         ++cur_char;
-        if ( *cur_char == '\0' ) 
+        if ( *cur_char == '\0' )
         {
             found = FALSE;
         }
@@ -394,141 +818,386 @@ int RB_Is_Begin_Marker(
          ( course_of_action.do_lockheader ) &&
          ( locked_header_marker == NO_MARKER_LOCKED ) )
     {
-        assert( marker != NO_MARKER );
-        locked_header_marker = marker - 1;
+        assert( marker >= 0 );
+        locked_header_marker = marker;
         RB_Say( "header marker locked on %s\n", SAY_INFO,
                 configuration.header_markers.names[locked_header_marker] );
     }
     return found;
 }
 
+/*******/
+
+
+/****f* Headers/RB_Is_Begin_Marker
+ * FUNCTION
+ *   Scan a line and see if any of the begin-of-a-header-markers
+ *   defined in header_markers can be found.
+ * SYNOPSIS
+ */
+int RB_Is_Begin_Marker(
+    char *cur_line,
+    char **type )
+/*
+ * INPUTS
+ *   cur_line -- line to be searched.
+ * OUTPUT
+ *   type     -- the kind of header
+ * RESULT
+ *   TRUE  -- a begin header was found
+ *   FALSE -- no begin header was found.
+ * SOURCE
+ */
+{
+    struct RB_Marker_Match match;
+
+    Match_Markers( &header_automaton, cur_line, &match );
+    return Is_Begin_Marker( cur_line, &match, type );
+}
+
 /******/
 
 
-/* Generic function to skip a remark begin or end marker */
+/****iv* Headers/marker_needles
+ * FUNCTION
+ *   The strings the prefilter for begin markers looks for.  Each
+ *   begin marker contains at least one of them, so a line that
+ *   contains none of them can not start a header.  They are parts
+ *   of the markers in configuration.header_markers that contain no
+ *   letters, so they can be compared without regard to case.
+ *   If no_marker_needles is -1 there is no prefilter, and every
+ *   line has to be checked with RB_Is_Begin_Marker().
+ * SOURCE
+ */
+
+static char        *marker_needles[RB_MAX_MARKER_NEEDLES];
+static size_t       marker_needle_lengths[RB_MAX_MARKER_NEEDLES];
+static int          no_marker_needles = -1;
+
+/*******/
 
-static char        *RB_Skip_Remark_XXX_Marker(
-    char *cur_line,
-    struct Parameters *parameters )
+
+/****if* Headers/Is_Needle_Character
+ * FUNCTION
+ *   Check if a character of a marker can be part of a needle, that
+ *   is if it is the same in upper and lower case.
+ * SOURCE
+ */
+
+static int Is_Needle_Character(
+    char c )
 {
-    char               *cur_char;
-    char               *space_pos;
-    unsigned int        marker;
-    int                 found = FALSE;
+    return ( ( c != '\0' ) && ( c != '\n' ) && ( c != '\r' ) &&
+             ( ( unsigned char ) c < 128 ) && !isalpha( ( unsigned char ) c ) );
+}
 
-    cur_char = RB_Skip_Whitespace( cur_line );
-    space_pos = strchr( cur_char, ' ' );
-    /* Replace the first space on the line with a '\0'
-     * this makes the comparison with the remark markers
-     * much easier.
-     */
-    if ( space_pos )
-    {
-        *space_pos = '\0';
-    }
+/*******/
 
-    for ( marker = 0; ( marker < parameters->number ) && !found; marker++ )
-    {
-        found =
-            ( RB_Str_Case_Cmp( cur_char, parameters->names[marker] ) == 0 );
-    }
 
-    assert( found );
+/****if* Headers/Find_Needle
+ * FUNCTION
+ *   Find the first occurrence of a string in a block of memory.
+ * SYNOPSIS
+ */
+static char        *Find_Needle(
+    char *haystack,
+    size_t size,
+    char *needle,
+    size_t length )
+/*
+ * RESULT
+ *   A pointer to the occurrence, or NULL if there is none.
+ * SOURCE
+ */
+{
+    char               *end = haystack + size;
 
-    if ( space_pos )
+    while ( ( size_t ) ( end - haystack ) >= length )
     {
-        *space_pos = ' ';
-        return space_pos;
-    }
-    else
-    {
-        return cur_char + strlen( parameters->names[marker - 1] );
+        haystack = memchr( haystack, needle[0],
+                           ( size_t ) ( end - haystack ) - length + 1 );
+        if ( !haystack )
+        {
+            break;
+        }
+        if ( memcmp( haystack + 1, needle + 1, length - 1 ) == 0 )
+        {
+            return haystack;
+        }
+        ++haystack;
     }
+    return NULL;
 }
 
+/*******/
 
-/* Generic function to see if there is a remark begin or end marker */
 
-static int RB_Is_Remark_XXX_Marker(
-    char *cur_line,
-    struct Parameters *parameters )
+/****f* Headers/RB_Compile_Begin_Markers
+ * FUNCTION
+ *   Prepare the prefilter for begin markers, see marker_needles.
+ *   For each marker the longest run of characters without letters
+ *   is taken.  A needle that contains another one is not needed,
+ *   so for the default markers only "****" is left.  If more than
+ *   RB_MAX_MARKER_NEEDLES are left there is no prefilter.
+ *
+ *   This is called once, after the configuration is read.
+ * SYNOPSIS
+ */
+void RB_Compile_Begin_Markers(
+    void )
+/*
+ * SOURCE
+ */
 {
-    char               *cur_char;
-    char               *space_pos;
     unsigned int        marker;
-    int                 found = FALSE;
+    int                 i;
+    int                 j;
 
-    cur_char = RB_Skip_Whitespace( cur_line );
-    space_pos = strchr( cur_char, ' ' );
-    /* Replace the first space on the line with a '\0'
-     * this makes the comparison with the remark markers
-     * much easier.
-     */
-    if ( space_pos )
+    no_marker_needles = 0;
+    for ( marker = 0; marker < configuration.header_markers.number;
+          ++marker )
     {
-        *space_pos = '\0';
+        char               *c = configuration.header_markers.names[marker];
+        char               *best = NULL;
+        size_t              best_length = 0;
+
+        while ( *c )
+        {
+            char               *start = c;
+
+            while ( Is_Needle_Character( *c ) )
+            {
+                ++c;
+            }
+            if ( ( size_t ) ( c - start ) > best_length )
+            {
+                best = start;
+                best_length = ( size_t ) ( c - start );
+            }
+            if ( *c )
+            {
+                ++c;
+            }
+        }
+        if ( !best )
+        {
+            /* A marker with only letters, no prefilter */
+            no_marker_needles = -1;
+            return;
+        }
+        for ( i = 0; i < no_marker_needles; ++i )
+        {
+            if ( Find_Needle( best, best_length, marker_needles[i],
+                              marker_needle_lengths[i] ) )
+            {
+                /* A line with this marker also has needle i */
+                break;
+            }
+        }
+        if ( i < no_marker_needles )
+        {
+            continue;
+        }
+        /* Remove the needles that contain the new one */
+        for ( i = 0, j = 0; i < no_marker_needles; ++i )
+        {
+            if ( !Find_Needle( marker_needles[i], marker_needle_lengths[i],
+                               best, best_length ) )
+            {
+                marker_needles[j] = marker_needles[i];
+                marker_needle_lengths[j] = marker_needle_lengths[i];
+                ++j;
+            }
+        }
+        no_marker_needles = j;
+        if ( no_marker_needles == RB_MAX_MARKER_NEEDLES )
+        {
+            /* Too many different markers, no prefilter */
+            no_marker_needles = -1;
+            return;
+        }
+        marker_needles[no_marker_needles] = best;
+        marker_needle_lengths[no_marker_needles] = best_length;
+        ++no_marker_needles;
     }
+}
+
+/*******/
+
+
+/****f* Headers/RB_Start_Begin_Marker_Search
+ * FUNCTION
+ *   Start the search for begin markers in a new source file.
+ * SYNOPSIS
+ */
+void RB_Start_Begin_Marker_Search(
+    struct RB_Begin_Marker_Search *search )
+/*
+ * INPUTS
+ *   o search -- the search state.
+ * SOURCE
+ */
+{
+    int                 i;
 
-    for ( marker = 0; ( marker < parameters->number ) && !found; marker++ )
+    for ( i = 0; i < RB_MAX_MARKER_NEEDLES; ++i )
     {
-        found =
-            ( RB_Str_Case_Cmp( cur_char, parameters->names[marker] ) == 0 );
+        search->next[i] = -1;
     }
+}
+
+/*******/
 
-    if ( space_pos )
+
+/****f* Headers/RB_Find_Begin_Marker_Line
+ * FUNCTION
+ *   Find the first line that might start a header, without looking
+ *   at the lines one by one.  The whole rest of the source file is
+ *   searched for the needles of the prefilter (see marker_needles),
+ *   and the line with the first one is returned.  It still has to
+ *   be checked with RB_Is_Begin_Marker().
+ * SYNOPSIS
+ */
+size_t RB_Find_Begin_Marker_Line(
+    struct RB_Begin_Marker_Search *search,
+    char *data,
+    size_t size,
+    size_t position )
+/*
+ * INPUTS
+ *   o search   -- the search state, see
+ *                 RB_Start_Begin_Marker_Search().
+ *   o data     -- the content of the source file.
+ *   o size     -- its size.
+ *   o position -- the start of the line to search from.  It should
+ *                 not be before the position of an earlier call.
+ * RESULT
+ *   The start of the line, or size if no line after position can
+ *   start a header.
+ * SOURCE
+ */
+{
+    long                first = ( long ) size;
+    int                 i;
+
+    if ( no_marker_needles < 0 )
     {
-        *space_pos = ' ';
+        return position;
     }
+    for ( i = 0; i < no_marker_needles; ++i )
+    {
+        if ( search->next[i] < ( long ) position )
+        {
+            char               *found =
+                Find_Needle( data + position, size - position,
+                             marker_needles[i], marker_needle_lengths[i] );
 
-    return found;
+            search->next[i] = found ? ( long ) ( found - data ) :
+                ( long ) size;
+        }
+        if ( search->next[i] < first )
+        {
+            first = search->next[i];
+        }
+    }
+    if ( first < ( long ) size )
+    {
+        /* Go back to the start of the line */
+        while ( ( first > ( long ) position ) &&
+                ( data[first - 1] != '\n' ) )
+        {
+            --first;
+        }
+    }
+    return ( size_t ) first;
 }
 
+/*******/
 
-/* TODO Documentation */
-int RB_Is_Remark_End_Marker(
-    char *cur_line )
-{
-    return RB_Is_Remark_XXX_Marker( cur_line,
-                                    &( configuration.remark_end_markers ) );
-}
 
-/* TODO Documentation */
-int RB_Is_Remark_Begin_Marker(
-    char *cur_line )
+/****if* Headers/Match_Remark_XXX_Marker
+ * FUNCTION
+ *   Generic function to find a remark begin or end marker.  The
+ *   marker is the text up to the first space, after the leading
+ *   whitespace of the line.
+ * SYNOPSIS
+ */
+static char        *Match_Remark_XXX_Marker(
+    char *cur_line,
+    enum RB_Marker_Kind kind )
+/*
+ * INPUTS
+ *   o cur_line -- the line.
+ *   o kind     -- RB_REMARK_BEGIN_MARKER or RB_REMARK_END_MARKER.
+ * RESULT
+ *   The text after the marker, or NULL if there is none.
+ * SOURCE
+ */
 {
-    return RB_Is_Remark_XXX_Marker( cur_line,
-                                    &( configuration.remark_begin_markers ) );
+    struct RB_Marker_Match match;
+
+    Match_Markers( &header_automaton, cur_line, &match );
+    if ( ( match.token_state >= 0 ) &&
+         ( header_automaton.states[match.token_state].first[kind] >= 0 ) )
+    {
+        return match.token_end;
+    }
+    return NULL;
 }
 
-char               *RB_Skip_Remark_Begin_Marker(
+/*******/
+
+
+/****f* Headers/RB_Match_Remark_End_Marker
+ * FUNCTION
+ *   Check if a line starts with a remark end marker, such as "*)".
+ * SYNOPSIS
+ */
+char               *RB_Match_Remark_End_Marker(
     char *cur_line )
+/*
+ * RESULT
+ *   The text after the marker, or NULL if there is none.
+ * SOURCE
+ */
 {
-    return RB_Skip_Remark_XXX_Marker( cur_line,
-                                      &( configuration.
-                                         remark_begin_markers ) );
+    return Match_Remark_XXX_Marker( cur_line, RB_REMARK_END_MARKER );
 }
 
-char               *RB_Skip_Remark_End_Marker(
+/*******/
+
+
+/****f* Headers/RB_Match_Remark_Begin_Marker
+ * FUNCTION
+ *   Check if a line starts with a remark begin marker, such as "(*".
+ * SYNOPSIS
+ */
+char               *RB_Match_Remark_Begin_Marker(
     char *cur_line )
+/*
+ * RESULT
+ *   The text after the marker, or NULL if there is none.
+ * SOURCE
+ */
 {
-    return RB_Skip_Remark_XXX_Marker( cur_line,
-                                      &( configuration.remark_end_markers ) );
+    return Match_Remark_XXX_Marker( cur_line, RB_REMARK_BEGIN_MARKER );
 }
 
+/*******/
 
-/****f* Headers/RB_Is_End_Marker
+
+/****if* Headers/Is_End_Marker
  * FUNCTION
- *   Scan a line and see if any of the end of a header markers 
- *   defined in header_markers can be found.
+ *   See RB_Is_End_Marker().
  * SYNOPSIS
  */
-int RB_Is_End_Marker(
-    char *cur_line )
+static int Is_End_Marker(
+    char *cur_line,
+    struct RB_Marker_Match *match )
 /*
  * INPUTS
- *   cur_line -- line to be searched.
- * OUTPUT
- *   none
+ *   o cur_line -- line to be searched.
+ *   o match    -- the markers found at the start of cur_line.
  * RESULT
  *   TRUE  -- an end header was found
  *   FALSE -- none was found.
@@ -536,7 +1205,6 @@ int RB_Is_End_Marker(
  */
 {
     int                 found = FALSE;
-    unsigned int        marker = NO_MARKER;     /* For the assert */
     char               *cur_mchar;
     char               *cur_char;
 
@@ -546,25 +1214,10 @@ int RB_Is_End_Marker(
              ( locked_end_marker == NO_MARKER_LOCKED ) )
            || !( course_of_action.do_lockheader ) ) )
     {
-        for ( marker = 0;
-              ( marker < configuration.end_markers.number ) && !found;
-              marker++ )
-        {
-            cur_mchar = configuration.end_markers.names[marker];
-            cur_char = RB_Skip_Whitespace( cur_line );
-            if ( *cur_char )
-            {
-                for ( found = TRUE;
-                      *cur_mchar && *cur_char && found;
-                      cur_mchar++, cur_char++ )
-                {
-                    if ( tolower( *cur_mchar ) != tolower( *cur_char ) )
-                    {
-                        found = FALSE;
-                    }
-                }
-            }
-        }
+        /* The line matches as long as it does not differ from a
+         * marker, even if it ends before the marker does. */
+        found = ( *( match->text ) != '\0' ) &&
+            ( match->common[RB_END_MARKER] >= 0 );
     }
     else if ( ( course_of_action.do_lockheader ) &&
               ( locked_end_marker != NO_MARKER_LOCKED ) )
@@ -590,7 +1243,7 @@ int RB_Is_End_Marker(
 
     /* Locking on end markers does not work at the moment,
      * because there can be more than one end marker for
-     * a given language. TODO 
+     * a given language. TODO
 
     if ( found &&
          ( course_of_action.do_LOCKHEADER ) &&
@@ -606,90 +1259,154 @@ int RB_Is_End_Marker(
     return found;
 }
 
-/*****/
+/*******/
 
 
-/****f* Headers/RB_Has_Remark_Marker
+/****f* Headers/RB_Is_End_Marker
  * FUNCTION
- *   Check if a line starts with a remark marker.  This function
- *   assumes that the remark marker starts on the first character of
- *   the line.
+ *   Scan a line and see if any of the end of a header markers
+ *   defined in header_markers can be found.
  * SYNOPSIS
  */
-int RB_Has_Remark_Marker(
-    char *lline_buffer )
+int RB_Is_End_Marker(
+    char *cur_line )
 /*
  * INPUTS
- *   o lline_buffer -- the line of text.
+ *   cur_line -- line to be searched.
+ * OUTPUT
+ *   none
  * RESULT
- *   o TRUE -- it starts with a remark marker
- *   o FALSE -- it does not.
+ *   TRUE  -- an end header was found
+ *   FALSE -- none was found.
  * SOURCE
  */
 {
-    unsigned int        marker = 0;
-    unsigned int        marker_found = configuration.remark_markers.number;
-    int                 found = FALSE;
-    char               *space_pos = NULL;
+    struct RB_Marker_Match match;
 
-    space_pos = strchr( lline_buffer, ' ' );
+    Match_Markers( &header_automaton, cur_line, &match );
+    return Is_End_Marker( cur_line, &match );
+}
+
+/*****/
+
+
+/****f* Headers/RB_Match_Header_Marker
+ * FUNCTION
+ *   Check if a line starts with a begin marker or an end marker,
+ *   with a single pass over the line.  This is the same as calling
+ *   RB_Is_Begin_Marker() and then RB_Is_End_Marker().
+ * SYNOPSIS
+ */
+enum RB_Marker_Kind RB_Match_Header_Marker(
+    char *cur_line,
+    char **type )
+/*
+ * INPUTS
+ *   o cur_line -- line to be searched.
+ * OUTPUT
+ *   o type     -- the kind of header, if a begin marker was found.
+ * RESULT
+ *   o RB_BEGIN_MARKER   -- a begin marker was found.
+ *   o RB_END_MARKER     -- an end marker was found.
+ *   o RB_NO_MARKER_KIND -- neither was found.
+ * SOURCE
+ */
+{
+    struct RB_Marker_Match match;
 
-    /* Replace the first space on the line with a '\0'
-     * this makes the comparison with the remark markers
-     * much easier.
-     */
-    if ( space_pos )
+    Match_Markers( &header_automaton, cur_line, &match );
+    if ( Is_Begin_Marker( cur_line, &match, type ) )
+    {
+        return RB_BEGIN_MARKER;
+    }
+    else if ( Is_End_Marker( cur_line, &match ) )
     {
-        *space_pos = '\0';
+        return RB_END_MARKER;
     }
+    return RB_NO_MARKER_KIND;
+}
+
+/*******/
+
+
+/****if* Headers/Has_Remark_Marker
+ * FUNCTION
+ *   See RB_Has_Remark_Marker().
+ * SYNOPSIS
+ */
+static int Has_Remark_Marker(
+    struct RB_Marker_Match *match )
+/*
+ * INPUTS
+ *   o match -- the remark markers found at the start of the line.
+ * RESULT
+ *   o TRUE -- it starts with a remark marker
+ *   o FALSE -- it does not.
+ * SOURCE
+ */
+{
+    int                 marker_found = -1;
+    int                 found = FALSE;
+    int                 state = match->token_state;
 
     if ( ( ( course_of_action.do_lockheader ) &&
            ( locked_remark_marker == NO_MARKER_LOCKED ) )
          || !( course_of_action.do_lockheader ) )
     {
-        for ( marker = 0; marker < configuration.remark_markers.number;
-              marker++ )
+        if ( state >= 0 )
         {
-            if ( RB_Str_Case_Cmp
-                 ( lline_buffer,
-                   configuration.remark_markers.names[marker] ) == 0 )
-            {
-                marker_found = marker;
-                found = TRUE;
-            }
+            marker_found =
+                remark_automaton.states[state].last[RB_REMARK_MARKER];
+            found = ( marker_found >= 0 );
         }
     }
     else
     {
-        if ( RB_Str_Case_Cmp
-             ( lline_buffer,
-               configuration.remark_markers.names[locked_remark_marker] ) ==
-             0 )
-        {
-            marker_found = marker;
-            found = TRUE;
-        }
+        found = ( state >= 0 ) &&
+            ( state ==
+              remark_automaton.final[RB_REMARK_MARKER][locked_remark_marker] );
     }
 
     if ( found &&
          ( locked_remark_marker == NO_MARKER_LOCKED )
          && ( course_of_action.do_lockheader ) )
     {
-        assert( marker_found < configuration.remark_markers.number );
+        assert( marker_found >= 0 );
         locked_remark_marker = marker_found;
         RB_Say( "remark marker locked on %s\n", SAY_INFO,
                 configuration.remark_markers.names[locked_remark_marker] );
     }
 
-    /* Restore the space we replaced with a '\0' */
-    if ( space_pos )
-    {
-        *space_pos = ' ';
-    }
-
     return found;
 }
 
+/*******/
+
+
+/****f* Headers/RB_Has_Remark_Marker
+ * FUNCTION
+ *   Check if a line starts with a remark marker.  This function
+ *   assumes that the remark marker starts on the first character of
+ *   the line.  The marker is the text up to the first space.
+ * SYNOPSIS
+ */
+int RB_Has_Remark_Marker(
+    char *lline_buffer )
+/*
+ * INPUTS
+ *   o lline_buffer -- the line of text.
+ * RESULT
+ *   o TRUE -- it starts with a remark marker
+ *   o FALSE -- it does not.
+ * SOURCE
+ */
+{
+    struct RB_Marker_Match match;
+
+    Match_Markers( &remark_automaton, lline_buffer, &match );
+    return Has_Remark_Marker( &match );
+}
+
 /******/
 
 
@@ -707,31 +1424,51 @@ char               *RB_Skip_Remark_Marker(
  * SOURCE
  */
 {
-    unsigned int        marker, found;
-    char               *cur_char, *cur_mchar;
+    struct RB_Marker_Match match;
 
-    found = FALSE;
-    cur_char = NULL;
-    for ( marker = 0;
-          ( marker < configuration.remark_markers.number ) && !found;
-          marker++ )
+    Match_Markers( &remark_automaton, lline_buffer, &match );
+    if ( match.common[RB_REMARK_MARKER] >= 0 )
     {
-        cur_mchar = configuration.remark_markers.names[marker];
-        for ( found = TRUE, cur_char = lline_buffer;
-              *cur_mchar && *cur_char && found; cur_mchar++, cur_char++ )
-        {
-            if ( tolower( *cur_mchar ) != tolower( *cur_char ) )
-            {
-                found = FALSE;
-            }
-        }
+        return match.common_end[RB_REMARK_MARKER];
     }
-    return ( cur_char );
+    return lline_buffer;
 }
 
 /**************/
 
 
+/****f* Headers/RB_Match_Remark_Marker
+ * FUNCTION
+ *   Check if a line starts with a remark marker, and skip past it.
+ *   This is the same as calling RB_Has_Remark_Marker() and then
+ *   RB_Skip_Remark_Marker(), but with a single pass over the line.
+ * SYNOPSIS
+ */
+char               *RB_Match_Remark_Marker(
+    char *lline_buffer )
+/*
+ * INPUTS
+ *   o lline_buffer -- the line of text.
+ * RESULT
+ *   The text after the remark marker, or NULL if the line does not
+ *   start with one.
+ * SOURCE
+ */
+{
+    struct RB_Marker_Match match;
+
+    Match_Markers( &remark_automaton, lline_buffer, &match );
+    if ( Has_Remark_Marker( &match ) )
+    {
+        assert( match.common[RB_REMARK_MARKER] >= 0 );
+        return match.common_end[RB_REMARK_MARKER];
+    }
+    return NULL;
+}
+
+/*******/
+
+
 /* TODO Documentation */
 void RB_Header_Lock_Reset(
     void )
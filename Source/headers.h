@@ -23,13 +23,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 */
 
+#include <stddef.h>
+
 /****s* RB_header/RB_header_line
  *  FUNCTION
  *    This structure holds the content of one header line and the original
  *    source line number of it.
  *  ATTRIBUTES
  *    * line_number -- The original source file line number for this line
- *    * line        -- The content of the source file line
+ *    * line        -- The content of the source file line.  It points
+ *                     into the source file, so it is only valid while
+ *                     the file is analysed.
  *  SOURCE
  */
 
@@ -54,6 +58,9 @@ struct RB_header_lines
  *    * next          -- used to store RB_headers in a RB_Part as
  *                       a linked list.
  *    * parent        -- the parent of this header
+ *    * first_child   -- the first of the childern of this header,
+ *                       see RB_Document_Link_Children().
+ *    * next_sibling  -- the next header with the same parent.
  *    * name          -- the full name of the header
  *                       modulename/functionname [versioninfo]
  *    * owner         -- the Part that owns this header.
@@ -67,10 +74,16 @@ struct RB_header_lines
  *    * module_name   -- the modulename
  *    * unique_name   -- unique name used for labels.
  *    * file_name     -- documentation file of this header.
- *    * lines         -- content of the header with line numbers
+ *    * lines         -- content of the header with line numbers, only
+ *                       while the source file is analysed.  The items
+ *                       are made from it.
  *    * no_lines      -- number of lines in the content.
  *    * line_number   -- the line number at which the header was
  *                       found in the source file.
+ *
+ *    The strings name, names, function_name, module_name and
+ *    file_name are interned, see RB_Intern_String(), so they can be
+ *    compared by their pointers.
  *  SOURCE
  */
 
@@ -78,6 +91,8 @@ struct RB_header
 {
     struct RB_header   *next;
     struct RB_header   *parent;
+    struct RB_header   *first_child;
+    struct RB_header   *next_sibling;
     struct RB_Part     *owner;
     struct RB_HeaderType *htype;
     struct RB_Item     *items;
@@ -198,6 +213,56 @@ struct RB_header
 #define SRC_E_DBC      22
 
 
+/*********/
+
+
+/****d* Headers/RB_MAX_MARKER_NEEDLES
+ * FUNCTION
+ *   The maximum number of different strings the prefilter for
+ *   begin markers looks for, see RB_Compile_Begin_Markers().
+ * SOURCE
+ */
+
+#define RB_MAX_MARKER_NEEDLES 8
+
+/*********/
+
+
+/****s* Headers/RB_Begin_Marker_Search
+ * FUNCTION
+ *   The state of the search for begin markers in one source file,
+ *   see RB_Find_Begin_Marker_Line().
+ * ATTRIBUTES
+ *   o next -- for each string the prefilter looks for, the offset
+ *             of its next occurrence, the size of the file if there
+ *             is none, or -1 if it has not been searched for yet.
+ * SOURCE
+ */
+
+struct RB_Begin_Marker_Search
+{
+    long                next[RB_MAX_MARKER_NEEDLES];
+};
+
+/*********/
+
+/****d* Headers/RB_Marker_Kind
+ * FUNCTION
+ *   The kinds of markers that RB_Compile_Markers() compiles, see
+ *   RB_Match_Header_Marker().
+ * SOURCE
+ */
+
+enum RB_Marker_Kind
+{
+    RB_BEGIN_MARKER = 0,
+    RB_END_MARKER,
+    RB_REMARK_MARKER,
+    RB_REMARK_BEGIN_MARKER,
+    RB_REMARK_END_MARKER,
+    RB_NO_MARKER_KIND
+};
+
 /*********/
 
 extern char        *robo_header;        /* Added by DavidCD */
@@ -214,6 +279,22 @@ int                 RB_Is_Begin_Marker(
     char **type );
 int                 RB_Is_End_Marker(
     char *cur_line );
+enum RB_Marker_Kind RB_Match_Header_Marker(
+    char *cur_line,
+    char **type );
+void                RB_Compile_Markers(
+    void );
+void                RB_Free_Markers(
+    void );
+void                RB_Compile_Begin_Markers(
+    void );
+void                RB_Start_Begin_Marker_Search(
+    struct RB_Begin_Marker_Search *search );
+size_t              RB_Find_Begin_Marker_Line(
+    struct RB_Begin_Marker_Search *search,
+    char *data,
+    size_t size,
+    size_t position );
 void                RB_Header_Lock_Reset(
     void );
 void                RB_Item_Lock_Reset(
@@ -222,14 +303,12 @@ char               *RB_Skip_Remark_Marker(
     char *lline_buffer );
 int                 RB_Has_Remark_Marker(
     char *lline_buffer );
+char               *RB_Match_Remark_Marker(
+    char *lline_buffer );
 
-int                 RB_Is_Remark_End_Marker(
-    char *cur_line );
-int                 RB_Is_Remark_Begin_Marker(
-    char *cur_line );
-char               *RB_Skip_Remark_Begin_Marker(
+char               *RB_Match_Remark_End_Marker(
     char *cur_line );
-char               *RB_Skip_Remark_End_Marker(
+char               *RB_Match_Remark_Begin_Marker(
     char *cur_line );
 
 #endif /* ROBODOC_HEADERS_H */
@@ -65,11 +65,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 static char        *css_name = NULL;
 static char        *js_name = NULL;
-static int          in_linecomment = 0; /* are we in a line comment? */
 
 static void         RB_HTML_Generate_String(
     FILE *dest_doc,
     const char *a_string );
+static void         RB_HTML_Generate_Chars(
+    FILE *dest_doc,
+    const char *a_string,
+    size_t length );
 
 
 
@@ -210,15 +213,34 @@ static void RB_HTML_Generate_String(
  * SOURCE
  */
 {
-    int                 i;
-    int                 l = strlen( a_string );
-    unsigned char       c;
+    RB_HTML_Generate_Chars( dest_doc, a_string, strlen( a_string ) );
+}
 
-    for ( i = 0; i < l; ++i )
-    {
-        c = a_string[i];
-        RB_HTML_Generate_Char( dest_doc, c );
-    }
+/*******/
+
+
+/****if* HTML_Generator/RB_HTML_Generate_Chars
+ * FUNCTION
+ *   Write a number of characters to the destination document,
+ *   escaping characters where necessary.
+ * SYNOPSIS
+ */
+static void RB_HTML_Generate_Chars(
+    FILE *dest_doc,
+    const char *a_string,
+    size_t length )
+/*
+ * INPUTS
+ *   o dest_doc -- the file the characters are written too
+ *   o a_string -- the characters, they do not have to be
+ *                 terminated with a '\0'.
+ *   o length   -- the number of characters.
+ * SEE ALSO
+ *   RB_HTML_Generate_Char()
+ * SOURCE
+ */
+{
+    RB_Generate_Chars( dest_doc, a_string, length );
 }
 
 /*******/
@@ -298,6 +320,261 @@ static void RB_HTML_Color_String(
 /*******/
 
 
+/****d* HTML_Generator/HTML_Source_States
+ * FUNCTION
+ *   The states of the highlighting of SOURCE items.  Comments and
+ *   quoted strings can not be nested, so there is only one state at
+ *   the time.
+ * SOURCE
+ */
+
+enum HTML_Source_State
+{
+    HSS_CODE,                   /* plain source code */
+    HSS_QUOTE,                  /* in a "string" */
+    HSS_SQUOTE,                 /* in a 'string' */
+    HSS_BLOCK_COMMENT,          /* in a remark begin ... remark end block */
+    HSS_LINE_COMMENT            /* in a line comment */
+};
+
+/*****/
+
+
+/****d* HTML_Generator/HTML_Source_Char_Classes
+ * FUNCTION
+ *   Flags for the classes of the characters that can start something
+ *   that is highlighted in a SOURCE item, see html_source_class.
+ * SOURCE
+ */
+
+#define HSC_WORD     ( 1 << 0 ) /* alpha numeric, '_', or '-' with --cobol */
+#define HSC_SIGN     ( 1 << 1 ) /* colored with --syntaxcolors non_alpha */
+#define HSC_KEYWORD  ( 1 << 2 ) /* can start a keyword */
+#define HSC_URL      ( 1 << 3 ) /* can start a http:, file:, etc. link */
+
+/*****/
+
+
+/****s* HTML_Generator/HTML_Marker_Table
+ * FUNCTION
+ *   A list of markers, such as the remark begin markers, compiled
+ *   for a lookup on the first character.  The markers that can match
+ *   text starting with the character c are
+ *     pool[ start[c] ] ... pool[ start[c + 1] - 1 ]
+ *   in the order of the configuration, so the first match is the
+ *   same as the one Find_Parameter_Partial() finds.
+ * ATTRIBUTES
+ *   o pool   -- the markers, with their length.
+ *   o start  -- for each character the first marker in the pool.
+ * SOURCE
+ */
+
+struct HTML_Marker
+{
+    char               *name;
+    size_t              length;
+};
+
+struct HTML_Marker_Table
+{
+    struct HTML_Marker *pool;
+    unsigned int        start[257];
+};
+
+/*****/
+
+
+/****v* HTML_Generator/html_source_lexer
+ * FUNCTION
+ *   The compiled markers and character classes used to highlight
+ *   SOURCE items, and the current state of the highlighting.
+ *   Set up by RB_HTML_Init_Source_Lexer().  Each thread that
+ *   generates documentation has its own state.
+ * SOURCE
+ */
+
+static ROBO_THREAD_LOCAL enum HTML_Source_State source_state = HSS_CODE;
+static unsigned char html_source_class[256];
+static struct HTML_Marker_Table line_comment_table;
+static struct HTML_Marker_Table block_begin_table;
+static struct HTML_Marker_Table block_end_table;
+
+/*****/
+
+
+/****if* HTML_Generator/HTML_Compile_Markers
+ * FUNCTION
+ *   Compile a list of markers into a HTML_Marker_Table.
+ * SYNOPSIS
+ */
+static void HTML_Compile_Markers(
+    struct HTML_Marker_Table *table,
+    struct Parameters *markers )
+/*
+ * INPUTS
+ *   o table   -- the table to fill.
+ *   o markers -- the list of markers.
+ * NOTES
+ *   An empty marker matches any text, so it is a candidate for
+ *   every character.
+ * SOURCE
+ */
+{
+    unsigned int        c;
+    unsigned int        i;
+    unsigned int        n = 0;
+
+    free( table->pool );
+    for ( i = 0; i < markers->number; ++i )
+    {
+        n += ( markers->names[i][0] == '\0' ) ? 256 : 1;
+    }
+    table->pool = malloc( ( n + 1 ) * sizeof( struct HTML_Marker ) );
+    if ( !table->pool )
+    {
+        RB_Panic( "Out of memory! %s()\n", "HTML_Compile_Markers" );
+    }
+
+    for ( c = 0, n = 0; c < 256; ++c )
+    {
+        table->start[c] = n;
+        for ( i = 0; i < markers->number; ++i )
+        {
+            char               *name = markers->names[i];
+
+            if ( ( ( unsigned char ) name[0] == c ) || ( name[0] == '\0' ) )
+            {
+                table->pool[n].name = name;
+                table->pool[n].length = strlen( name );
+                ++n;
+            }
+        }
+    }
+    table->start[256] = n;
+}
+
+/*******/
+
+
+/****if* HTML_Generator/HTML_Find_Marker
+ * FUNCTION
+ *   Find the first marker in a table that matches the start
+ *   of a text.
+ * SYNOPSIS
+ */
+static struct HTML_Marker *HTML_Find_Marker(
+    struct HTML_Marker_Table *table,
+    const char *text )
+/*
+ * RESULT
+ *   The marker, or NULL if there is none.
+ * SOURCE
+ */
+{
+    unsigned char       c = *text;
+    struct HTML_Marker *marker = table->pool + table->start[c];
+    struct HTML_Marker *last = table->pool + table->start[c + 1];
+
+    for ( ; marker < last; ++marker )
+    {
+        if ( strncmp( marker->name, text, marker->length ) == 0 )
+        {
+            return marker;
+        }
+    }
+    return NULL;
+}
+
+/*******/
+
+
+/****f* HTML_Generator/RB_HTML_Init_Source_Lexer
+ * FUNCTION
+ *   Compile the markers, keywords, and options that are used to
+ *   highlight SOURCE items into the tables used by
+ *   RB_HTML_Generate_Extra().
+ *   This must be called after all the options and the configuration
+ *   have been read, and before any documentation is generated.
+ * SYNOPSIS
+ */
+void RB_HTML_Init_Source_Lexer(
+    void )
+/*
+ * SOURCE
+ */
+{
+    unsigned char       keyword_start[256];
+    unsigned int        c;
+    unsigned int        i;
+
+    HTML_Compile_Markers( &line_comment_table,
+                          &( configuration.source_line_comments ) );
+    HTML_Compile_Markers( &block_begin_table,
+                          &( configuration.remark_begin_markers ) );
+    HTML_Compile_Markers( &block_end_table,
+                          &( configuration.remark_end_markers ) );
+
+    memset( keyword_start, 0, sizeof( keyword_start ) );
+    for ( i = 0; i < configuration.keywords.number; ++i )
+    {
+        keyword_start[( unsigned char ) configuration.keywords.names[i][0]] = 1;
+    }
+
+    for ( c = 0; c < 256; ++c )
+    {
+        /* Use the same conversions as the checks in
+         * RB_HTML_Generate_Extra() did on a char */
+        char                ch = ( char ) c;
+        unsigned char       class = 0;
+        unsigned char       folded = ch;
+
+        if ( utf8_isalnum( ch ) || ( ch == '_' ) ||
+             ( course_of_action.do_hyphens && ch == '-' ) )
+        {
+            class |= HSC_WORD;
+        }
+        else if ( ch != ' ' )
+        {
+            class |= HSC_SIGN;
+        }
+        if ( course_of_action.do_keywords_case_insensitive )
+        {
+            folded = ( unsigned char ) tolower( ch );
+        }
+        if ( keyword_start[folded] && ( ch != '\0' ) )
+        {
+            class |= HSC_KEYWORD;
+        }
+        if ( strchr( "hfmi", ch ) && ( ch != '\0' ) )
+        {
+            class |= HSC_URL;
+        }
+        html_source_class[c] = class;
+    }
+    source_state = HSS_CODE;
+}
+
+/*******/
+
+
+/****f* HTML_Generator/RB_HTML_Reset_Source_State
+ * FUNCTION
+ *   Forget about any comment or string that was left open by the
+ *   SOURCE items of a previous documentation file.
+ * SYNOPSIS
+ */
+void RB_HTML_Reset_Source_State(
+    void )
+/*
+ * SOURCE
+ */
+{
+    source_state = HSS_CODE;
+}
+
+/*******/
+
+
 /****f* HTML_Generator/RB_HTML_Generate_Line_Comment_End
  * FUNCTION
  *   Check if a line comment is active and generate ending sequence for it.
@@ -308,12 +585,95 @@ void RB_HTML_Generate_Line_Comment_End(
     FILE *dest_doc )
 {
     /*  Check if we are in a line comment */
-    if ( in_linecomment )
+    if ( source_state == HSS_LINE_COMMENT )
     {
         /*  and end the line comment */
-        in_linecomment = 0;
-        RB_HTML_Color_String( dest_doc, in_linecomment, COMMENT_CLASS, "" );
+        source_state = HSS_CODE;
+        RB_HTML_Color_String( dest_doc, 0, COMMENT_CLASS, "" );
+    }
+}
+
+/*******/
+
+
+/****if* HTML_Generator/HTML_Toggle_Quote
+ * FUNCTION
+ *   Check if a quote character starts or ends a quoted string.
+ * SYNOPSIS
+ */
+static int HTML_Toggle_Quote(
+    FILE *dest_doc,
+    char *cur_char,
+    char prev_char,
+    enum HTML_Source_State in_quote,
+    const char *class )
+/*
+ * INPUTS
+ *   o dest_doc  -- the file to write to.
+ *   o cur_char  -- the quote character in the item's body.
+ *   o prev_char -- the character just before cur char (zero if none)
+ *   o in_quote  -- the state inside this kind of quoted string.
+ *   o class     -- the class for this kind of quoted string.
+ * RESULT
+ *   TRUE if the quote was written.
+ * SOURCE
+ */
+{
+    char                quote[2];
+
+    /* A quote that is escaped does not end the string, unless it is
+     * the backslash itself that is escaped. ( case "... \\" ) */
+    if ( ( prev_char != '\\' ) ||
+         ( ( source_state == in_quote ) &&
+           ( *( ( char * ) ( cur_char - 2 ) ) == '\\' ) ) )
+    {
+        source_state = ( source_state == in_quote ) ? HSS_CODE : in_quote;
+        quote[0] = *cur_char;
+        quote[1] = '\0';
+        RB_HTML_Color_String( dest_doc, source_state == in_quote,
+                              class, quote );
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/*******/
+
+
+/****f* HTML_Generator/RB_HTML_Extra_Quiet_Length
+ * FUNCTION
+ *   Count the characters at the start of a text for which
+ *   RB_HTML_Generate_Extra() would not do anything.
+ *   For a SOURCE item this is always zero, as every character
+ *   can change the state of the syntax highlighting.
+ * SYNOPSIS
+ */
+size_t RB_HTML_Extra_Quiet_Length(
+    enum ItemType item_type,
+    const char *text )
+/*
+ * INPUTS
+ *   o item_type -- the kind of item the text belongs to.
+ *   o text      -- the text, terminated with a '\0'.
+ * RESULT
+ *   The number of characters that can be skipped.
+ * SOURCE
+ */
+{
+    size_t              i;
+
+    if ( Works_Like_SourceItem( item_type ) )
+    {
+        return 0;
+    }
+    source_state = HSS_CODE;
+    for ( i = 0;
+          text[i] && !( html_source_class[( unsigned char ) text[i]] &
+                        HSC_URL ); ++i )
+    {
+        /* empty */
     }
+    return i;
 }
 
 /*******/
@@ -324,6 +684,11 @@ void RB_HTML_Generate_Line_Comment_End(
  *   Do some additional processing to detect HTML extra's like
  *   file references and other kind of links for the documentation
  *   body of an item.
+ *
+ *   For SOURCE items this also does the syntax highlighting.  The
+ *   state of the highlighting is kept in source_state, and the class
+ *   of the current character (html_source_class) is used to quickly
+ *   skip all the checks that can not match.
  * SYNOPSIS
  */
 int RB_HTML_Generate_Extra(
@@ -342,150 +707,85 @@ int RB_HTML_Generate_Extra(
  * SOURCE
  */
 {
-    char                link[1024], *str;
+    char                link[1024];
     int                 res = -1;
     unsigned int        i;
-    static int          incomment = 0;  /* are we in comment? */
-    static int          quote = 0;      /* double quote */
-    static int          squote = 0;     /* single quote */
+    unsigned char       class = html_source_class[( unsigned char ) *cur_char];
+    struct HTML_Marker *marker;
 
     /*  Reset comment and quote state machine if not source item */
     if ( !Works_Like_SourceItem( item_type ) )
     {
-        quote = 0;
-        squote = 0;
-        incomment = 0;
-        in_linecomment = 0;
+        source_state = HSS_CODE;
     }
-    /*  else check for quotations and string literals */
-    else if ( !( incomment || in_linecomment ) )
+    else
     {
-        switch ( *cur_char )
+        switch ( source_state )
         {
+        case HSS_CODE:
+        case HSS_QUOTE:
+        case HSS_SQUOTE:
             /*  Check for quoted string literals ("string") */
-        case '\"':
-            if ( !squote && course_of_action.do_quotes )
+            if ( ( *cur_char == '\"' ) && ( source_state != HSS_SQUOTE ) &&
+                 course_of_action.do_quotes &&
+                 HTML_Toggle_Quote( dest_doc, cur_char, prev_char,
+                                    HSS_QUOTE, QUOTE_CLASS ) )
             {
-                if ( prev_char != '\\' )
-                {
-                    quote = !quote;
-                    RB_HTML_Color_String( dest_doc, quote,
-                                          QUOTE_CLASS, "\"" );
-                    return 0;
-                }
-                else if ( quote && *( ( char * ) ( cur_char - 2 ) ) == '\\' )
-                {
-                    quote = !quote;     /* case "... \\" */
-                    RB_HTML_Color_String( dest_doc, quote,
-                                          QUOTE_CLASS, "\"" );
-                    return 0;
-                }
+                return 0;
             }
-            break;
-
             /*  Check for single quoted string literals ('string') */
-        case '\'':
-            if ( !quote && course_of_action.do_squotes )
+            if ( ( *cur_char == '\'' ) && ( source_state != HSS_QUOTE ) &&
+                 course_of_action.do_squotes &&
+                 HTML_Toggle_Quote( dest_doc, cur_char, prev_char,
+                                    HSS_SQUOTE, SQUOTE_CLASS ) )
             {
-                if ( prev_char != '\\' )
-                {
-                    squote = !squote;
-                    RB_HTML_Color_String( dest_doc, squote,
-                                          SQUOTE_CLASS, "\'" );
-                    return 0;
-                }
-                else if ( squote && *( ( char * ) ( cur_char - 2 ) ) == '\\' )
-                {
-                    squote = !squote;   /* case '\\' */
-                    RB_HTML_Color_String( dest_doc, squote,
-                                          SQUOTE_CLASS, "\'" );
-                    return 0;
-                }
+                return 0;
             }
-            break;
-
-        default:
-            break;
-        }
-    }
-
-    /*  Recognise line comments */
-    if ( Works_Like_SourceItem( item_type ) && !incomment && !quote
-         && !squote && course_of_action.do_line_comments )
-    {
-        /*  check for line comment start */
-        if ( !in_linecomment )
-        {
-            str =
-                Find_Parameter_Partial( &
-                                        ( configuration.
-                                          source_line_comments ), cur_char );
-            if ( str )
+            if ( source_state != HSS_CODE )
             {
-                in_linecomment = 1;
-                RB_HTML_Color_String( dest_doc, in_linecomment,
-                                      COMMENT_CLASS, str );
-                /*   We found it, so exit */
-                return strlen( str ) - 1;
+                /*  Nothing else is highlighted in a string */
+                return -1;
             }
-        }
-        /*  The end of line comments are generated in */
-        /*  RB_HTML_Generate_Line_Comment_End() */
-    }
 
-    /*  Recognise block comments */
-    if ( Works_Like_SourceItem( item_type ) && !in_linecomment && !quote
-         && !squote && course_of_action.do_block_comments )
-    {
-        /*  Check for block comment start */
-        if ( !incomment )
-        {
-            str =
-                Find_Parameter_Partial( &
-                                        ( configuration.
-                                          remark_begin_markers ), cur_char );
-            if ( str )
+            /*  Check for line comment start */
+            if ( course_of_action.do_line_comments &&
+                 ( marker = HTML_Find_Marker( &line_comment_table,
+                                              cur_char ) ) )
             {
-                incomment = 1;
-                RB_HTML_Color_String( dest_doc, incomment,
-                                      COMMENT_CLASS, str );
+                source_state = HSS_LINE_COMMENT;
+                RB_HTML_Color_String( dest_doc, 1, COMMENT_CLASS,
+                                      marker->name );
                 /*   We found it, so exit */
-                return strlen( str ) - 1;
+                return marker->length - 1;
             }
-        }
-        /*  Check for block comment end */
-        else
-        {
-            str =
-                Find_Parameter_Partial( &( configuration.remark_end_markers ),
-                                        cur_char );
-            if ( str )
+            /*  The end of line comments are generated in */
+            /*  RB_HTML_Generate_Line_Comment_End() */
+
+            /*  Check for block comment start */
+            if ( course_of_action.do_block_comments &&
+                 ( marker = HTML_Find_Marker( &block_begin_table,
+                                              cur_char ) ) )
             {
-                incomment = 0;
-                RB_HTML_Color_String( dest_doc, incomment,
-                                      COMMENT_CLASS, str );
+                source_state = HSS_BLOCK_COMMENT;
+                RB_HTML_Color_String( dest_doc, 1, COMMENT_CLASS,
+                                      marker->name );
                 /*   We found it, so exit */
-                return strlen( str ) - 1;
+                return marker->length - 1;
             }
-        }
-    }
 
-    /*  Do further source formating */
-    if ( Works_Like_SourceItem( item_type ) &&
-         !in_linecomment && !incomment && !quote && !squote )
-    {
-        /*  Check for keywords */
-        if ( configuration.keywords.number && course_of_action.do_keywords )
-        {
-            char               *keyword;
-
-            /*  Check if we are at the beginning of a word */
-            if ( !utf8_isalnum( prev_char ) && ( prev_char != '_' ) && ( !course_of_action.do_hyphens || ( course_of_action.do_hyphens && prev_char != '-' ) ) )
+            /*  Check for keywords, at the beginning of a word */
+            if ( ( class & HSC_KEYWORD ) &&
+                 configuration.keywords.number &&
+                 course_of_action.do_keywords &&
+                 !( html_source_class[( unsigned char ) prev_char] &
+                    HSC_WORD ) )
             {
+                const char         *keyword;
+
                 /*  Count word length */
                 for ( i = 1;    /*  A word should have at least one character... */
-                      utf8_isalnum( cur_char[i] ) || ( cur_char[i] == '_' ) || ( course_of_action.do_hyphens && cur_char[i] == '-' );
-                      i++ );
+                      html_source_class[( unsigned char ) cur_char[i]] &
+                      HSC_WORD; i++ );
                 /*  Check if it is a keyword */
                 if ( course_of_action.do_keywords_case_insensitive ){
                     keyword = Find_Keyword_Case_Insensitive( cur_char, i );
@@ -494,77 +794,95 @@ int RB_HTML_Generate_Extra(
                     keyword = Find_Keyword_Case_Sensitive( cur_char, i );
                 }
                 if ( keyword ){
-                    RB_HTML_Color_String( dest_doc, 2, KEYWORD_CLASS,
-                                          keyword );
-                    free(keyword);
+                    /*  Write the word as it is in the source */
+                    fprintf( dest_doc, "<span class=\"%s\">", KEYWORD_CLASS );
+                    RB_HTML_Generate_Chars( dest_doc, cur_char, i );
+                    fprintf( dest_doc, "</span>" );
                     /*  Exit function */
                     return i - 1;
                 }
             }
-        }
-
-        /*  Do some fancy coloration for non-alphanumeric chars */
-        if ( !utf8_isalnum( *cur_char ) && *cur_char != '_' && ( !course_of_action.do_hyphens || ( course_of_action.do_hyphens && *cur_char != '-' ) )
-             && *cur_char != ' ' && course_of_action.do_non_alpha )
-        {
-            RB_HTML_Color_String( dest_doc, 3, SIGN_CLASS, cur_char );
-            return 0;
-        }
-    }
 
-    /*  Check for links, etc... */
-    if ( incomment || in_linecomment || !Works_Like_SourceItem( item_type ) )
-    {
-        if ( strncmp( "http://", cur_char, 7 ) == 0
-	     || strncmp( "https://", cur_char, 8 ) == 0)
-        {
-            sscanf( cur_char, "%s", link );
-            RB_Say( "found link %s\n", SAY_DEBUG, link );
-            res = ( strlen( link ) - 1 );
-            /* [ 697247 ] http://body. does not skip the '.' */
-            if ( link[( strlen( link ) - 1 )] == '.' )
+            /*  Do some fancy coloration for non-alphanumeric chars */
+            if ( ( class & HSC_SIGN ) && course_of_action.do_non_alpha )
             {
-                link[( strlen( link ) - 1 )] = '\0';
-                fprintf( dest_doc, "<a href=\"%s\">%s</a>.", link, link );
+                RB_HTML_Color_String( dest_doc, 3, SIGN_CLASS, cur_char );
+                return 0;
             }
-            else
+            return -1;
+
+        case HSS_BLOCK_COMMENT:
+            /*  Check for block comment end */
+            if ( course_of_action.do_block_comments &&
+                 ( marker = HTML_Find_Marker( &block_end_table,
+                                              cur_char ) ) )
             {
-                fprintf( dest_doc, "<a href=\"%s\">%s</a>", link, link );
+                source_state = HSS_CODE;
+                RB_HTML_Color_String( dest_doc, 0, COMMENT_CLASS,
+                                      marker->name );
+                /*   We found it, so exit */
+                return marker->length - 1;
             }
+            break;
+
+        case HSS_LINE_COMMENT:
+            break;
         }
-        else if ( strncmp( "href:", cur_char, 5 ) == 0 )
+    }
+
+    /*  Check for links, etc... in comments and documentation */
+    if ( !( class & HSC_URL ) )
+    {
+        return -1;
+    }
+    if ( strncmp( "http://", cur_char, 7 ) == 0
+         || strncmp( "https://", cur_char, 8 ) == 0)
+    {
+        sscanf( cur_char, "%s", link );
+        RB_Say( "found link %s\n", SAY_DEBUG, link );
+        res = ( strlen( link ) - 1 );
+        /* [ 697247 ] http://body. does not skip the '.' */
+        if ( link[( strlen( link ) - 1 )] == '.' )
         {
-            /*
-             * handy in relative hyperlink paths, e.g.
-             * href:../../modulex/
-             */
-            sscanf( ( cur_char + 5 ), "%s", link );
-            RB_Say( "found link %s\n", SAY_DEBUG, link );
-            res = ( strlen( link ) + 4 );
-            fprintf( dest_doc, "<a href=\"%s\">%s</a>", link, link );
+            link[( strlen( link ) - 1 )] = '\0';
+            fprintf( dest_doc, "<a href=\"%s\">%s</a>.", link, link );
         }
-        else if ( strncmp( "file:/", cur_char, strlen( "file:/" ) ) == 0 )
+        else
         {
-            sscanf( cur_char, "%s", link );
-            RB_Say( "found link %s\n", SAY_DEBUG, link );
-            res = ( strlen( link ) - 1 );
             fprintf( dest_doc, "<a href=\"%s\">%s</a>", link, link );
         }
-        else if ( strncmp( "mailto:", cur_char, 7 ) == 0 )
-        {
-            sscanf( ( cur_char + 7 ), "%s", link );
-            RB_Say( "found mail to %s\n", SAY_DEBUG, link );
-            res = ( strlen( link ) + 6 );
-            fprintf( dest_doc, "<a href=\"mailto:%s\">%s</a>", link, link );
-        }
-        else if ( strncmp( "image:", cur_char, 6 ) == 0 )
-        {
-            sscanf( ( cur_char + 6 ), "%s", link );
-            RB_Say( "found image %s\n", SAY_DEBUG, link );
-            res = ( strlen( link ) + 5 );
-            fprintf( dest_doc, "<img src=\"%s\">", link );
-        }
-
+    }
+    else if ( strncmp( "href:", cur_char, 5 ) == 0 )
+    {
+        /*
+         * handy in relative hyperlink paths, e.g.
+         * href:../../modulex/
+         */
+        sscanf( ( cur_char + 5 ), "%s", link );
+        RB_Say( "found link %s\n", SAY_DEBUG, link );
+        res = ( strlen( link ) + 4 );
+        fprintf( dest_doc, "<a href=\"%s\">%s</a>", link, link );
+    }
+    else if ( strncmp( "file:/", cur_char, strlen( "file:/" ) ) == 0 )
+    {
+        sscanf( cur_char, "%s", link );
+        RB_Say( "found link %s\n", SAY_DEBUG, link );
+        res = ( strlen( link ) - 1 );
+        fprintf( dest_doc, "<a href=\"%s\">%s</a>", link, link );
+    }
+    else if ( strncmp( "mailto:", cur_char, 7 ) == 0 )
+    {
+        sscanf( ( cur_char + 7 ), "%s", link );
+        RB_Say( "found mail to %s\n", SAY_DEBUG, link );
+        res = ( strlen( link ) + 6 );
+        fprintf( dest_doc, "<a href=\"mailto:%s\">%s</a>", link, link );
+    }
+    else if ( strncmp( "image:", cur_char, 6 ) == 0 )
+    {
+        sscanf( ( cur_char + 6 ), "%s", link );
+        RB_Say( "found image %s\n", SAY_DEBUG, link );
+        res = ( strlen( link ) + 5 );
+        fprintf( dest_doc, "<img src=\"%s\">", link );
     }
     return res;
 }
@@ -601,51 +919,47 @@ void RB_HTML_Generate_Item_End(
 }
 
 
-int                 sectiontoc_counters[MAX_SECTION_DEPTH];
+ROBO_THREAD_LOCAL int sectiontoc_counters[MAX_SECTION_DEPTH + 1];
 
-/****f* HTML_Generator/RB_HTML_Generate_TOC_Section
+/****if* HTML_Generator/RB_HTML_Generate_TOC_Entry
  * FUNCTION
- *   Create a table of contents based on the hierarchy of
- *   the headers starting for a particular point in this
- *   hierarchy (the parent).
+ *   Create the entry of a single header in the table of contents
+ *   and update the section counters.
  * SYNOPSIS
  */
-void RB_HTML_Generate_TOC_Section(
+static void RB_HTML_Generate_TOC_Entry(
     FILE *dest_doc,
     char *dest_name,
-    struct RB_header *parent,
-    struct RB_header **headers,
-    int count,
+    struct RB_header *header,
     int depth )
 /*
  * INPUTS
  *   o dest_doc  -- the file to write to.
  *   o dest_name -- the name of this file.
- *   o parent    -- the parent of the headers for which the the
- *                  current level(depth) of TOC is created.
- *   o headers   -- an array of headers for which the TOC is created
- *   o count     -- the number of headers in this array
+ *   o header    -- the header the entry is created for.
  *   o depth     -- the current depth of the TOC
- * NOTES
- *   This is a recursive function and tricky stuff.
  * SOURCE
  */
 {
-    struct RB_header   *header;
-    int                 i, n, once = 0;
-
-    ++sectiontoc_counters[depth];
+    int                 i, n;
 
-    for ( i = depth + 1; i < MAX_SECTION_DEPTH; ++i )
+    /* The hierarchy can be deeper than there are counters, the
+     * entries below the deepest counter are not numbered. */
+    if ( depth <= MAX_SECTION_DEPTH )
     {
-        sectiontoc_counters[i] = 0;
+        ++sectiontoc_counters[depth];
+        for ( i = depth + 1; i <= MAX_SECTION_DEPTH; ++i )
+        {
+            sectiontoc_counters[i] = 0;
+        }
     }
 
     /*  List item start */
     fprintf( dest_doc, "<li>" );
 
     /*  Do not generate section numbers if sectionnameonly */
-    if ( !( course_of_action.do_sectionnameonly ) )
+    if ( !( course_of_action.do_sectionnameonly ) &&
+         ( depth <= MAX_SECTION_DEPTH ) )
     {
         for ( i = 1; i <= depth; ++i )
         {
@@ -656,46 +970,83 @@ void RB_HTML_Generate_TOC_Section(
 
 
     /*  Generate Link to first reference name */
-    RB_HTML_Generate_Link( dest_doc, dest_name, parent->file_name,
-                           parent->unique_name,
+    RB_HTML_Generate_Link( dest_doc, dest_name, header->file_name,
+                           header->unique_name,
                            /*  only generate function name if sectionnameonly */
                            ( course_of_action.do_sectionnameonly ) ?
-                           parent->function_name : parent->name, 0 );
+                           header->function_name : header->name, 0 );
 
     /*  Generate links to further reference names */
-    for ( n = 1; n < parent->no_names; n++ )
+    for ( n = 1; n < header->no_names; n++ )
     {
         RB_HTML_Generate_String( dest_doc, ", " );
-        RB_HTML_Generate_Link( dest_doc, dest_name, parent->file_name,
-                               parent->unique_name, parent->names[n], 0 );
+        RB_HTML_Generate_Link( dest_doc, dest_name, header->file_name,
+                               header->unique_name, header->names[n], 0 );
     }
 
     /*  List item end */
     fprintf( dest_doc, "</li>\n" );
+}
 
-    for ( i = 0; i < count; ++i )
+/*******/
+
+
+/****f* HTML_Generator/RB_HTML_Generate_TOC_Section
+ * FUNCTION
+ *   Create a table of contents based on the hierarchy of
+ *   the headers starting for a particular point in this
+ *   hierarchy (the parent).
+ * SYNOPSIS
+ */
+void RB_HTML_Generate_TOC_Section(
+    FILE *dest_doc,
+    char *dest_name,
+    struct RB_header *parent,
+    int depth )
+/*
+ * INPUTS
+ *   o dest_doc  -- the file to write to.
+ *   o dest_name -- the name of this file.
+ *   o parent    -- the header at the top of the part of the
+ *                  hierarchy for which the TOC is created.
+ *   o depth     -- the depth of parent in the TOC
+ * NOTES
+ *   The subtree is walked depth first using the first_child,
+ *   next_sibling, and parent links of the headers.
+ *   Each level of childern is put in its own <ul>.
+ * SOURCE
+ */
+{
+    struct RB_header   *header = parent;
+
+    for ( ;; )
     {
-        header = headers[i];
-        if ( header->parent == parent )
+        RB_HTML_Generate_TOC_Entry( dest_doc, dest_name, header, depth );
+        if ( header->first_child )
         {
             /*  Generate better TOC level hiearchy (Thuffir) */
-            /*  We only generate <ul> once for a level */
-            if ( !once )
-            {
-                once = 1;
-                fprintf( dest_doc, "<ul>\n" );
-            }
-            RB_HTML_Generate_TOC_Section( dest_doc, dest_name, header,
-                                          headers, count, depth + 1 );
+            fprintf( dest_doc, "<ul>\n" );
+            header = header->first_child;
+            ++depth;
+            continue;
         }
-        else
+        /* Close levels until we find a header that has a next sibling */
+        for ( ;; )
         {
-            /* Empty */
+            if ( header == parent )
+            {
+                return;
+            }
+            if ( header->next_sibling )
+            {
+                header = header->next_sibling;
+                break;
+            }
+            header = header->parent;
+            --depth;
+            fprintf( dest_doc, "</ul>\n" );
         }
     }
-    /*  If we have generated an <ul> before, generate the closing one too. */
-    if ( once )
-        fprintf( dest_doc, "</ul>\n" );
 }
 
 /*******/
@@ -712,7 +1063,7 @@ void RB_HTML_Generate_TOC_2(
     int                 i, j;
     int                 depth = 1;
 
-    for ( i = 0; i < MAX_SECTION_DEPTH; ++i )
+    for ( i = 0; i <= MAX_SECTION_DEPTH; ++i )
     {
         sectiontoc_counters[i] = 0;
     }
@@ -735,7 +1086,7 @@ void RB_HTML_Generate_TOC_2(
                 else
                 {
                     RB_HTML_Generate_TOC_Section( dest_doc, dest_name, header,
-                                                  headers, count, depth );
+                                                  depth );
                 }
             }
             else
@@ -767,8 +1118,7 @@ void RB_HTML_Generate_TOC_2(
                     if ( no_bad_parent )
                     {
                         RB_HTML_Generate_TOC_Section( dest_doc, dest_name,
-                                                      header, headers, count,
-                                                      depth );
+                                                      header, depth );
                     }
                 }
             }
@@ -852,7 +1202,22 @@ void RB_HTML_Generate_Label(
 
 
 
-static int          section_counters[MAX_SECTION_DEPTH];
+static ROBO_THREAD_LOCAL int section_counters[MAX_SECTION_DEPTH + 1];
+
+
+/****f* HTML_Generator/RB_HTML_Reset_Section_Counters
+ * FUNCTION
+ *   Start numbering the sections from 1 again.
+ * SOURCE
+ */
+
+void RB_HTML_Reset_Section_Counters(
+    void )
+{
+    memset( section_counters, 0, sizeof( section_counters ) );
+}
+
+/*******/
 
 
 /* TODO Documentation */
@@ -864,13 +1229,20 @@ void RB_HTML_Generate_BeginSection(
     struct RB_header *header )
 {
     int                 i;
+    int                 heading;
 
-    ++section_counters[depth];
-    for ( i = depth + 1; i < MAX_SECTION_DEPTH; ++i )
+    /* Sections deeper than there are counters are not numbered,
+     * and use the last heading level. */
+    heading = ( depth < MAX_SECTION_DEPTH ) ? depth : MAX_SECTION_DEPTH;
+    if ( depth <= MAX_SECTION_DEPTH )
     {
-        section_counters[i] = 0;
+        ++section_counters[depth];
+        for ( i = depth + 1; i <= MAX_SECTION_DEPTH; ++i )
+        {
+            section_counters[i] = 0;
+        }
     }
-    switch ( depth )
+    switch ( heading )
     {
     case 1:
     case 2:
@@ -879,9 +1251,10 @@ void RB_HTML_Generate_BeginSection(
     case 5:
     case 6:
     case 7:
-        fprintf( dest_doc, "<h%d>", depth );
+        fprintf( dest_doc, "<h%d>", heading );
         /*  Only generate section numbers if no sectionnameonly */
-        if ( !( course_of_action.do_sectionnameonly ) )
+        if ( !( course_of_action.do_sectionnameonly ) &&
+             ( depth <= MAX_SECTION_DEPTH ) )
         {
             for ( i = 1; i <= depth; ++i )
             {
@@ -908,7 +1281,7 @@ void RB_HTML_Generate_BeginSection(
             fprintf( dest_doc, " ]" );
         }
 
-        fprintf( dest_doc, "  </h%d>\n", depth );
+        fprintf( dest_doc, "  </h%d>\n", heading );
         break;
     default:
         /* too deep, don't do anything. */
@@ -1371,7 +1744,7 @@ void RB_HTML_Generate_Index_Page(
                                          document->extension, header_type );
     assert( filename );
 
-    file = fopen( filename, "w" );
+    file = RB_Open_Output_File( filename );
     if ( !file )
     {
         RB_Panic( "can't open (%s)!\n", filename );
@@ -1413,7 +1786,7 @@ void RB_HTML_Generate_Index_Page(
         }
         HTML_Generate_End_Content( file );
         RB_HTML_Generate_Doc_End( file, filename, document->srcroot->name );
-        fclose( file );
+        RB_Close_Output_File( file );
     }
 
     free( filename );
@@ -1428,7 +1801,7 @@ void HTML_Generate_TOC_Index_Page(
     FILE               *file = NULL;
     char               *toc_index_path = HTML_TOC_Index_Filename( document );
 
-    file = fopen( toc_index_path, "w" );
+    file = RB_Open_Output_File( toc_index_path );
     if ( !file )
     {
         RB_Panic( "can't open (%s)!\n", toc_index_path );
@@ -1458,7 +1831,7 @@ void HTML_Generate_TOC_Index_Page(
         /* End part */
         RB_HTML_Generate_Doc_End( file, toc_index_path,
                                   document->srcroot->name );
-        fclose( file );
+        RB_Close_Output_File( file );
     }
 
     free( toc_index_path );
@@ -1523,42 +1896,37 @@ void RB_HTML_Generate_Table_Body(
     int internal )
 {
     struct RB_link     *cur_link;
+    struct RB_link    **links;
+    unsigned int        count;
     unsigned int        i;
     char                first_char = ' ';
     int                 found = FALSE;
 
-    /* Compute the number of columns we need for
-     * this type of header.
-     */
-    for ( i = 0; i < link_index_size; ++i )
+    /* The links of this type of header */
+    count = RB_Get_Links_Of_Type( type, internal, &links );
+    for ( i = 0; i < count; ++i )
     {
-        cur_link = link_index[i];
-        if ( cur_link->htype &&
-             RB_CompareHeaderTypes( cur_link->htype, type ) &&
-             ( ( cur_link->is_internal && internal ) ||
-               ( !cur_link->is_internal && !internal ) ) )
-        {
-            char               *r = 0;
+        char               *r = 0;
 
-            r = RB_HTML_RelativeAddress( dest_name, cur_link->file_name );
-            if ( toupper( cur_link->object_name[0] ) != first_char )
+        cur_link = links[i];
+        r = RB_HTML_RelativeAddress( dest_name, cur_link->file_name );
+        if ( toupper( cur_link->object_name[0] ) != first_char )
+        {
+            first_char = toupper( cur_link->object_name[0] );
+            if ( found )
             {
-                first_char = toupper( cur_link->object_name[0] );
-                if ( found )
-                {
-/*                     fprintf( dest, "</div>\n" ); */
-                }
-                fprintf( dest, "<h2><a name=\"%c\"></a>", first_char );
-                RB_HTML_Generate_Char( dest, first_char );
-                fprintf( dest, "</h2>" );
-/*               fprintf( dest, "<div class=\"indexitem\">\n" ); */
-                found = TRUE;
+/*                 fprintf( dest, "</div>\n" ); */
             }
-            fprintf( dest, "<a href=\"%s#%s\" class=\"indexitem\" >", r,
-                     cur_link->label_name );
-            RB_HTML_Generate_String( dest, cur_link->object_name );
-            fprintf( dest, "</a>\n" );
+            fprintf( dest, "<h2><a name=\"%c\"></a>", first_char );
+            RB_HTML_Generate_Char( dest, first_char );
+            fprintf( dest, "</h2>" );
+/*           fprintf( dest, "<div class=\"indexitem\">\n" ); */
+            found = TRUE;
         }
+        fprintf( dest, "<a href=\"%s#%s\" class=\"indexitem\" >", r,
+                 cur_link->label_name );
+        RB_HTML_Generate_String( dest, cur_link->object_name );
+        fprintf( dest, "</a>\n" );
     }
     if ( found )
     {
@@ -1789,7 +2157,7 @@ char               *RB_HTML_RelativeAddress(
  */
 #define MAX_RELATIVE_SIZE 1024
 {
-    static char         relative[MAX_RELATIVE_SIZE + 1];
+    static ROBO_THREAD_LOCAL char relative[MAX_RELATIVE_SIZE + 1];
     char               *i_this;
     char               *i_that;
     char               *i_this_slash = NULL;
@@ -1970,6 +2338,9 @@ void RB_Create_CSS(
     size_t              l = 0;
     FILE               *css_file;
 
+    /* The file is created again each time the documentation is
+     * generated. */
+    free( css_name );
     /* compute the complete path to the css file */
     if ( ( document->actions.do_singledoc ) ||
          ( document->actions.do_singlefile ) )
@@ -2364,6 +2735,9 @@ void RB_Create_JS(
     size_t              l = 0;
     FILE               *js_file;
 
+    /* The file is created again each time the documentation is
+     * generated. */
+    free( js_name );
     /* compute the complete path to the js file */
     if ( ( document->actions.do_singledoc ) ||
          ( document->actions.do_singlefile ) )
@@ -44,6 +44,8 @@ void                RB_HTML_Generate_TOC_2(
     int count,
     struct RB_Part *owner,
     char *dest_name );
+void                RB_HTML_Reset_Section_Counters(
+    void );
 void                RB_HTML_Generate_BeginSection(
     FILE *dest_doc,
     int depth,
@@ -100,6 +102,9 @@ char               *RB_HTML_RelativeAddress(
     char *thisname,
     char *thatname );
 
+size_t              RB_HTML_Extra_Quiet_Length(
+    enum ItemType item_type,
+    const char *text );
 int                 RB_HTML_Generate_Extra(
     FILE *dest_doc,
     enum ItemType item_type,
@@ -161,6 +166,10 @@ void                HTML_Generate_Begin_Extra(
     FILE *dest_doc );
 void                HTML_Generate_End_Extra(
     FILE *dest_doc );
+void                RB_HTML_Init_Source_Lexer(
+    void );
+void                RB_HTML_Reset_Source_State(
+    void );
 void                RB_HTML_Generate_Line_Comment_End(
     FILE *dest_doc );
 void                RB_HTML_Generate_IndexMenu(
@@ -0,0 +1,277 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+/****h* ROBODoc/Intern
+ * FUNCTION
+ *   A pool of strings in which each string is stored only once.
+ *   The names of headers, their modules and functions, the names
+ *   of the documentation files and the strings of links are all
+ *   interned, so two of them are equal if and only if their
+ *   pointers are equal, and the many copies of the same name
+ *   share their memory.
+ *
+ *   Interned strings must not be modified.  They stay valid until
+ *   RB_Free_Interned_Strings() is called at the very end, or until
+ *   the pool is renewed with RB_Renew_Interned_Strings().  Strings
+ *   are never removed from the pool one by one, so --watch renews
+ *   it after each update, see Update_Document().
+ *
+ *   The pool is shared by all threads, see RB_Run_Jobs().
+ *****
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "robodoc.h"
+#if !defined( ROBO_NO_THREADS ) && !defined( _WIN32 )
+#include <pthread.h>
+#define ROBO_USE_PTHREADS
+#endif
+
+#include "intern.h"
+#include "arena.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+/****is* Intern/RB_Interned_String
+ * FUNCTION
+ *   An entry of the pool, the characters of the string follow
+ *   the structure.
+ * ATTRIBUTES
+ *   o next   -- the next entry in the same bucket.
+ *   o hash   -- the hash value of the string.
+ *   o length -- the length of the string.
+ *   o text   -- the string.
+ * SOURCE
+ */
+
+struct RB_Interned_String
+{
+    struct RB_Interned_String *next;
+    unsigned long       hash;
+    size_t              length;
+    char                text[1];
+};
+
+/*******/
+
+
+/****iv* Intern/intern_buckets
+ * FUNCTION
+ *   The pool.  All entries are allocated from intern_arena, and
+ *   stored in the hash table intern_buckets, which has
+ *   intern_mask + 1 buckets.  intern_lock protects all of them.
+ * SOURCE
+ */
+
+static struct RB_Arena intern_arena;
+static struct RB_Interned_String **intern_buckets = NULL;
+static unsigned long intern_mask = 0;
+static unsigned long no_interned_strings = 0;
+
+#ifdef ROBO_USE_PTHREADS
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*******/
+
+
+/****if* Intern/Grow_Intern_Pool
+ * FUNCTION
+ *   Make the hash table of the pool twice as large.
+ * SOURCE
+ */
+
+static void Grow_Intern_Pool(
+    void )
+{
+    unsigned long       new_mask = intern_buckets ? 2 * intern_mask + 1 :
+        RB_Hash_Table_Size( 0 ) - 1;
+    struct RB_Interned_String **new_buckets =
+        calloc( new_mask + 1, sizeof( struct RB_Interned_String * ) );
+    unsigned long       i;
+
+    RB_Mem_Check( new_buckets );
+    if ( intern_buckets )
+    {
+        for ( i = 0; i <= intern_mask; ++i )
+        {
+            struct RB_Interned_String *entry;
+            struct RB_Interned_String *next_entry;
+
+            for ( entry = intern_buckets[i]; entry; entry = next_entry )
+            {
+                next_entry = entry->next;
+                entry->next = new_buckets[entry->hash & new_mask];
+                new_buckets[entry->hash & new_mask] = entry;
+            }
+        }
+        free( intern_buckets );
+    }
+    intern_buckets = new_buckets;
+    intern_mask = new_mask;
+}
+
+/*******/
+
+
+/****f* Intern/RB_Intern_StrLen
+ * FUNCTION
+ *   Look up the first length characters of a string in the pool,
+ *   and add them if they are not there yet.
+ * SYNOPSIS
+ */
+char               *RB_Intern_StrLen(
+    char *str,
+    size_t length )
+/*
+ * INPUTS
+ *   o str    -- the string, does not need to be '\0' terminated.
+ *   o length -- the number of characters.
+ * RESULT
+ *   The interned copy of the string.
+ * SOURCE
+ */
+{
+    unsigned long       hash = RB_Hash_String( str, length );
+    struct RB_Interned_String *entry;
+
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_lock( &intern_lock );
+#endif
+    if ( !intern_buckets )
+    {
+        Grow_Intern_Pool(  );
+    }
+    for ( entry = intern_buckets[hash & intern_mask]; entry;
+          entry = entry->next )
+    {
+        if ( ( entry->hash == hash ) && ( entry->length == length ) &&
+             ( memcmp( entry->text, str, length ) == 0 ) )
+        {
+            break;
+        }
+    }
+    if ( !entry )
+    {
+        entry = RB_Arena_Alloc( &intern_arena,
+                                offsetof( struct RB_Interned_String,
+                                          text ) + length + 1 );
+        entry->hash = hash;
+        entry->length = length;
+        memcpy( entry->text, str, length );
+        entry->text[length] = '\0';
+        entry->next = intern_buckets[hash & intern_mask];
+        intern_buckets[hash & intern_mask] = entry;
+        if ( ++no_interned_strings > intern_mask )
+        {
+            Grow_Intern_Pool(  );
+        }
+    }
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_unlock( &intern_lock );
+#endif
+    return entry->text;
+}
+
+/*******/
+
+
+/****f* Intern/RB_Intern_String
+ * FUNCTION
+ *   Look up a string in the pool, and add it if it is not there
+ *   yet.
+ * RESULT
+ *   The interned copy of the string.
+ * SOURCE
+ */
+
+char               *RB_Intern_String(
+    char *str )
+{
+    return RB_Intern_StrLen( str, strlen( str ) );
+}
+
+/*******/
+
+
+/****f* Intern/RB_Renew_Interned_Strings
+ * FUNCTION
+ *   Replace the pool by a new one that only has the strings that
+ *   are still in use.  The old pool is put aside, and a function
+ *   is called that interns again all strings that are still in
+ *   use, and replaces them by their new copies.  The old pool is
+ *   freed afterwards.
+ * SYNOPSIS
+ */
+void RB_Renew_Interned_Strings(
+    void ( *function ) ( void * ),
+    void *data )
+/*
+ * INPUTS
+ *   o function -- the function that interns the strings again.
+ *   o data     -- its argument.
+ * NOTES
+ *   Should not be called while other threads use the pool.
+ * SOURCE
+ */
+{
+    struct RB_Arena     old_arena = intern_arena;
+    struct RB_Interned_String **old_buckets = intern_buckets;
+
+    RB_Init_Arena( &intern_arena );
+    intern_buckets = NULL;
+    intern_mask = 0;
+    no_interned_strings = 0;
+
+    function( data );
+
+    RB_Free_Arena( &old_arena );
+    free( old_buckets );
+}
+
+/*******/
+
+
+/****f* Intern/RB_Free_Interned_Strings
+ * FUNCTION
+ *   Free all interned strings.  None of them can be used after
+ *   this.
+ * SOURCE
+ */
+
+void RB_Free_Interned_Strings(
+    void )
+{
+    RB_Free_Arena( &intern_arena );
+    free( intern_buckets );
+    intern_buckets = NULL;
+    intern_mask = 0;
+    no_interned_strings = 0;
+}
+
+/*******/
@@ -50,6 +50,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "items.h"
 #include "roboconfig.h"
 #include "util.h"
+#include "arena.h"
 
 /****v* Items/item_name_buffer
  * FUNCTION
@@ -58,7 +59,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #define MAX_ITEM_NAME_LENGTH 10240
-char                item_name_buffer[MAX_ITEM_NAME_LENGTH];
+ROBO_THREAD_LOCAL char item_name_buffer[MAX_ITEM_NAME_LENGTH];
 
 /*****/
 
@@ -70,16 +71,18 @@ char               *RB_Get_Item_Name(
 }
 
 /****f* Items/RB_Create_Item
- *
+ * FUNCTION
+ *   Create an item.  It is freed with the arena, together with the
+ *   header it belongs to.
  * SOURCE
  */
 
 struct RB_Item     *RB_Create_Item(
+    struct RB_Arena *arena,
     enum ItemType arg_item_type )
 {
-    struct RB_Item     *item = malloc( sizeof( struct RB_Item ) );
-
-    assert( item );
+    struct RB_Item     *item =
+        RB_Arena_Alloc( arena, sizeof( struct RB_Item ) );
 
     item->next = 0;
     item->type = arg_item_type;
@@ -155,12 +158,17 @@ enum ItemType RB_Is_ItemName(
     int                 i = 0;
 
     cur_char = RB_Skip_Whitespace( cur_char );
-    if ( RB_Has_Remark_Marker( cur_char ) )
+    cur_char = RB_Match_Remark_Marker( cur_char );
+    if ( cur_char )
     {
-        cur_char = RB_Skip_Remark_Marker( cur_char );
         cur_char = RB_Skip_Whitespace( cur_char );
         /* It there anything left? */
-        if ( strlen( cur_char ) )
+        if ( strlen( cur_char ) >= MAX_ITEM_NAME_LENGTH )
+        {
+            /* Far too long to be an item name */
+            return NO_ITEM;
+        }
+        else if ( strlen( cur_char ) )
         {
             enum ItemType       item_type = NO_ITEM;
 
@@ -209,15 +217,40 @@ enum ItemType RB_Is_ItemName(
 
 /******/
 
-/* TODO Documentation */
-int Is_Ignore_Item(
+/****v* Items/item_properties
+ * FUNCTION
+ *   The properties of each item type, a combination of the
+ *   RBIP_ flags.  The index is the item type.
+ *   It is filled by RB_Compute_Item_Properties().
+ * SOURCE
+ */
+
+static unsigned char *item_properties = NULL;
+
+/*****/
+
+
+/****if* Items/Is_In_Item_List
+ * FUNCTION
+ *   Tells wether an item name is one of the names in a list of
+ *   item names from the configuration.
+ * SYNOPSIS
+ */
+static int Is_In_Item_List(
+    struct Parameters *list,
     char *name )
+/*
+ * INPUTS
+ *   o list -- the list of item names
+ *   o name -- the name of the item
+ * SOURCE
+ */
 {
     unsigned int        i;
 
-    for ( i = 0; i < configuration.ignore_items.number; ++i )
+    for ( i = 0; i < list->number; ++i )
     {
-        if ( !strcmp( configuration.ignore_items.names[i], name ) )
+        if ( !strcmp( list->names[i], name ) )
         {
             return TRUE;
         }
@@ -225,6 +258,86 @@ int Is_Ignore_Item(
     return FALSE;
 }
 
+/******/
+
+
+/****f* Items/RB_Compute_Item_Properties
+ * FUNCTION
+ *   Determine the properties of all item types, so that
+ *   Works_Like_SourceItem(), Is_Preformatted_Item(), Is_Format_Item(),
+ *   and Is_Ignore_Item() do not have to search the item lists
+ *   of the configuration each time they are called.
+ *   This must be called after ReadConfiguration().
+ * SYNOPSIS
+ */
+void RB_Compute_Item_Properties(
+    void )
+/*
+ * SOURCE
+ */
+{
+    unsigned int        item_type;
+
+    free( item_properties );
+    item_properties = calloc( configuration.items.number + 1,
+                              sizeof( unsigned char ) );
+    if ( !item_properties )
+    {
+        RB_Panic( "Out of memory! %s()\n", "RB_Compute_Item_Properties" );
+    }
+
+    for ( item_type = 0; item_type < configuration.items.number; ++item_type )
+    {
+        char               *name = configuration.items.names[item_type];
+        unsigned char       properties = 0;
+
+        if ( ( item_type == SOURCECODE_ITEM ) ||
+             Is_In_Item_List( &( configuration.source_items ), name ) )
+        {
+            properties |= RBIP_SOURCE;
+        }
+        if ( Is_In_Item_List( &( configuration.preformatted_items ), name ) )
+        {
+            properties |= RBIP_PREFORMATTED;
+        }
+        if ( Is_In_Item_List( &( configuration.format_items ), name ) )
+        {
+            properties |= RBIP_FORMAT;
+        }
+        if ( Is_In_Item_List( &( configuration.ignore_items ), name ) )
+        {
+            properties |= RBIP_IGNORE;
+        }
+        item_properties[item_type] = properties;
+    }
+}
+
+/******/
+
+
+/****f* Items/Is_Ignore_Item
+ * FUNCTION
+ *   Tells wether the user does not want this item in the
+ *   documentation.
+ * SYNPOPSIS
+ */
+int Is_Ignore_Item(
+    enum ItemType item_type )
+/*
+ * INPUTS
+ *   item_type -- Type of item (also the index to the item name)
+ * RESULT
+ *   TRUE  -- Item should be left out
+ *   FALSE -- Item should be included
+ * SOURCE
+ */
+{
+    assert( item_properties );
+    return ( item_properties[item_type] & RBIP_IGNORE ) != 0;
+}
+
+/******/
+
 
 /****f* HeaderTypes/Works_Like_SourceItem
  * FUNCTION
@@ -244,27 +357,8 @@ int Works_Like_SourceItem(
  * SOURCE
  */
 {
-    unsigned int        i;
-
-    /* Check if it is a SOURCE item */
-    if ( item_type == SOURCECODE_ITEM )
-    {
-        return TRUE;
-    }
-
-    /* Lookup if it works like a SOURCE item */
-    for ( i = 0; i < configuration.source_items.number; ++i )
-    {
-        if ( !strcmp
-             ( configuration.source_items.names[i],
-               configuration.items.names[item_type] ) )
-        {
-            return TRUE;
-        }
-    }
-
-    /* Neither SOURCE item, nor works like it */
-    return FALSE;
+    assert( item_properties );
+    return ( item_properties[item_type] & RBIP_SOURCE ) != 0;
 }
 
 /******/
@@ -286,22 +380,8 @@ int Is_Preformatted_Item(
  * SOURCE
  */
 {
-    unsigned int        i;
-
-    /* Lookup if item should be preformatted */
-    for ( i = 0; i < configuration.preformatted_items.number; ++i )
-    {
-        if ( !strcmp
-             ( configuration.preformatted_items.names[i],
-               configuration.items.names[item_type] ) )
-        {
-            /* Item name match, it sould be preformatted */
-            return TRUE;
-        }
-    }
-
-    /* Do not automatically preformat item */
-    return FALSE;
+    assert( item_properties );
+    return ( item_properties[item_type] & RBIP_PREFORMATTED ) != 0;
 }
 
 /******/
@@ -322,22 +402,8 @@ int Is_Format_Item(
  * SOURCE
  */
 {
-    unsigned int        i;
-
-    /* Lookup if item should be formatted by the browser */
-    for ( i = 0; i < configuration.format_items.number; ++i )
-    {
-        if ( !strcmp
-             ( configuration.format_items.names[i],
-               configuration.items.names[item_type] ) )
-        {
-            /* Item name match, it sould be formatted by the browser */
-            return TRUE;
-        }
-    }
-
-    /* Leave item alone */
-    return FALSE;
+    assert( item_properties );
+    return ( item_properties[item_type] & RBIP_FORMAT ) != 0;
 }
 
 /******/
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "robodoc.h"
+#include "arena.h"
 
 /****t* Items/ItemTypes 
  * NAME 
@@ -56,6 +57,20 @@ enum ItemType
 #define RBILA_BEGIN_SOURCE     ( 1 <<  9 )
 #define RBILA_END_SOURCE       ( 1 << 10 )
 
+/****d* Items/ItemProperties
+ * FUNCTION
+ *   Flags for the properties of an item type, see
+ *   RB_Compute_Item_Properties().
+ * SOURCE
+ */
+
+#define RBIP_SOURCE            ( 1 <<  0 )      /* Works like a SOURCE item */
+#define RBIP_PREFORMATTED      ( 1 <<  1 )      /* Is preformatted */
+#define RBIP_FORMAT            ( 1 <<  2 )      /* Is formatted by the browser */
+#define RBIP_IGNORE            ( 1 <<  3 )      /* Is left out */
+
+/*****/
+
 /****s* Items/ItemLineKind
  * FUNCTION
  *   Holds the type of an item line
@@ -139,9 +154,12 @@ int                 RB_Ignore_Last_Item(
 char               *RB_Get_Item_Name(
     void );
 struct RB_Item     *RB_Create_Item(
+    struct RB_Arena *arena,
     enum ItemType arg_item_type );
+void                RB_Compute_Item_Properties(
+    void );
 int                 Is_Ignore_Item(
-    char *name );
+    enum ItemType item_type );
 int                 Works_Like_SourceItem(
     enum ItemType item_type );
 
@@ -0,0 +1,401 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Jobs
+ * FUNCTION
+ *   A simple pool of threads that does a number of independent
+ *   jobs, for instance the analysis of all the parts of a document.
+ *   The jobs are handed out in order, one at a time, to the first
+ *   thread that is free.  The calling thread does jobs too.
+ *
+ *   The jobs should not print anything directly, but use a message
+ *   log (see RB_Start_Message_Log()) that is replayed once all jobs
+ *   are done.  This way the output does not depend on the number of
+ *   threads.
+ *
+ *   When the number of jobs is not known in advance, for instance
+ *   the directories of the source tree, a job queue is used
+ *   instead, see RB_Run_Job_Queue().
+ *
+ *   Without POSIX threads (ROBO_NO_THREADS, or on Windows) all jobs
+ *   are done one after the other by the calling thread.
+ *****
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include "robodoc.h"
+#if !defined( ROBO_NO_THREADS ) && !defined( _WIN32 )
+#include <pthread.h>
+#define ROBO_USE_PTHREADS
+#endif
+
+#include "jobs.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+#ifdef ROBO_USE_PTHREADS
+
+/****is* Jobs/RB_Job_Pool
+ * FUNCTION
+ *   The state shared by the threads of a job pool.
+ * ATTRIBUTES
+ *   o lock     -- protects next_job.
+ *   o next_job -- the number of the next job that is to be done.
+ *   o no_jobs  -- the total number of jobs.
+ *   o function -- the function that does a job.
+ *   o data     -- the argument for function.
+ * SOURCE
+ */
+
+struct RB_Job_Pool
+{
+    pthread_mutex_t     lock;
+    int                 next_job;
+    int                 no_jobs;
+    RB_Job_Function     function;
+    void               *data;
+};
+
+/*******/
+
+
+/****if* Jobs/Do_Jobs
+ * FUNCTION
+ *   Keep on taking jobs from the pool until there are none left.
+ *   This is the start routine of each thread.
+ * SYNOPSIS
+ */
+static void        *Do_Jobs(
+    void *arg )
+/*
+ * INPUTS
+ *   o arg -- the RB_Job_Pool.
+ * SOURCE
+ */
+{
+    struct RB_Job_Pool *pool = arg;
+
+    for ( ;; )
+    {
+        int                 job;
+
+        pthread_mutex_lock( &pool->lock );
+        job = pool->next_job;
+        if ( job < pool->no_jobs )
+        {
+            ++( pool->next_job );
+        }
+        pthread_mutex_unlock( &pool->lock );
+        if ( job >= pool->no_jobs )
+        {
+            break;
+        }
+        pool->function( pool->data, job );
+    }
+    return NULL;
+}
+
+/*******/
+
+#endif
+
+
+/****f* Jobs/RB_Run_Jobs
+ * FUNCTION
+ *   Do a number of jobs using a pool of threads, and wait until
+ *   all of them are done.
+ * SYNOPSIS
+ */
+void RB_Run_Jobs(
+    int no_threads,
+    int no_jobs,
+    RB_Job_Function function,
+    void *data )
+/*
+ * INPUTS
+ *   o no_threads -- the maximum number of threads to use, including
+ *                   the calling thread.
+ *   o no_jobs    -- the number of jobs.
+ *   o function   -- the function that does a job, it is called
+ *                   once for each job.
+ *   o data       -- passed on to function.
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_PTHREADS
+    if ( no_threads > no_jobs )
+    {
+        no_threads = no_jobs;
+    }
+    if ( no_threads > 1 )
+    {
+        struct RB_Job_Pool  pool;
+        pthread_t          *threads;
+        int                 no_started;
+
+        threads = malloc( ( size_t ) ( no_threads - 1 ) *
+                          sizeof( pthread_t ) );
+        RB_Mem_Check( threads );
+        pthread_mutex_init( &pool.lock, NULL );
+        pool.next_job = 0;
+        pool.no_jobs = no_jobs;
+        pool.function = function;
+        pool.data = data;
+        /* If a thread can not be started the others just do more jobs. */
+        for ( no_started = 0; no_started < no_threads - 1; ++no_started )
+        {
+            if ( pthread_create( &threads[no_started], NULL, Do_Jobs,
+                                 &pool ) != 0 )
+            {
+                break;
+            }
+        }
+        Do_Jobs( &pool );
+        while ( no_started > 0 )
+        {
+            --no_started;
+            pthread_join( threads[no_started], NULL );
+        }
+        pthread_mutex_destroy( &pool.lock );
+        free( threads );
+        return;
+    }
+#else
+    USE( no_threads );
+#endif
+    {
+        int                 job;
+
+        for ( job = 0; job < no_jobs; ++job )
+        {
+            function( data, job );
+        }
+    }
+}
+
+/*******/
+
+
+/****is* Jobs/RB_Job_Queue
+ * FUNCTION
+ *   The jobs of RB_Run_Job_Queue() that have not been started yet.
+ * ATTRIBUTES
+ *   o jobs       -- a stack with the jobs.  The job that was added
+ *                   last is done first, this keeps the threads
+ *                   working on parts of the tree that are close
+ *                   together.
+ *   o no_jobs    -- the number of jobs on the stack.
+ *   o size       -- the size of jobs.
+ *   o no_active  -- the number of jobs that are being done.
+ *   o function   -- the function that does a job.
+ *   o lock       -- protects all of the above.
+ *   o changed    -- signalled when a job is added, or when the last
+ *                   job is done.
+ * SOURCE
+ */
+
+struct RB_Job_Queue
+{
+    void              **jobs;
+    int                 no_jobs;
+    int                 size;
+    int                 no_active;
+    RB_Queued_Job_Function function;
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_t     lock;
+    pthread_cond_t      changed;
+#endif
+};
+
+/*******/
+
+
+/****if* Jobs/Do_Queued_Jobs
+ * FUNCTION
+ *   Keep on taking jobs from a job queue until the queue is empty
+ *   and no job that is still busy can add a new one.  This is the
+ *   start routine of each thread of RB_Run_Job_Queue().
+ * SYNOPSIS
+ */
+static void        *Do_Queued_Jobs(
+    void *arg )
+/*
+ * INPUTS
+ *   o arg -- the RB_Job_Queue.
+ * SOURCE
+ */
+{
+    struct RB_Job_Queue *queue = arg;
+
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_lock( &queue->lock );
+    for ( ;; )
+    {
+        void               *job;
+
+        while ( ( queue->no_jobs == 0 ) && ( queue->no_active > 0 ) )
+        {
+            pthread_cond_wait( &queue->changed, &queue->lock );
+        }
+        if ( queue->no_jobs == 0 )
+        {
+            break;
+        }
+        job = queue->jobs[--( queue->no_jobs )];
+        ++( queue->no_active );
+        pthread_mutex_unlock( &queue->lock );
+        queue->function( queue, job );
+        pthread_mutex_lock( &queue->lock );
+        --( queue->no_active );
+        if ( ( queue->no_active == 0 ) && ( queue->no_jobs == 0 ) )
+        {
+            pthread_cond_broadcast( &queue->changed );
+        }
+    }
+    pthread_mutex_unlock( &queue->lock );
+#else
+    while ( queue->no_jobs > 0 )
+    {
+        void               *job = queue->jobs[--( queue->no_jobs )];
+
+        queue->function( queue, job );
+    }
+#endif
+    return NULL;
+}
+
+/*******/
+
+
+/****f* Jobs/RB_Queue_Job
+ * FUNCTION
+ *   Add a job to a job queue.  It is done by the first thread that
+ *   is free.
+ * SYNOPSIS
+ */
+void RB_Queue_Job(
+    struct RB_Job_Queue *queue,
+    void *job )
+/*
+ * INPUTS
+ *   o queue -- the job queue.
+ *   o job   -- passed on to the function of the queue.
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_lock( &queue->lock );
+#endif
+    if ( queue->no_jobs == queue->size )
+    {
+        queue->size = 2 * queue->size + 16;
+        queue->jobs = realloc( queue->jobs,
+                               ( size_t ) queue->size * sizeof( void * ) );
+        RB_Mem_Check( queue->jobs );
+    }
+    queue->jobs[queue->no_jobs++] = job;
+#ifdef ROBO_USE_PTHREADS
+    pthread_cond_signal( &queue->changed );
+    pthread_mutex_unlock( &queue->lock );
+#endif
+}
+
+/*******/
+
+
+/****f* Jobs/RB_Run_Job_Queue
+ * FUNCTION
+ *   Do a job, and all the jobs it adds to the queue, and the jobs
+ *   those add, etc, using a pool of threads.  Wait until all of
+ *   them are done.
+ * SYNOPSIS
+ */
+void RB_Run_Job_Queue(
+    int no_threads,
+    RB_Queued_Job_Function function,
+    void *first_job )
+/*
+ * INPUTS
+ *   o no_threads -- the maximum number of threads to use, including
+ *                   the calling thread.
+ *   o function   -- the function that does a job.
+ *   o first_job  -- the first job.
+ * SOURCE
+ */
+{
+    struct RB_Job_Queue queue;
+
+    queue.jobs = NULL;
+    queue.no_jobs = 0;
+    queue.size = 0;
+    queue.no_active = 0;
+    queue.function = function;
+#ifdef ROBO_USE_PTHREADS
+    pthread_mutex_init( &queue.lock, NULL );
+    pthread_cond_init( &queue.changed, NULL );
+#endif
+    RB_Queue_Job( &queue, first_job );
+#ifdef ROBO_USE_PTHREADS
+    if ( no_threads > 1 )
+    {
+        pthread_t          *threads;
+        int                 no_started;
+
+        threads = malloc( ( size_t ) ( no_threads - 1 ) *
+                          sizeof( pthread_t ) );
+        RB_Mem_Check( threads );
+        /* If a thread can not be started the others just do more jobs. */
+        for ( no_started = 0; no_started < no_threads - 1; ++no_started )
+        {
+            if ( pthread_create( &threads[no_started], NULL,
+                                 Do_Queued_Jobs, &queue ) != 0 )
+            {
+                break;
+            }
+        }
+        Do_Queued_Jobs( &queue );
+        while ( no_started > 0 )
+        {
+            --no_started;
+            pthread_join( threads[no_started], NULL );
+        }
+        free( threads );
+    }
+    else
+    {
+        Do_Queued_Jobs( &queue );
+    }
+    pthread_cond_destroy( &queue.changed );
+    pthread_mutex_destroy( &queue.lock );
+#else
+    USE( no_threads );
+    Do_Queued_Jobs( &queue );
+#endif
+    free( queue.jobs );
+}
+
+/*******/
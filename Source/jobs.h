@@ -0,0 +1,74 @@
+#ifndef ROBODOC_JOBS_H
+#define ROBODOC_JOBS_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****t* Jobs/RB_Job_Function
+ * FUNCTION
+ *   A function that does one job of a job pool.
+ * INPUTS
+ *   o data -- the data that was passed to RB_Run_Jobs().
+ *   o job  -- the number of the job, 0 .. no_jobs - 1.
+ * SOURCE
+ */
+
+typedef void        (
+    *RB_Job_Function )  (
+    void *data,
+    int job );
+
+/*******/
+
+struct RB_Job_Queue;
+
+/****t* Jobs/RB_Queued_Job_Function
+ * FUNCTION
+ *   A function that does one job of a job queue.  It can add new
+ *   jobs to the queue with RB_Queue_Job().
+ * INPUTS
+ *   o queue -- the job queue.
+ *   o job   -- the job, as it was passed to RB_Run_Job_Queue() or
+ *              RB_Queue_Job().
+ * SOURCE
+ */
+
+typedef void        (
+    *RB_Queued_Job_Function ) (
+    struct RB_Job_Queue * queue,
+    void *job );
+
+/*******/
+
+void                RB_Run_Jobs(
+    int no_threads,
+    int no_jobs,
+    RB_Job_Function function,
+    void *data );
+void                RB_Run_Job_Queue(
+    int no_threads,
+    RB_Queued_Job_Function function,
+    void *first_job );
+void                RB_Queue_Job(
+    struct RB_Job_Queue *queue,
+    void *job );
+
+#endif /* ROBODOC_JOBS_H */
@@ -44,7 +44,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <dmalloc.h>
 #endif
 
-static int          verbatim = FALSE;
+static ROBO_THREAD_LOCAL int verbatim = FALSE;
 
 
 /****f* LaTeX_Generator/RB_LaTeX_Generate_String
@@ -58,15 +58,7 @@ void RB_LaTeX_Generate_String(
     FILE *dest_doc,
     char *a_string )
 {
-    int                 i;
-    int                 l = strlen( a_string );
-    unsigned char       c;
-
-    for ( i = 0; i < l; i++ )
-    {
-        c = a_string[i];
-        RB_LaTeX_Generate_Char( dest_doc, c );
-    }
+    RB_Generate_Chars( dest_doc, a_string, strlen( a_string ) );
 }
 
 
@@ -50,6 +50,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "document.h"
 #include "part.h"
 #include "file.h"
+#include "arena.h"
+#include "intern.h"
 
 #ifdef DMALLOC
 #include <dmalloc.h>
@@ -61,10 +63,71 @@ struct RB_link    **link_index = NULL;
 struct RB_link    **case_sensitive_link_index = NULL;
 
 
+/****s* Links/RB_Link_Trie
+ * FUNCTION
+ *   A trie with the object names of all links.  It is used by
+ *   RB_Find_Link() to look up all the words that start at a given
+ *   position in a single walk over the characters.
+ *
+ *   The edges of the trie are stored in a hash table that is keyed
+ *   on the node the edge starts from and the character of the edge.
+ * ATTRIBUTES
+ *   * links      -- for each node the link of the name that ends at
+ *                   this node, or NULL.  Node 0 is the root.
+ *   * no_nodes   -- the number of nodes in use.
+ *   * edges      -- the hash table with the edges.
+ *   * edges_mask -- the size of the hash table minus one.
+ *   * fold_case  -- the names are stored in lower case.
+ * SOURCE
+ */
+
+struct RB_Link_Trie_Edge
+{
+    unsigned long       node;
+    unsigned long       child;
+    unsigned char       c;
+};
+
+struct RB_Link_Trie
+{
+    struct RB_link    **links;
+    unsigned long       no_nodes;
+    struct RB_Link_Trie_Edge *edges;
+    unsigned long       edges_mask;
+    int                 fold_case;
+};
+
+/*********/
+
+static struct RB_Link_Trie link_trie;
+static struct RB_Link_Trie case_insensitive_link_trie;
+
+/* The links of each header type, normal [0] and internal [1],
+ * see RB_Index_Links_By_Type() */
+static struct RB_link **links_by_type[256][2];
+static unsigned int no_links_by_type[256][2];
+static struct RB_link **links_by_type_storage = NULL;
+
+/****iv* Links/link_arena
+ * FUNCTION
+ *   The memory of all links, see RB_Alloc_Link().
+ *   It is freed as a whole by RB_Free_Links().
+ * SOURCE
+ */
+
+static struct RB_Arena link_arena;
+
+/*****/
+
+
 /* Local functions */
 
 static struct RB_link *RB_Alloc_Link( char *label_name, char *object_name,
                                       char *file_name );
+static void         RB_Build_Link_Trie( struct RB_Link_Trie *trie,
+                                        int fold_case );
+static void         RB_Free_Link_Trie( struct RB_Link_Trie *trie );
+static void         RB_Index_Links_By_Type( void );
 
 /* TODO Documentation */
 int link_cmp( void *l1, void *l2 )
@@ -81,6 +144,11 @@ int case_sensitive_link_cmp( void *l1, void *l2 )
     struct RB_link *link1 = l1;
     struct RB_link *link2 = l2;
 
+    /* The names are interned */
+    if ( link1->object_name == link2->object_name )
+    {
+        return 0;
+    }
     return strcmp( link1->object_name, link2->object_name );
 }
 
@@ -198,6 +266,15 @@ RB_CollectLinks( struct RB_Document *document,
     /* Sort all the links so we can use a binary search */
     RB_QuickSort( (void **)link_index, 0, link_index_size - 1, link_cmp );
     RB_QuickSort( (void **)case_sensitive_link_index, 0, link_index_size - 1, case_sensitive_link_cmp );
+
+    RB_Index_Links_By_Type(  );
+
+    /* And compile them into tries for RB_Find_Link() */
+    RB_Build_Link_Trie( &link_trie, FALSE );
+    if ( course_of_action.do_ignore_case_when_linking )
+    {
+        RB_Build_Link_Trie( &case_insensitive_link_trie, TRUE );
+    }
 }
 
 /*****/
@@ -213,93 +290,453 @@ void RB_Free_Links( void )
  * INPUTS
  *   o link_index_size
  *   o link_index[]
- * BUGS
- *   Should use RB_Free_Link instead of doing
- *   everything by it self.
  * SOURCE
  */
 {
-    struct RB_link     *cur_link;
+    RB_Free_Arena( &link_arena );
+    free( link_index );
+    free( case_sensitive_link_index );
+    RB_Free_Link_Trie( &link_trie );
+    RB_Free_Link_Trie( &case_insensitive_link_trie );
+    free( links_by_type_storage );
+    links_by_type_storage = NULL;
+    memset( links_by_type, 0, sizeof( links_by_type ) );
+    memset( no_links_by_type, 0, sizeof( no_links_by_type ) );
+}
+
+/*******/
+
+/****if* Links/RB_Index_Links_By_Type
+ * FUNCTION
+ *   Sort the links in link_index into a list per header type and
+ *   internal flag, so the index of a header type can be generated
+ *   without going through all links.  Within each list the links are
+ *   in the same order as in link_index.
+ *
+ *   A link is part of the list of a header type if
+ *   RB_CompareHeaderTypes() says its header type is equal, so the
+ *   list of the HT_MASTERINDEXTYPE contains all links.
+ * SYNOPSIS
+ */
+static void RB_Index_Links_By_Type(
+    void )
+/*
+ * SOURCE
+ */
+{
     unsigned int        i;
+    unsigned int        t;
+    unsigned long       total = 0;
+    struct RB_link    **next;
 
+    memset( no_links_by_type, 0, sizeof( no_links_by_type ) );
     for ( i = 0; i < link_index_size; ++i )
     {
-        cur_link = link_index[i];
-        free( cur_link->object_name );
-        free( cur_link->label_name );
-        free( cur_link->file_name );
-        free( cur_link );
+        struct RB_link     *cur_link = link_index[i];
+        int                 internal = cur_link->is_internal ? 1 : 0;
+
+        if ( !cur_link->htype )
+        {
+            continue;
+        }
+        if ( cur_link->htype->typeCharacter == HT_MASTERINDEXTYPE )
+        {
+            for ( t = 0; t < 256; ++t )
+            {
+                no_links_by_type[t][internal]++;
+            }
+        }
+        else
+        {
+            no_links_by_type[cur_link->htype->typeCharacter][internal]++;
+            no_links_by_type[HT_MASTERINDEXTYPE][internal]++;
+        }
+    }
+
+    for ( t = 0; t < 256; ++t )
+    {
+        total += no_links_by_type[t][0] + no_links_by_type[t][1];
+    }
+    links_by_type_storage = malloc( ( total + 1 ) * sizeof( struct RB_link * ) );
+    if ( !links_by_type_storage )
+    {
+        RB_Panic( "Out of memory! %s()\n", "RB_Index_Links_By_Type" );
+    }
+    for ( t = 0, next = links_by_type_storage; t < 256; ++t )
+    {
+        links_by_type[t][0] = next;
+        next += no_links_by_type[t][0];
+        links_by_type[t][1] = next;
+        next += no_links_by_type[t][1];
+    }
+
+    /* Fill the lists, the counts are recomputed along the way */
+    memset( no_links_by_type, 0, sizeof( no_links_by_type ) );
+    for ( i = 0; i < link_index_size; ++i )
+    {
+        struct RB_link     *cur_link = link_index[i];
+        int                 internal = cur_link->is_internal ? 1 : 0;
+
+        if ( !cur_link->htype )
+        {
+            continue;
+        }
+        if ( cur_link->htype->typeCharacter == HT_MASTERINDEXTYPE )
+        {
+            for ( t = 0; t < 256; ++t )
+            {
+                links_by_type[t][internal][no_links_by_type[t][internal]++] =
+                    cur_link;
+            }
+        }
+        else
+        {
+            t = cur_link->htype->typeCharacter;
+            links_by_type[t][internal][no_links_by_type[t][internal]++] =
+                cur_link;
+            links_by_type[HT_MASTERINDEXTYPE][internal]
+                [no_links_by_type[HT_MASTERINDEXTYPE][internal]++] = cur_link;
+        }
     }
-    free( link_index );
 }
 
-/*******/
+/*****/
 
-/* TODO Documentation */
 
+/****f* Links/RB_Get_Links_Of_Type
+ * FUNCTION
+ *   Get all the links of a given header type.
+ * SYNOPSIS
+ */
+unsigned int RB_Get_Links_Of_Type(
+    struct RB_HeaderType *header_type,
+    int internal,
+    struct RB_link ***links )
+/*
+ * INPUTS
+ *   o header_type -- the header type, for the HT_MASTERINDEXTYPE
+ *                    all links are returned.
+ *   o internal    -- get the links to internal headers instead of
+ *                    the links to normal headers.
+ * OUTPUT
+ *   o links       -- the links, in the order of link_index.
+ * RESULT
+ *   The number of links.
+ * SOURCE
+ */
+{
+    int                 i = internal ? 1 : 0;
+
+    *links = links_by_type[header_type->typeCharacter][i];
+    return no_links_by_type[header_type->typeCharacter][i];
+}
+
+/*****/
+
+
+/****f* Links/RB_Number_Of_Links
+ * FUNCTION
+ *   Count the links of a given header type.
+ * SYNOPSIS
+ */
 int RB_Number_Of_Links( struct RB_HeaderType* header_type, char* file_name, int internal )
+/*
+ * INPUTS
+ *   o header_type -- the header type.
+ *   o file_name   -- only count links to this documentation file,
+ *                    or NULL to count all links.  It has to be
+ *                    interned, see RB_Intern_String().
+ *   o internal    -- count the links to internal headers instead of
+ *                    the links to normal headers.
+ * RESULT
+ *   The number of links.
+ * SOURCE
+ */
 {
-    struct RB_link     *cur_link;
-    int                 n = 0;
+    struct RB_link    **links;
+    unsigned int        count;
     unsigned int        i;
+    int                 n = 0;
+
+    count = RB_Get_Links_Of_Type( header_type, internal, &links );
+    if ( !file_name )
+    {
+        return count;
+    }
+    for ( i = 0; i < count; ++i )
+    {
+        if ( file_name == links[i]->file_name )
+        {
+            n++;
+        }
+    }
+    return n;
+}
+
+/*****/
+
+
+/****if* Links/Search_Link_Index
+ * FUNCTION
+ *   Binary search for a name in one of the sorted link indices.
+ * SYNOPSIS
+ */
+static struct RB_link *Search_Link_Index(
+    char *name,
+    int ignore_case )
+/*
+ * INPUTS
+ *   o name        -- the name to search for.
+ *   o ignore_case -- search link_index with RB_Str_Case_Cmp()
+ *                    instead of case_sensitive_link_index with strcmp().
+ * RESULT
+ *   The link that was found, or NULL.
+ * SOURCE
+ */
+{
+    struct RB_link    **index =
+        ignore_case ? link_index : case_sensitive_link_index;
+    int                 low_index, high_index, cur_index, state;
+
+    for ( low_index = 0, high_index = link_index_size - 1;
+          high_index >= low_index; )
+    {
+        cur_index = ( high_index - low_index ) / 2 + low_index;
+        state = ignore_case ?
+            RB_Str_Case_Cmp( name, index[cur_index]->object_name ) :
+            strcmp( name, index[cur_index]->object_name );
+        if ( state < 0 )
+        {
+            high_index = cur_index - 1;
+        }
+        else if ( state == 0 )
+        {
+            return index[cur_index];
+        }
+        else
+        {
+            low_index = cur_index + 1;
+        }
+    }
+    return NULL;
+}
+
+/*****/
+
+
+/****if* Links/Link_Trie_Edge
+ * FUNCTION
+ *   Find the slot in the edge table of a trie for the edge
+ *   that starts at node and is labeled with c.
+ * SYNOPSIS
+ */
+static struct RB_Link_Trie_Edge *Link_Trie_Edge(
+    struct RB_Link_Trie *trie,
+    unsigned long node,
+    unsigned char c )
+/*
+ * RESULT
+ *   The slot with this edge, or the empty slot where it is to be
+ *   stored (child is 0).
+ * SOURCE
+ */
+{
+    unsigned long       h = ( node << 8 ) | c;
+    struct RB_Link_Trie_Edge *edge;
+
+    h ^= h >> 16;
+    h *= 0x45d9f3bUL;
+    h ^= h >> 16;
+    for ( edge = &( trie->edges[h & trie->edges_mask] );
+          edge->child && ( edge->node != node || edge->c != c );
+          edge = &( trie->edges[++h & trie->edges_mask] ) )
+    {
+        /* Empty */
+    }
+    return edge;
+}
+
+/*****/
+
+
+/****if* Links/Link_Trie_Char
+ * FUNCTION
+ *   The character that is used for c in a trie.
+ * SOURCE
+ */
+#define Link_Trie_Char( trie, c ) \
+    ( ( unsigned char ) ( ( trie )->fold_case ? tolower( c ) : ( c ) ) )
+/*****/
+
+
+/****f* Links/RB_Build_Link_Trie
+ * FUNCTION
+ *   Store the object names of all links in a trie.  For each name
+ *   the link that is stored is the link a binary search of the
+ *   link index would find, so lookups in the trie give the same
+ *   result as searching the index.
+ * SYNOPSIS
+ */
+static void RB_Build_Link_Trie(
+    struct RB_Link_Trie *trie,
+    int fold_case )
+/*
+ * INPUTS
+ *   o trie      -- the trie to build.
+ *   o fold_case -- build a case insensitive trie.
+ * SOURCE
+ */
+{
+    unsigned long       i;
+    unsigned long       max_nodes = 1;
+
+    for ( i = 0; i < link_index_size; ++i )
+    {
+        max_nodes += strlen( link_index[i]->object_name );
+    }
+    trie->fold_case = fold_case;
+    trie->no_nodes = 1;
+    trie->links = calloc( max_nodes, sizeof( struct RB_link * ) );
+    trie->edges_mask = RB_Hash_Table_Size( max_nodes ) - 1;
+    trie->edges =
+        calloc( trie->edges_mask + 1, sizeof( struct RB_Link_Trie_Edge ) );
+    if ( !trie->links || !trie->edges )
+    {
+        RB_Panic( "Out of memory! %s()\n", "RB_Build_Link_Trie" );
+    }
 
     for ( i = 0; i < link_index_size; ++i )
     {
-        cur_link = link_index[i];
-        if ( RB_CompareHeaderTypes( cur_link->htype, header_type ) &&
-             ( ( cur_link->is_internal && internal ) ||
-               ( !cur_link->is_internal && !internal ) ) )
+        char               *name = link_index[i]->object_name;
+        char               *c;
+        unsigned long       node = 0;
+
+        for ( c = name; *c; ++c )
         {
-            if ( file_name )
-            {
-                if ( strcmp( file_name, cur_link->file_name ) == 0 )
-                {
-                    n++;
-                }
-            }
-            else
+            struct RB_Link_Trie_Edge *edge =
+                Link_Trie_Edge( trie, node, Link_Trie_Char( trie, *c ) );
+
+            if ( !edge->child )
             {
-                n++;
+                edge->node = node;
+                edge->c = Link_Trie_Char( trie, *c );
+                edge->child = trie->no_nodes++;
             }
+            node = edge->child;
+        }
+        if ( !trie->links[node] )
+        {
+            trie->links[node] = Search_Link_Index( name, fold_case );
         }
     }
-    return n;
 }
 
-/****f* Links/Find_Link [3.0h]
+/*****/
+
+
+/****f* Links/RB_Free_Link_Trie
+ * FUNCTION
+ *   Deallocate the memory used by a trie.
+ * SYNOPSIS
+ */
+static void RB_Free_Link_Trie(
+    struct RB_Link_Trie *trie )
+/*
+ * SOURCE
+ */
+{
+    free( trie->links );
+    free( trie->edges );
+    memset( trie, 0, sizeof( struct RB_Link_Trie ) );
+}
+
+/*****/
+
+
+/****if* Links/Link_Trie_Lookup
+ * FUNCTION
+ *   Look up the words word[0..ends[k]) for k = 0, 1, 2 in a trie
+ *   with a single walk.
+ * SYNOPSIS
+ */
+static void Link_Trie_Lookup(
+    struct RB_Link_Trie *trie,
+    const char *word,
+    size_t *ends,
+    struct RB_link **found )
+/*
+ * INPUTS
+ *   o trie  -- the trie to search.
+ *   o word  -- the start of the words.
+ *   o ends  -- the lengths of the three words, from long to short.
+ * OUTPUT
+ *   o found -- for each word the link found, or NULL.
+ * SOURCE
+ */
+{
+    unsigned long       node = 0;
+    int                 k = 2;
+    size_t              depth;
+
+    found[0] = found[1] = found[2] = NULL;
+    for ( depth = 0; trie->links; ++depth )
+    {
+        struct RB_Link_Trie_Edge *edge;
+
+        for ( ; ( k >= 0 ) && ( ends[k] == depth ); --k )
+        {
+            found[k] = trie->links[node];
+        }
+        if ( k < 0 )
+        {
+            break;
+        }
+        edge = Link_Trie_Edge( trie, node,
+                               Link_Trie_Char( trie, word[depth] ) );
+        if ( !edge->child )
+        {
+            break;
+        }
+        node = edge->child;
+    }
+}
+
+/*****/
+
+
+/****f* Links/RB_Find_Link
  * NAME
- *   Find_Link -- try to match word with a link
+ *   RB_Find_Link -- try to match the start of a text with a link
  * FUNCTION
- *   Searches for the given word in the list of links and
- *   headers.  There are three passes (or four, when the C option
- *   is selected). Each pass uses a different definition of "word":
+ *   Searches for the word at the start of the given text in the list
+ *   of links.  There are three passes. Each pass uses a different
+ *   definition of "word":
  *   o In the first pass it is any thing that ends with a 'space', a '.' 
  *     or a ','.
  *   o In the second pass it is any string that consists of alpha
  *     numerics, '_', ':', '.', or '-'.  
  *   o In the third pass (for C) it is any string that consists 
  *     of alpha numerics or '_' (and '-' with --cobol).
+ *   Each word of a pass is the start of the word of the previous
+ *   pass, so all three are looked up with a single walk through the
+ *   link tries.
+ *
+ *   The text is not modified and does not have to end with a '\0'.
  * SYNOPSIS
  */
 
 int
-Find_Link( char *word_begin, 
-           char **object_name, 
-           char **label_name,
-           char **file_name )
+RB_Find_Link( const char *text,
+              size_t length,
+              struct RB_Link_Match *match )
 /*
  * INPUTS
- *   o word_begin  - pointer to a word (a string).
- *   o object_name  - pointer to a pointer to a string
- *   o file_name   - pointer to a pointer to a string
- * SIDE EFFECTS
- *   label_name & file_name are modified
+ *   o text   -- the text, for instance the rest of a line.
+ *   o length -- the number of characters in text.
+ * OUTPUT
+ *   o match  -- the link and the number of characters of text that
+ *               it matches, if a match was found.
  * RESULT
- *   o object_name   -- points to the object if a match was found,
- *                      NULL otherwise.
- *   o file_name     -- points to the file name if a match was found,
- *                      NULL otherwise.
- *   o label_name    -- points to the labelname if a match was found,
  *   o TRUE          -- a match was found.
  *   o FALSE         -- no match was found.
  * NOTES
@@ -309,125 +746,68 @@ Find_Link( char *word_begin,
  */
 
 {
-    char               *cur_char = NULL, old_char;
-    int                 low_index, high_index, cur_index, state, pass;
-    unsigned int        length = 0;
+    size_t              ends[3];
+    struct RB_link     *found[3];
+    struct RB_link     *found_case[3];
+    size_t              i;
+    int                 pass;
+
+    /* Find the end of the word of each pass.  */
+    for ( i = 0;
+          ( i < length ) &&
+          ( ( text[i] == '_' ) || ( course_of_action.do_hyphens && text[i] == '-' ) || utf8_isalnum( text[i] ) || utf8_ispunct( text[i] ) );
+          i++ );
+    ends[0] = i;
+    for ( i = 0;
+          ( i < length ) &&
+          ( utf8_isalnum( text[i] ) || ( text[i] == '_' ) ||
+            ( course_of_action.do_hyphens && text[i] == '-'  ) || ( text[i] == '.' ) ||
+            ( text[i] == ':' ) ); i++ );
+    ends[1] = i;
+    for ( i = 0;
+          ( i < length ) &&
+          ( utf8_isalnum( text[i] ) || ( text[i] == '_' ) || ( course_of_action.do_hyphens && text[i] == '-' ) ); 
+          i++ );
+    ends[2] = i;
 
     for ( pass = 0; pass < 3; pass++ )
     {
-        switch ( pass )
-        {
-        case 0:
-            {
-                for ( cur_char = word_begin;
-                      ( *cur_char == '_' ) || ( course_of_action.do_hyphens && *cur_char == '-' ) || utf8_isalnum( *cur_char ) || utf8_ispunct( *cur_char );
-                      cur_char++ );
-                break;
-            }
-        case 1:
-            {
-                for ( cur_char = word_begin;
-                      utf8_isalnum( *cur_char ) || ( *cur_char == '_' ) ||
-                      ( course_of_action.do_hyphens && *cur_char == '-'  ) || ( *cur_char == '.' ) ||
-                      ( *cur_char == ':' ); cur_char++ );
-                break;
-            }
-        case 2:
-            {
-                for ( cur_char = word_begin;
-                      utf8_isalnum( *cur_char ) || ( *cur_char == '_' ) || ( course_of_action.do_hyphens && *cur_char == '-' ); 
-                      cur_char++ );
-                break;
-            }
-        }
-
-        if ( ( ( *( cur_char - 1 ) ) == ',' ) || ( ( *( cur_char - 1 ) ) == '.' ) )
+        if ( ( ends[pass] > 0 ) &&
+             ( ( text[ends[pass] - 1] == ',' ) ||
+               ( text[ends[pass] - 1] == '.' ) ) )
         {
-            cur_char--;
+            ends[pass]--;
         }
+    }
 
-        old_char = *cur_char;
-        *cur_char = '\0';       /*
-                                 * End the word with a '\0' 
-                                 */
-        if ( strlen( word_begin ) == length )
-        {
-            /* Do not test the same word over and over. If
-             * the current string and the string of the previous
-             * pass are the same length, they are the same. */
+    Link_Trie_Lookup( &link_trie, text, ends, found );
+    Link_Trie_Lookup( &case_insensitive_link_trie, text, ends, found_case );
 
-            /* RB_Say ("Skipping (pass %d) \"%s\"\n", SAY_INFO, pass, word_begin);  */
-        }
-        else
+    for ( pass = 0; pass < 3; pass++ )
+    {
+        /* Do not test the same word over and over, and
+         * never test an empty word. */
+        if ( ( ends[pass] > 0 ) &&
+             ( ( pass == 0 ) || ( ends[pass] != ends[pass - 1] ) ) )
         {
-            length = strlen( word_begin );
-            /* RB_Say ("Testing (pass %d) \"%s\"\n", SAY_INFO, pass, word_begin); */
-            /*
-             * Search case sensitive for a link 
-             */
-            for ( cur_index = 0, low_index = 0, high_index =
-                    link_index_size - 1; high_index >= low_index; )
-            {
-                cur_index = ( high_index - low_index ) / 2 + low_index;
-                state = strcmp( word_begin, case_sensitive_link_index[cur_index]->object_name );
-                if ( state < 0 )
-                {
-                    high_index = cur_index - 1;
-                }
-                else if ( state == 0 )
-                {
-                    *object_name = case_sensitive_link_index[cur_index]->object_name;
-                    *label_name = case_sensitive_link_index[cur_index]->label_name;
-                    *file_name = case_sensitive_link_index[cur_index]->file_name;
-                    RB_Say( "linking \"%s\"->\"%s\" from \"%s\"\n", SAY_DEBUG,
-                            word_begin, *object_name, *file_name );
-                    *cur_char = old_char;
-                    return ( TRUE );
-                }
-                else if ( state > 0 )
-                {
-                    low_index = cur_index + 1;
-                }
-            }
+            /* First case sensitive, then case insensitive, but
+             * only when the user asks for this. */
+            struct RB_link     *link =
+                found[pass] ? found[pass] : found_case[pass];
 
-            /*
-             * Search case insensitive for a link.
-             * But only when the user asks for this.
-             */
-            if ( course_of_action.do_ignore_case_when_linking ) 
+            if ( link )
             {
-
-                for ( cur_index = 0, low_index = 0, high_index =
-                        link_index_size - 1; high_index >= low_index; )
-                {
-                    cur_index = ( high_index - low_index ) / 2 + low_index;
-                    state = RB_Str_Case_Cmp( word_begin, link_index[cur_index]->object_name );
-                    if ( state < 0 )
-                    {
-                        high_index = cur_index - 1;
-                    }
-                    else if ( state == 0 )
-                    {
-                        *object_name = link_index[cur_index]->object_name;
-                        *label_name = link_index[cur_index]->label_name;
-                        *file_name = link_index[cur_index]->file_name;
-                        RB_Say( "linking \"%s\"->\"%s\" from \"%s\"\n", SAY_DEBUG,
-                                word_begin, *object_name, *file_name );
-                        *cur_char = old_char;
-                        return ( TRUE );
-                    }
-                    else if ( state > 0 )
-                    {
-                        low_index = cur_index + 1;
-                    }
-                }
+                match->link = link;
+                match->length = ends[pass];
+                RB_Say( "linking \"%.*s\"->\"%s\" from \"%s\"\n", SAY_DEBUG,
+                        ( int ) ends[pass], text, link->object_name,
+                        link->file_name );
+                return ( TRUE );
             }
         }
-        *cur_char = old_char;
-        *file_name = NULL;
-        *object_name = NULL;
-        *label_name = NULL;
     }
+    match->link = NULL;
+    match->length = 0;
     return ( FALSE );
 }
 
@@ -438,7 +818,7 @@ Find_Link( char *word_begin,
  * NAME
  *   RB_Alloc_Link              -- oop
  * FUNCTION
- *   allocate struct + strings
+ *   allocate struct from link_arena, and intern the strings
  * SYNOPSIS
  */
 static struct RB_link *
@@ -452,7 +832,7 @@ RB_Alloc_Link( char *label_name, char *object_name, char *file_name )
  * AUTHOR
  *   Koessi
  * SEE ALSO
- *   RB_StrDup(), RB_Free_Link()
+ *   RB_Intern_String(), RB_Free_Links()
  * SOURCE
  */
 
@@ -463,49 +843,13 @@ RB_Alloc_Link( char *label_name, char *object_name, char *file_name )
     assert( label_name );
     assert( file_name );
     RB_Say( "Allocating a link (%s %s %s)\n", SAY_DEBUG, object_name, label_name, file_name );
-    new_link = malloc( sizeof( struct RB_link ) );
-    memset( new_link, 0, sizeof( struct RB_link ) );
+    new_link = RB_Arena_Calloc( &link_arena, 1, sizeof( struct RB_link ) );
 
-    new_link->file_name = RB_StrDup( file_name );
-    new_link->object_name = RB_StrDup( object_name );
-    new_link->label_name = RB_StrDup( label_name );
+    new_link->file_name = RB_Intern_String( file_name );
+    new_link->object_name = RB_Intern_String( object_name );
+    new_link->label_name = RB_Intern_String( label_name );
     return ( new_link );
 }
 
 /*****/
 
-/****f* Links/RB_Free_Link
- * NAME
- *   RB_Free_Link               -- oop
- * FUNCTION
- *   free struct + strings
- * SYNOPSIS
- */
-void RB_Free_Link( struct RB_link *arg_link )
-/*
- * INPUTS
- *   struct RB_link *link
- * AUTHOR
- *   Koessi
- * SEE ALSO
- *   RB_Alloc_Link(), RB_Close_The_Shop()
- * SOURCE
- */
-
-{
-    if ( arg_link )
-    {
-        if ( arg_link->label_name )
-        {
-            free( arg_link->label_name );
-        }
-        if ( arg_link->file_name )
-        {
-            free( arg_link->file_name );
-        }
-        free( arg_link );
-    }
-}
-
-/******/
-
@@ -54,20 +54,39 @@ struct RB_link
 
 /*********/
 
-int                 Find_Link(
-    char *word_begin,
-    char **object_name,
-    char **unique_name,
-    char **file_name );
+/****s* Links/RB_Link_Match
+ *  NAME
+ *    RB_Link_Match -- result of a link lookup
+ *  ATTRIBUTES
+ *    * length -- the number of characters of the text that
+ *                were matched.
+ *    * link   -- the link that was found.
+ *  SOURCE
+ */
+
+struct RB_Link_Match
+{
+    size_t              length;
+    struct RB_link     *link;
+};
+
+/*********/
+
+int                 RB_Find_Link(
+    const char *text,
+    size_t length,
+    struct RB_Link_Match *match );
 void                RB_CollectLinks(
     struct RB_Document *document,
     struct RB_header **headers,
     unsigned long count );
 void                RB_Free_Links(
     void );
-void                RB_Free_Link(
-    struct RB_link *arg_link );
 
+unsigned int        RB_Get_Links_Of_Type(
+    struct RB_HeaderType *header_type,
+    int internal,
+    struct RB_link ***links );
 int                 RB_Number_Of_Links(
     struct RB_HeaderType *header_type,
     char *file_name,
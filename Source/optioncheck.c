@@ -149,6 +149,9 @@ static char        *ok_options[] = {
     "--index",
     "--nosource",
     "--tabsize",
+    "--jobs",
+    "--cache",
+    "--watch",
     "--tell",
     "--debug",
     "--test",                   /* Special output mode for testing */
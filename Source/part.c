@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "headers.h"
 #include "file.h"
 #include "part.h"
+#include "document.h"
 #include "util.h"
 
 
@@ -41,6 +42,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <dmalloc.h>
 #endif
 
+static void         Add_Header_Name(
+    void *data );
 
 /****f* Part/RB_Get_RB_Part
  * FUNCTION
@@ -62,6 +65,8 @@ struct RB_Part* RB_Get_RB_Part( void  )
         part->filename = NULL;
         part->headers = NULL;
         part->last_header = NULL;
+        part->document = NULL;
+        RB_Init_Arena( &( part->arena ) );
     }
     else
     {
@@ -88,7 +93,9 @@ void RB_Free_RB_Part( struct RB_Part *part )
  */
 {
     /* part->filename  is freed by RB_Directory */
-    /* part->headers.  Headers are freed by the document */
+    /* part->headers.  Headers are freed by the document, their
+     * memory is freed with the arena. */
+    RB_Free_Arena( &( part->arena ) );
     free( part );
 }
 
@@ -137,7 +144,7 @@ FILE* RB_Open_Documentation( struct RB_Part * part )
     assert( part->filename );
     docfilename = RB_Get_FullDocname( part->filename );
     RB_Say( "Creating file %s\n", SAY_DEBUG, docfilename );
-    result = fopen( docfilename, "w" );
+    result = RB_Open_Output_File( docfilename );
     if ( result ) 
     {
         /* OK */
@@ -163,9 +170,21 @@ struct RB_Filename *RB_Part_Get_Source( struct RB_Part *part )
     return part->filename;
 }
 
-/* TODO Documentation */
+/****f* Part/RB_Part_Add_Header
+ * FUNCTION
+ *   Add a header to the end of the list of headers of a part.
+ *   If the part belongs to a document the header is also added
+ *   to the header name index of that document.
+ * SYNOPSIS
+ */
 void
 RB_Part_Add_Header( struct RB_Part *part, struct RB_header *header )
+/*
+ * INPUTS
+ *   o part   -- the part the header is to be added to.
+ *   o header -- the header.
+ * SOURCE
+ */
 {
     assert( header );
     assert( header->module_name );
@@ -184,4 +203,34 @@ RB_Part_Add_Header( struct RB_Part *part, struct RB_header *header )
         part->headers = header;
         part->last_header = header;
     }
+    if ( part->document )
+    {
+        /* The index is shared by all parts, so when the parts are
+         * analysed in parallel this is done in part order later on. */
+        RB_Defer( Add_Header_Name, header );
+    }
+}
+
+/******/
+
+
+/****if* Part/Add_Header_Name
+ * FUNCTION
+ *   Add a header to the header name index of the document of its
+ *   part.  See RB_Part_Add_Header().
+ * SYNOPSIS
+ */
+static void Add_Header_Name(
+    void *data )
+/*
+ * INPUTS
+ *   o data -- the header.
+ * SOURCE
+ */
+{
+    struct RB_header   *header = data;
+
+    RB_Document_Add_Header_Name( header->owner->document, header );
 }
+
+/******/
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include <stdio.h>
+#include "arena.h"
 
 /****s* Part/RB_Part
  * NAME
@@ -47,6 +48,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *                             to add the the heades in the 
  *                             same order as they were found in
  *                             the source file.
+ *   o document               -- the document this part was added
+ *                             to, or NULL.  Headers added to the
+ *                             part are also added to the header
+ *                             name index of this document.
+ *   o arena                  -- the memory of the headers of this
+ *                             part, their names, lines and items.
+ *                             It is freed with the part.
  *****
  */
 
@@ -56,6 +64,8 @@ struct RB_Part
     struct RB_Filename *filename;
     struct RB_header   *headers;
     struct RB_header   *last_header;
+    struct RB_Document *document;
+    struct RB_Arena     arena;
 };
 
 
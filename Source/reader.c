@@ -0,0 +1,462 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Reader
+ * FUNCTION
+ *   Reads the lines of a source file.
+ *
+ *   The whole file is mapped into memory with mmap(), or, if that
+ *   is not possible (pipes, files that do not end with a newline,
+ *   systems without mmap()), read into a buffer.  The lines are then
+ *   found with memchr() and handed out one at a time as a pointer
+ *   into this memory, so no memory is allocated per line.
+ *
+ *   The current line ends with a '\n' followed by a '\0', just like
+ *   the lines read with fgets() used to.  For a line that ends in
+ *   "\r\n" these two characters are replaced in place.  For other
+ *   lines the '\0' is written over the first character of the next
+ *   line, and that character is put back when the next line is
+ *   read.  The mapping is private, so the file itself is never
+ *   changed.
+ *
+ *   Accessing a mapping of a file that was truncated raises
+ *   SIGBUS, so with --watch, when the source files are edited
+ *   while ROBODoc runs, they are always read, see
+ *   RB_Allow_Source_Mapping().
+ *****
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define ROBO_USE_MMAP
+#endif
+
+#include "reader.h"
+#include "robodoc.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+#ifdef ROBO_USE_MMAP
+
+/****iv* Reader/allow_mapping
+ * FUNCTION
+ *   FALSE if source files must not be mapped into memory.
+ * SOURCE
+ */
+
+static int          allow_mapping = TRUE;
+
+/*******/
+
+
+/****if* Reader/Map_Source
+ * FUNCTION
+ *   Try to map a source file into memory.  This is only done if
+ *   there is room for the '\0' after the last line, that is if the
+ *   file ends with a '\n' and does not fill the last page of the
+ *   mapping completely.  The rest of that page is filled with
+ *   zeros.
+ * SYNOPSIS
+ */
+static int Map_Source(
+    struct RB_Source_Reader *reader,
+    FILE *file )
+/*
+ * INPUTS
+ *   o reader -- the reader to fill.
+ *   o file   -- the opened source file.
+ * RESULT
+ *   TRUE if the file was mapped, FALSE otherwise.
+ * SOURCE
+ */
+{
+    struct stat         st;
+    long                page_size = sysconf( _SC_PAGESIZE );
+    char               *data;
+    size_t              size;
+
+    if ( !allow_mapping || ( fstat( fileno( file ), &st ) != 0 ) ||
+         !S_ISREG( st.st_mode ) || ( st.st_size <= 0 ) ||
+         ( page_size <= 0 ) || ( st.st_size % page_size == 0 ) )
+    {
+        return FALSE;
+    }
+    size = ( size_t ) st.st_size;
+    data = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                 fileno( file ), 0 );
+    if ( data == MAP_FAILED )
+    {
+        return FALSE;
+    }
+    if ( data[size - 1] != '\n' )
+    {
+        munmap( data, size );
+        return FALSE;
+    }
+    reader->data = data;
+    reader->size = size;
+    reader->mapped = TRUE;
+    return TRUE;
+}
+
+/*******/
+
+#endif
+
+
+/****if* Reader/Load_Source
+ * FUNCTION
+ *   Read a source file into a buffer.  A '\n' is added if the last
+ *   line does not end with one.
+ * SYNOPSIS
+ */
+static void Load_Source(
+    struct RB_Source_Reader *reader,
+    FILE *file )
+/*
+ * INPUTS
+ *   o reader -- the reader to fill.
+ *   o file   -- the opened source file.
+ * SOURCE
+ */
+{
+    size_t              capacity = 64 * 1024;
+    size_t              size = 0;
+    size_t              n;
+    char               *data = malloc( capacity );
+
+    RB_Mem_Check( data );
+    for ( ;; )
+    {
+        /* Keep room for the '\n' and '\0' */
+        if ( capacity - size < 2 + 1 )
+        {
+            capacity *= 2;
+            data = realloc( data, capacity );
+            RB_Mem_Check( data );
+        }
+        n = fread( data + size, 1, capacity - size - 2, file );
+        if ( n == 0 )
+        {
+            break;
+        }
+        size += n;
+    }
+    if ( ferror( file ) )
+    {
+        RB_Panic( "I/O error while reading the source file!\n" );
+    }
+    if ( ( size > 0 ) && ( data[size - 1] != '\n' ) )
+    {
+        data[size++] = '\n';
+    }
+    data[size] = '\0';
+    reader->data = data;
+    reader->size = size;
+    reader->mapped = FALSE;
+}
+
+/*******/
+
+
+/****if* Reader/New_Source_Reader
+ * FUNCTION
+ *   Allocate a reader that is positioned at the first line.
+ * SOURCE
+ */
+
+static struct RB_Source_Reader *New_Source_Reader(
+    void )
+{
+    struct RB_Source_Reader *reader =
+        malloc( sizeof( struct RB_Source_Reader ) );
+
+    RB_Mem_Check( reader );
+    reader->position = 0;
+    reader->length = 0;
+    reader->saved = '\0';
+    reader->saved_at = NULL;
+    return reader;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Allow_Source_Mapping
+ * FUNCTION
+ *   Allow or forbid mapping source files into memory.  When it
+ *   is forbidden RB_Read_Source() reads every file into a buffer,
+ *   and RB_Map_Source() always fails.
+ * SYNOPSIS
+ */
+void RB_Allow_Source_Mapping(
+    int allow )
+/*
+ * INPUTS
+ *   o allow -- TRUE to allow mapping, which is the default.
+ * NOTES
+ *   Should be called before any source file is read.
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_MMAP
+    allow_mapping = allow;
+#else
+    USE( allow );
+#endif
+}
+
+/*******/
+
+
+/****f* Reader/RB_Read_Source
+ * FUNCTION
+ *   Read a source file, so its lines can be read with
+ *   RB_Next_Source_Line().  The file can be closed afterwards.
+ * SYNOPSIS
+ */
+struct RB_Source_Reader *RB_Read_Source(
+    FILE *file )
+/*
+ * INPUTS
+ *   o file -- the opened source file.
+ * RESULT
+ *   A reader positioned at the first line of the file.
+ *   Free it with RB_Free_Source_Reader().
+ * SOURCE
+ */
+{
+    struct RB_Source_Reader *reader = New_Source_Reader(  );
+
+#ifdef ROBO_USE_MMAP
+    if ( !Map_Source( reader, file ) )
+#endif
+    {
+        Load_Source( reader, file );
+    }
+    return reader;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Map_Source
+ * FUNCTION
+ *   Map a source file into memory, if that is possible, so its
+ *   lines can be read with RB_Next_Source_Line().  Unlike
+ *   RB_Read_Source() this never reads the file.  The directory
+ *   scan uses it to look at the content of a file, and keeps the
+ *   mapping for the analyser.
+ * SYNOPSIS
+ */
+struct RB_Source_Reader *RB_Map_Source(
+    FILE *file )
+/*
+ * INPUTS
+ *   o file -- the opened source file.
+ * RESULT
+ *   A reader positioned at the first line of the file, or NULL
+ *   if the file can not be mapped.  The file can be closed
+ *   afterwards.
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_MMAP
+    struct RB_Source_Reader *reader = New_Source_Reader(  );
+
+    if ( Map_Source( reader, file ) )
+    {
+        return reader;
+    }
+    free( reader );
+#else
+    USE( file );
+#endif
+    return NULL;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Next_Source_Line
+ * FUNCTION
+ *   Get the next line of a source file.
+ * SYNOPSIS
+ */
+char               *RB_Next_Source_Line(
+    struct RB_Source_Reader *reader )
+/*
+ * INPUTS
+ *   o reader -- the reader of the source file.
+ * RESULT
+ *   The line, ending with a "\n", or NULL if there are no more
+ *   lines.  The line stays valid until the next call; it can be
+ *   changed but not made longer.  After that it is still in
+ *   reader->data, but it is only terminated again if its "\n" is
+ *   replaced by a '\0'.  reader->length is set to the length of
+ *   the line.
+ * SOURCE
+ */
+{
+    char               *line;
+    char               *newline;
+
+    if ( reader->saved_at )
+    {
+        *( reader->saved_at ) = reader->saved;
+        reader->saved_at = NULL;
+    }
+    if ( reader->position >= reader->size )
+    {
+        reader->length = 0;
+        return NULL;
+    }
+
+    line = reader->data + reader->position;
+    /* The data ends with a '\n', so there always is one. */
+    newline = memchr( line, '\n', reader->size - reader->position );
+    assert( newline );
+    reader->position = ( newline + 1 ) - reader->data;
+
+    if ( ( newline > line ) && ( newline[-1] == '\r' ) )
+    {
+        /* "\r\n" becomes "\n\0" */
+        newline[-1] = '\n';
+        newline[0] = '\0';
+        reader->length = newline - line;
+    }
+    else
+    {
+        reader->saved_at = newline + 1;
+        reader->saved = newline[1];
+        newline[1] = '\0';
+        reader->length = ( newline + 1 ) - line;
+    }
+    return line;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Rest_Of_Source
+ * FUNCTION
+ *   Make the part of a source file that has not been read yet
+ *   available to be searched as a whole.  The current line is no
+ *   longer terminated by a '\0' afterwards.
+ * SYNOPSIS
+ */
+size_t RB_Rest_Of_Source(
+    struct RB_Source_Reader *reader )
+/*
+ * INPUTS
+ *   o reader -- the reader of the source file.
+ * RESULT
+ *   The offset in reader->data of the next line.
+ * SOURCE
+ */
+{
+    if ( reader->saved_at )
+    {
+        *( reader->saved_at ) = reader->saved;
+        reader->saved_at = NULL;
+    }
+    return reader->position;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Skip_Source_Lines
+ * FUNCTION
+ *   Skip lines of a source file without handing them out.
+ * SYNOPSIS
+ */
+size_t RB_Skip_Source_Lines(
+    struct RB_Source_Reader *reader,
+    size_t position )
+/*
+ * INPUTS
+ *   o reader   -- the reader of the source file.
+ *   o position -- the offset in reader->data of the line that is
+ *                 to be read next.  It has to be the start of a
+ *                 line, and not before the next line.
+ * RESULT
+ *   The number of lines that were skipped.
+ * SOURCE
+ */
+{
+    char               *c = reader->data + RB_Rest_Of_Source( reader );
+    char               *end = reader->data + position;
+    size_t              no_lines = 0;
+
+    assert( position >= reader->position );
+    assert( position <= reader->size );
+    while ( ( c < end ) &&
+            ( ( c = memchr( c, '\n', ( size_t ) ( end - c ) ) ) != NULL ) )
+    {
+        ++no_lines;
+        ++c;
+    }
+    reader->position = position;
+    return no_lines;
+}
+
+/*******/
+
+
+/****f* Reader/RB_Free_Source_Reader
+ * FUNCTION
+ *   Free a reader and the content of its source file.
+ * SYNOPSIS
+ */
+void RB_Free_Source_Reader(
+    struct RB_Source_Reader *reader )
+/*
+ * INPUTS
+ *   o reader -- the reader, returned by RB_Read_Source().
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_MMAP
+    if ( reader->mapped )
+    {
+        munmap( reader->data, reader->size );
+    }
+    else
+#endif
+    {
+        free( reader->data );
+    }
+    free( reader );
+}
+
+/*******/
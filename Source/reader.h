@@ -0,0 +1,74 @@
+#ifndef ROBODOC_READER_H
+#define ROBODOC_READER_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdio.h>
+
+/****s* Reader/RB_Source_Reader
+ * FUNCTION
+ *   The content of a source file, and the position of the
+ *   next line in it.
+ * ATTRIBUTES
+ *   o data     -- the content of the file.  It always ends with a '\n'
+ *                 that is followed by a '\0'.
+ *   o size     -- the number of characters in data, without the '\0'.
+ *   o position -- the offset of the next line in data.
+ *   o length   -- the length of the current line, including the '\n'.
+ *   o saved    -- the character that was replaced by the '\0' that
+ *                 terminates the current line.
+ *   o saved_at -- where it was replaced, or NULL if nothing was.
+ *   o mapped   -- TRUE if data was mapped with mmap(), FALSE if
+ *                 it was allocated.
+ * SOURCE
+ */
+
+struct RB_Source_Reader
+{
+    char               *data;
+    size_t              size;
+    size_t              position;
+    size_t              length;
+    char                saved;
+    char               *saved_at;
+    int                 mapped;
+};
+
+/*******/
+
+void                RB_Allow_Source_Mapping(
+    int allow );
+struct RB_Source_Reader *RB_Read_Source(
+    FILE *file );
+struct RB_Source_Reader *RB_Map_Source(
+    FILE *file );
+char               *RB_Next_Source_Line(
+    struct RB_Source_Reader *reader );
+size_t              RB_Rest_Of_Source(
+    struct RB_Source_Reader *reader );
+size_t              RB_Skip_Source_Lines(
+    struct RB_Source_Reader *reader,
+    size_t position );
+void                RB_Free_Source_Reader(
+    struct RB_Source_Reader *reader );
+
+#endif /* ROBODOC_READER_H */
@@ -57,6 +57,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <strings.h>
 #include <ctype.h>
 #include "headertypes.h"
+#include "headers.h"
 #include "util.h"
 #include "roboconfig.h"
 #include "globals.h"
@@ -260,11 +261,13 @@ static unsigned int keywords_hash_mask;
 
 /****v* Configuration/keywords_hash
  * FUNCTION
- *   This is the hash table for the keywords.
+ *   This is the hash table for the keywords.  It uses open addressing,
+ *   a keyword that collides with another one is stored in the next free
+ *   slot.  Empty slots have a NULL keyword.
  *   See keywords_hash_s.
  * SOURCE
  */
-static struct keywords_hash_s **keywords_hash;
+static struct keywords_hash_s *keywords_hash = NULL;
 
 /*****/
 
@@ -272,8 +275,8 @@ static struct keywords_hash_s **keywords_hash;
  * FUNCTION
  *   Allocates space for the keyword hash table.
  *
- *   The size of the table depends on the number of keywords rounded up to the
- *   next power of two.
+ *   The size of the table is a power of two that is at least twice
+ *   the number of keywords, so there are always empty slots.
  * SYNOPSIS
  */
 void allocate_keywords_hash_table(
@@ -282,121 +285,56 @@ void allocate_keywords_hash_table(
  * SOURCE
  */
 {
-    unsigned int        i;
-
     /* Calculate hash table size (powers of two) */
     for ( keywords_hash_mask = 2;
-          keywords_hash_mask < configuration.keywords.number;
+          keywords_hash_mask < 2 * configuration.keywords.number;
           keywords_hash_mask <<= 1 );
     keywords_hash_mask -= 1;
 
-    /* Allocate space for hash table */
-    keywords_hash = RB_malloc( ( keywords_hash_mask + 1 ) *
-                               sizeof( struct keywords_hash_s * ) );
-
-    /* Zero out all rows */
-    for ( i = 0; i <= keywords_hash_mask; i++ )
+    /* Allocate space for hash table, with all rows empty */
+    free( keywords_hash );
+    keywords_hash = calloc( keywords_hash_mask + 1,
+                            sizeof( struct keywords_hash_s ) );
+    if ( !keywords_hash )
     {
-        keywords_hash[i] = NULL;
+        RB_Panic( "Out of memory! %s()\n", "allocate_keywords_hash_table" );
     }
 }
 
 /*****/
 
-/****f* Hash_Keyword/HASH_MIX
- * FUNCTION
- *   Helper macro for the function Hash_Keyword( )
- * SOURCE
- */
-#define HASH_MIX(a,b,c)             \
-{                                   \
-  a -= b; a -= c; a ^= ( c >> 13 ); \
-  b -= c; b -= a; b ^= ( a << 8 );  \
-  c -= a; c -= b; c ^= ( b >> 13 ); \
-  a -= b; a -= c; a ^= ( c >> 12 ); \
-  b -= c; b -= a; b ^= ( a << 16 ); \
-  c -= a; c -= b; c ^= ( b >> 5 );  \
-  a -= b; a -= c; a ^= ( c >> 3 );  \
-  b -= c; b -= a; b ^= ( a << 10 ); \
-  c -= a; c -= b; c ^= ( b >> 15 ); \
-}
-
-/*****/
-
 /****f* Configuration/Hash_Keyword
  * FUNCTION
  *   Calculate the hash value for a string
  *
- *   The hash value is a 32 bit integer based on the hash function written by
- *   Bob Jenkins. It is then reduced by an AND operation to the actual size of
- *   the hash table.
+ *   The hash value is computed with the FNV-1a hash function.
+ *   It is then reduced by an AND operation to the actual size of
+ *   the hash table.  When fold_case is set the hash value is computed
+ *   for the string in lower case, without making a copy of it.
  * SYNOPSIS
  */
-unsigned long Hash_Keyword(
-    char *key,
-    unsigned long keylen )
+static unsigned long Hash_Keyword(
+    const char *key,
+    unsigned long keylen,
+    int fold_case )
 /*
  * INPUTS
- *   - key    -- The keyword string
- *   - keylen -- The length of the keyword string
+ *   - key       -- The keyword string
+ *   - keylen    -- The length of the keyword string
+ *   - fold_case -- Compute the hash of the lower case string
  * RETURN VALUE
  *   The hash value for the keyword.
  * SOURCE
  */
 {
-    unsigned long       bkt, i, j, k;
-
-    bkt = 0xfeedbeef;
-    i = j = 0x9e3779b9;
-    k = keylen;
-
-    while ( k >= 12 )
-    {
-        i += ( key[0] + ( ( unsigned ) key[1] << 8 )
-               + ( ( unsigned ) key[2] << 16 )
-               + ( ( unsigned ) key[3] << 24 ) );
-        j += ( key[4] + ( ( unsigned ) key[5] << 8 )
-               + ( ( unsigned ) key[6] << 16 )
-               + ( ( unsigned ) key[7] << 24 ) );
-        bkt += ( key[8] + ( ( unsigned ) key[9] << 8 )
-                 + ( ( unsigned ) key[10] << 16 )
-                 + ( ( unsigned ) key[11] << 24 ) );
-
-        HASH_MIX( i, j, bkt );
-
-        key += 12;
-        k -= 12;
-    }
-
-    bkt += keylen;
-
-    switch ( k )
-    {
-    case 11:
-        bkt += ( ( unsigned ) key[10] << 24 );
-    case 10:
-        bkt += ( ( unsigned ) key[9] << 16 );
-    case 9:
-        bkt += ( ( unsigned ) key[8] << 8 );
-    case 8:
-        j += ( ( unsigned ) key[7] << 24 );
-    case 7:
-        j += ( ( unsigned ) key[6] << 16 );
-    case 6:
-        j += ( ( unsigned ) key[5] << 8 );
-    case 5:
-        j += key[4];
-    case 4:
-        i += ( ( unsigned ) key[3] << 24 );
-    case 3:
-        i += ( ( unsigned ) key[2] << 16 );
-    case 2:
-        i += ( ( unsigned ) key[1] << 8 );
-    case 1:
-        i += key[0];
-    }
-
-    HASH_MIX( i, j, bkt );
+    unsigned long       bkt = 2166136261UL;
+    unsigned long       i;
+
+    for ( i = 0; i < keylen; i++ )
+    {
+        bkt ^= ( unsigned char ) ( fold_case ? tolower( key[i] ) : key[i] );
+        bkt *= 16777619UL;
+    }
 
     return ( bkt & keywords_hash_mask );
 }
@@ -406,7 +344,8 @@ unsigned long Hash_Keyword(
 
 /****f* Configuration/add_to_keywords_hash_table
  * FUNCTION
- *   Add a keyword to the hash table
+ *   Add a keyword to the hash table.  A keyword that is already
+ *   in the table is not added a second time.
  * SYNOPSIS
  */
 void add_to_keywords_hash_table(
@@ -417,78 +356,106 @@ void add_to_keywords_hash_table(
  * SOURCE
  */
 {
-    struct keywords_hash_s *tmp, **curr;
+    struct keywords_hash_s *curr;
     unsigned long       hash;
-
-    /* Allocate space for new entry in hash table */
-    tmp = RB_malloc( sizeof( struct keywords_hash_s ) );
-    /* and initialise it */
-    tmp->keyword = keyword;
-    tmp->next = NULL;
+    size_t              length = strlen( keyword );
 
     /* Calculate hash value */
-    hash = Hash_Keyword( keyword, strlen( keyword ) );
+    hash = Hash_Keyword( keyword, length, FALSE );
 
-    /* Seek to last element in hash table row */
-    for ( curr = &( keywords_hash[hash] ); *curr;
-          curr = &( ( *curr )->next ) );
+    /* Seek to the first empty slot */
+    for ( curr = &( keywords_hash[hash] ); curr->keyword;
+          curr = &( keywords_hash[++hash & keywords_hash_mask] ) )
+    {
+        if ( ( curr->length == length ) &&
+             ( strcmp( curr->keyword, keyword ) == 0 ) )
+        {
+            return;
+        }
+    }
 
     /* Insert entry into hash table */
-    *curr = tmp;
+    curr->keyword = keyword;
+    curr->length = length;
 }
 /*****/
 
-/****f* Configuration/Find_Keyword_Case_Sensitive
+/****f* Configuration/Find_Keyword
  * FUNCTION
- *   Find a keyword in the hash table case sensitive
+ *   Find a keyword in the hash table.
  * SYNOPSIS
  */
-char               *Find_Keyword_Case_Sensitive(
-    char *keyword,
-    int len
+static const char  *Find_Keyword(
+    const char *keyword,
+    size_t len,
+    int fold_case
     )
 /*
  * INPUTS
- *   - keyword -- The keyword string
- *   - len     -- The length of the keyword string
+ *   - keyword   -- The keyword string, it does not have to be
+ *                  terminated with a '\0'.
+ *   - len       -- The length of the keyword string
+ *   - fold_case -- Ignore the case of keyword, the keywords in
+ *                  the table are expected to be in lower case.
  * RETURN VALUE
- *   - pointer to real keyword
+ *   - pointer to the keyword in the table
  *   - NULL if the keyword is not found
  * SOURCE
  */
 {
-    unsigned long            hash;
-    struct keywords_hash_s  *curr;
-    char                    *keyword_found;
-    int                      keyword_found_flag;
-
-    keyword_found_flag = 0;
-    keyword_found = RB_malloc(len+1);
-    if (keyword_found){
-        strncpy(keyword_found, keyword, len);
-        keyword_found[len] = '\0';
-    
-        /* Calculate hash value */
-        hash = Hash_Keyword( keyword, len );
-
-        /* Seek through hash table row */
-        for ( curr = keywords_hash[hash]; curr; curr = curr->next )
+    unsigned long       hash;
+    struct keywords_hash_s *curr;
+
+    if ( !keywords_hash )
+    {
+        return NULL;
+    }
+
+    /* Calculate hash value */
+    hash = Hash_Keyword( keyword, len, fold_case );
+
+    /* Seek through the slots until an empty one is found */
+    for ( curr = &( keywords_hash[hash] ); curr->keyword;
+          curr = &( keywords_hash[++hash & keywords_hash_mask] ) )
+    {
+        if ( curr->length == len )
         {
-            /* Check for keyword in row element */
-            if ( !strncmp( keyword, curr->keyword, len ) )
+            size_t              i;
+
+            for ( i = 0; ( i < len ) &&
+                  ( ( fold_case ? tolower( keyword[i] ) : keyword[i] )
+                    == curr->keyword[i] ); i++ );
+            if ( i == len )
             {
                 /* Found it! */
-                keyword_found[strlen(curr->keyword)] = '\0';
-                keyword_found_flag = 1;
-                break;
+                return curr->keyword;
             }
         }
-        if (!keyword_found_flag && keyword_found){
-            free(keyword_found);
-            keyword_found = NULL;
-        }
     }
-    return keyword_found;
+    return NULL;
+}
+/*****/
+
+/****f* Configuration/Find_Keyword_Case_Sensitive
+ * FUNCTION
+ *   Find a keyword in the hash table case sensitive
+ * SYNOPSIS
+ */
+const char         *Find_Keyword_Case_Sensitive(
+    const char *keyword,
+    size_t len
+    )
+/*
+ * INPUTS
+ *   - keyword -- The keyword string
+ *   - len     -- The length of the keyword string
+ * RETURN VALUE
+ *   - pointer to real keyword
+ *   - NULL if the keyword is not found
+ * SOURCE
+ */
+{
+    return Find_Keyword( keyword, len, FALSE );
 }
 /*****/
 
@@ -497,65 +464,28 @@ char               *Find_Keyword_Case_Sensitive(
  *   Find a keyword in the hash table case insensitive
  * SYNOPSIS
  */
-char               *Find_Keyword_Case_Insensitive(
-    char *keyword,
-    int len
+const char         *Find_Keyword_Case_Insensitive(
+    const char *keyword,
+    size_t len
     )
 /*
  * INPUTS
  *   - keyword -- The keyword string
  *   - len     -- The length of the keyword string
  * RETURN VALUE
- *   - pointer to real keyword
+ *   - pointer to real keyword, this is in lower case.
  *   - NULL if the keyword is not found
  * SOURCE
  */
 {
-    unsigned long            hash;
-    struct keywords_hash_s  *curr;
-    char                    *keyword_lower;
-    char                    *keyword_found;
-    int                      keyword_found_flag;
-
-    keyword_found_flag = 0;
-    keyword_lower = RB_malloc(len+1);
-    keyword_found = RB_malloc(len+1);
-    if (keyword_lower && keyword_found){
-        strncpy(keyword_lower, keyword, len);
-        keyword_lower[len] = '\0';
-        strtolower(keyword_lower);
-        strncpy(keyword_found, keyword, len);
-        keyword_found[len] = '\0';
-    
-        /* Calculate hash value */
-        hash = Hash_Keyword( keyword_lower, len );
-
-        /* Seek through hash table row */
-        for ( curr = keywords_hash[hash]; curr; curr = curr->next )
-        {
-            /* Check for keyword in row element */
-            if ( !strncasecmp( keyword_lower, curr->keyword, len ) )
-            {
-                /* Found it! */
-                keyword_found[strlen(curr->keyword)] = '\0';
-                keyword_found_flag = 1;
-                break;
-            }
-        }
-        free(keyword_lower);
-        if (!keyword_found_flag && keyword_found){
-            free(keyword_found);
-            keyword_found = NULL;
-        }
-    }
-    return keyword_found;
+    return Find_Keyword( keyword, len, TRUE );
 }
 /*****/
 
 /****f* Configuration/add_keywords_to_hash_table
  * FUNCTION
  *   Initalize hash table and add all keywords from configuration.keywords
- *   to the hash table
+ *   to the hash table.  An existing hash table is replaced.
  * SOURCE
  */
 void add_keywords_to_hash_table(
@@ -767,8 +697,16 @@ char               *ReadConfiguration(
     }
     ComplementItemNames(  );
     ComplementHeaderMarkers(  );
+    RB_Compile_Begin_Markers(  );
     Complement_Remark_Markers(  );
+    RB_Compile_Markers(  );
     Install_Custom_HeaderTypes(  );
+    RB_Compile_Wildcards( &( configuration.ignore_file_patterns ),
+                          configuration.ignore_files.names,
+                          configuration.ignore_files.number );
+    RB_Compile_Wildcards( &( configuration.accept_file_patterns ),
+                          configuration.accept_files.names,
+                          configuration.accept_files.number );
 
     /* Make keywords hash table (if necessarry) */
     //add_keywords_to_hash_table(  );
@@ -1393,6 +1331,9 @@ void Free_Configuration(
     void )
 {
     /* TODO  Deallocate custom_headertypes */
+    RB_Free_Wildcards( &( configuration.ignore_file_patterns ) );
+    RB_Free_Wildcards( &( configuration.accept_file_patterns ) );
+    RB_Free_Markers(  );
 }
 
 
@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 */
 
+#include "wildcard.h"
+
 typedef enum
 {
     CFL_REMARK = 0,
@@ -60,16 +62,16 @@ typedef enum
 
 /****s* Configuration/keywords_hash_s
  * FUNCTION
- *    Structure for a keyword hash table row.
+ *    Structure for a keyword hash table slot.
  * ATTRIBUTES
- *    o keyword -- pointer to the keyword
- *    o next    -- pointer to next entry in the row
+ *    o keyword -- pointer to the keyword, NULL for an empty slot
+ *    o length  -- the length of the keyword
  * SOURCE
  */
 struct keywords_hash_s
 {
-    struct keywords_hash_s *next;
     char               *keyword;
+    size_t              length;
 };
 
 /*****/
@@ -122,6 +124,10 @@ struct Parameters
  *   o ignore_files          -- list with wildcard expressions that specifies
  *                              files and directories that robodoc should skip
  *                              while scanning the source tree.
+ *   o accept_files          -- list with wildcard expressions that specifies
+ *                              the files robodoc should scan.
+ *   o ignore_file_patterns  -- ignore_files, compiled.
+ *   o accept_file_patterns  -- accept_files, compiled.
  *   o header_markers        -- list with markers that mark the begin of a
  *                              header.
  *   o remark_markers        -- list with markers that mark a remark.
@@ -152,6 +158,8 @@ struct RB_Configuration
 
     struct Parameters   ignore_files;
     struct Parameters   accept_files;
+    struct RB_Wildcard_Set ignore_file_patterns;
+    struct RB_Wildcard_Set accept_file_patterns;
 
     struct Parameters   custom_headertypes;
     struct Parameters   header_markers;
@@ -176,12 +184,12 @@ void                Free_Configuration(
     void );
 void                Install_C_Syntax(
     void );
-char               *Find_Keyword_Case_Sensitive(
-    char *keyword,
-    int len );
-char               *Find_Keyword_Case_Insensitive(
-    char *keyword,
-    int len );
+const char         *Find_Keyword_Case_Sensitive(
+    const char *keyword,
+    size_t len );
+const char         *Find_Keyword_Case_Insensitive(
+    const char *keyword,
+    size_t len );
 char               *Find_Parameter_Exact(
     struct Parameters *params,
     char *paramname );
@@ -121,6 +121,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <locale.h>
+#include <limits.h>
+#include <errno.h>
 #ifdef __APPLE__
 #include <unistd.h>
 #endif
@@ -132,11 +134,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "links.h"
 #include "part.h"
 #include "analyser.h"
+#include "items.h"
 #include "generator.h"
 #include "document.h"
 #include "directory.h"
+#include "reader.h"
 #include "roboconfig.h"
 #include "optioncheck.h"
+#include "jobs.h"
+#include "cache.h"
+#include "watch.h"
+#include "intern.h"
 
 #ifdef DMALLOC
 #include <dmalloc.h>
@@ -236,6 +244,7 @@ char                use_usage[] =
     "Type:\n" "   --html, --rtf, --latex, --ascii, --dbxml, --troff\n" "\n";
 char                use_options1[] =
     "Options:\n"
+    "   --cache DIR      Keep the analysis of the source files in DIR.\n"
     "   --charset NAME   Add character encoding information (html only).\n"
     "   --cmode          Use ANSI C grammar in source items (html only).\n"
     "   --cobol          Allow hyphen in identifiers. Breaks cmode indexing.\n"
@@ -249,6 +258,8 @@ char                use_options1[] =
 char                use_options2[] =
     "   --internal       Also include internal headers.\n"
     "   --internalonly   Only include internal headers.\n"
+    "   --jobs NUMBER    Scan and analyse the source files and generate\n"
+    "                    multidoc documentation with NUMBER threads.\n"
     "   --lock           Recognize only one header marker per file.\n"
     "   --nodesc         Do not descent into subdirectories.\n"
     "   --no_subdirectories\n"
@@ -275,6 +286,8 @@ char                use_options3[] =
     "   --debug          same as --tell, but with lots more details.\n"
     "   --toc            Add a table of contents.\n"
     "   --version        Print version info and exit.\n"
+    "   --watch          Update the documentation each time the source\n"
+    "                    files change (multidoc and singledoc only).\n"
     "   --sectionnameonly\n"
     "                    Generate section header with name only.\n"
     "   --compress       Only supported by TROFF output format. Defines by which\n"
@@ -420,6 +433,7 @@ int main(
     used_rc_file = ReadConfiguration( argc, argv,
                                       RB_Find_In_Argv_Parameterized_Option
                                       ( argc, argv, "--rc" ) );
+    RB_Compute_Item_Properties(  );
 
     /* Force debug mode early if the user wants the debug mode */
     debugmode = Find_DebugMode(  );
@@ -480,6 +494,23 @@ int main(
     {
         document->first_section_level = atoi( optstr );
     }
+    optstr = Find_Parameterized_Option( "--jobs" );
+    if ( optstr )
+    {
+        char               *end;
+        long                no_jobs;
+
+        errno = 0;
+        no_jobs = strtol( optstr, &end, 10 );
+        if ( ( end == optstr ) || *end || errno ||
+             ( no_jobs < 1 ) || ( no_jobs > INT_MAX ) )
+        {
+            RB_Panic( "Invalid --jobs option \"%s\"\n"
+                      "Usage: --jobs NUMBER, with a NUMBER of threads"
+                      " of at least 1\n", optstr );
+        }
+        document->no_jobs = ( int ) no_jobs;
+    }
 
     course_of_action = document->actions;       /* a global */
     debugmode = document->debugmode;    /* a global */
@@ -493,6 +524,12 @@ int main(
     }
     add_keywords_to_hash_table(  );
 
+    optstr = Find_Parameterized_Option( "--cache" );
+    if ( optstr )
+    {
+        document->cache = RB_Cache_Create( optstr, used_rc_file );
+    }
+
     RB_Say( "Using %s for defaults\n", SAY_INFO, used_rc_file );
     free( used_rc_file );       /* No longer necessary */
     used_rc_file = NULL;
@@ -507,6 +544,19 @@ int main(
         document->js = Path_Convert_Win32_to_Unix( document->js );
     }
 
+    if ( Find_Option( "--watch" ) &&
+         ( document->actions.do_one_file_per_header ||
+           document->actions.do_singlefile ) )
+    {
+        RB_Panic( "--watch can not be used with --one_file_per_header"
+                  " or --singlefile\n" );
+    }
+    if ( Find_Option( "--watch" ) )
+    {
+        /* The source files can be truncated while they are mapped */
+        RB_Allow_Source_Mapping( FALSE );
+    }
+
     if ( ( document->actions.do_index ) && output_mode == TROFF )
     {
         RB_Warning( "Index generation not supported for TROFF format.\n" );
@@ -601,18 +651,23 @@ int main(
 
         document->docroot = RB_Get_RB_Path( docrootname );
 
-        srctree = RB_Get_RB_Directory( srcrootname, docrootname );
+        srctree = RB_Get_RB_Directory( srcrootname, docrootname,
+                                      document->no_jobs );
         document->srctree = srctree;
 
         RB_Document_Create_Parts( document );
         RB_Analyse_Document( document );
         RB_Generate_Documentation( document );
+        if ( Find_Option( "--watch" ) )
+        {
+            RB_Watch_Document( document );
+        }
 
         RB_Free_RB_Path( document->srcroot );
         document->srcroot = 0;
         RB_Free_RB_Path( document->docroot );
         document->docroot = 0;
-        RB_Free_RB_Directory( srctree );
+        RB_Free_RB_Directory( document->srctree );
         document->srctree = 0;
     }
     else if ( output_mode == TROFF )
@@ -642,14 +697,19 @@ int main(
         document->docroot = 0;
         document->singledoc_name = Find_And_Fix_Path( "--doc" );
 
-        srctree = RB_Get_RB_Directory( srcrootname, NULL );
+        srctree = RB_Get_RB_Directory( srcrootname, NULL,
+                                      document->no_jobs );
         document->srctree = srctree;
 
         RB_Document_Create_Parts( document );
         RB_Analyse_Document( document );
         RB_Generate_Documentation( document );
+        if ( Find_Option( "--watch" ) )
+        {
+            RB_Watch_Document( document );
+        }
 
-        RB_Free_RB_Directory( srctree );
+        RB_Free_RB_Directory( document->srctree );
     }
     else if ( Find_Option( "--singlefile" ) )
     {
@@ -693,7 +753,9 @@ int main(
     }
 
     RB_Summary( document );
+    RB_Cache_Free( document->cache );
     RB_Free_RB_Document( document );
+    RB_Free_Interned_Strings(  );
     Free_Configuration(  );
 
 #ifdef __APPLE__
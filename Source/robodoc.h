@@ -124,6 +124,22 @@ typedef enum
 
 #define USE( x ) ( x = x );
 
+/****d* ROBODoc/ROBO_THREAD_LOCAL
+ * FUNCTION
+ *   Storage class of the globals that are used while a source
+ *   file is analysed.  Each thread of the job pool (see RB_Run_Jobs())
+ *   gets its own copy.  Without thread support it expands to nothing.
+ * SOURCE
+ */
+
+#if defined( ROBO_NO_THREADS ) || defined( _WIN32 )
+#define ROBO_THREAD_LOCAL
+#else
+#define ROBO_THREAD_LOCAL __thread
+#endif
+
+/*****/
+
 /* Evil macros !! */
 #define skip_while(cond) { for (;*cur_char && (cond);cur_char++) ; }
 #define find_eol   { for (;*cur_char && *cur_char!='\n';cur_char++) ; }
@@ -293,15 +293,7 @@ void RB_RTF_Generate_String(
     FILE *dest_doc,
     char *a_string )
 {
-    int                 i;
-    int                 l = strlen( a_string );
-    unsigned char       c;
-
-    for ( i = 0; i < l; ++i )
-    {
-        c = a_string[i];
-        RB_RTF_Generate_Char( dest_doc, c );
-    }
+    RB_Generate_Chars( dest_doc, a_string, strlen( a_string ) );
 }
 
 void RB_RTF_Generate_Char(
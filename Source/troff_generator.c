@@ -41,16 +41,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "file.h"
 #include "part.h"
 
-static int          skip_space = 1;
-static int          in_list = 0;
-static int          preformat = 0;
-static int          skippre = 0;
-static int          end_of_line = 0;
-static int          end_of_para = 0;
+static ROBO_THREAD_LOCAL int skip_space = 1;
+static ROBO_THREAD_LOCAL int in_list = 0;
+static ROBO_THREAD_LOCAL int preformat = 0;
+static ROBO_THREAD_LOCAL int skippre = 0;
+static ROBO_THREAD_LOCAL int end_of_line = 0;
+static ROBO_THREAD_LOCAL int end_of_para = 0;
 
-static char        *compress_cmd = NULL;
-static char        *compress_ext = NULL;
-static char        *man_section = NULL;
+static ROBO_THREAD_LOCAL char *compress_cmd = NULL;
+static ROBO_THREAD_LOCAL char *compress_ext = NULL;
+static ROBO_THREAD_LOCAL char *man_section = NULL;
+
+static void         RB_TROFF_Reset_State(
+    void );
 
 /****h* ROBODoc/TROFF_Generator
  * FUNCTION
@@ -96,7 +99,7 @@ static FILE        *open_output_file(
         return file;
     }
     else
-        return fopen( out, "w" );
+        return RB_Open_Output_File( out );
 }
 
 static void write_comment(
@@ -142,6 +145,141 @@ static char        *basename(
     return base ? base + 1 : str;
 }
 
+static int Compare_Pages(
+    const void *p1,
+    const void *p2 )
+{
+    return strcmp( *( char * const * ) p1, *( char * const * ) p2 );
+}
+
+/****if* TROFF_Generator/Find_Section
+ * FUNCTION
+ *   Search for a SECTION item in a header, its first word is
+ *   used as the section of the manual page.
+ * RESULT
+ *   A copy of the section, or NULL if there is none.
+ ******
+ */
+
+static char        *Find_Section(
+    struct RB_header *cur_header )
+{
+    int                sec_item;
+    int                i;
+    struct RB_Item      *item;
+    char                *section = NULL;
+
+    /* Search for SECTION header and use this section for man pages */
+    sec_item = RB_Get_Item_Type("SECTION");
+    for( item = cur_header->items; item ; item = item->next) {
+        if( item->type == sec_item ) {
+            /* Item found, search for nonempty line */
+            for(i = 0 ; i < item->no_lines; i++ ) {
+                section = item->lines[i]->line;
+                while( *section && utf8_isspace(*section) ) section++;
+                if( *section ) {
+                    /* nonempty line found, break */
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    /* we found a section header, strip at next whitespace */
+    if( section && *section ) {
+        char *to, *ptr;
+        ptr = RB_malloc( strlen(section) + 1 );
+        to = ptr;
+        while( *section && !utf8_isspace(*section) ) {
+            *to++ = *section++;
+        }
+        *to++ = 0;
+        return ptr;
+    }
+    return NULL;
+}
+
+
+/****f* TROFF_Generator/RB_TROFF_Has_Shared_Pages
+ * FUNCTION
+ *   Check whether two headers are written to the same manual page,
+ *   or to the same link to a manual page.  If so the page that is
+ *   written last wins, so these headers must be generated in order.
+ * SYNOPSIS
+ */
+int RB_TROFF_Has_Shared_Pages(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document, with all headers collected.
+ * RESULT
+ *   TRUE if some manual pages are shared, FALSE otherwise.
+ * SOURCE
+ */
+{
+    char              **pages;
+    unsigned long       no_pages = 0;
+    unsigned long       i;
+    int                 shared = FALSE;
+
+    for ( i = 0; i < document->no_headers; ++i )
+    {
+        if ( document->headers[i]->name )
+        {
+            no_pages += document->headers[i]->no_names;
+        }
+    }
+    pages = malloc( ( no_pages + 1 ) * sizeof( char * ) );
+    RB_Mem_Check( pages );
+    no_pages = 0;
+    for ( i = 0; i < document->no_headers; ++i )
+    {
+        struct RB_header   *cur_header = document->headers[i];
+        char               *file;
+        char               *section;
+        size_t              len;
+        int                 j;
+
+        if ( !cur_header->name )
+        {
+            continue;
+        }
+        file = RB_Get_FullDocname( cur_header->owner->filename );
+        len = basename( file ) - file;
+        section = Find_Section( cur_header );
+        for ( j = 0; j < cur_header->no_names; ++j )
+        {
+            char               *name = basename( cur_header->names[j] );
+            char               *page =
+                RB_malloc( len + strlen( name ) + 2 +
+                           ( section ? strlen( section ) : 0 ) );
+
+            memcpy( page, file, len );
+            sprintf( page + len, "%s.%s", name, section ? section : "" );
+            pages[no_pages++] = page;
+        }
+        free( section );
+    }
+    qsort( pages, no_pages, sizeof( char * ), Compare_Pages );
+    for ( i = 1; i < no_pages; ++i )
+    {
+        if ( strcmp( pages[i - 1], pages[i] ) == 0 )
+        {
+            shared = TRUE;
+        }
+    }
+    for ( i = 0; i < no_pages; ++i )
+    {
+        free( pages[i] );
+    }
+    free( pages );
+    return shared;
+}
+
+/*******/
+
+
 /****f* TROFF_Generator/RB_TROFF_Generate_Header_Start
  * NAME
  *   RB_TROFF_Generate_Header_Start
@@ -152,11 +290,7 @@ FILE               *RB_TROFF_Generate_Header_Start(
     FILE *dest_doc,
     struct RB_header *cur_header )
 {
-    static char        *manpage = NULL;
-    int                sec_item;
-
-    if ( manpage == NULL )
-        manpage = RB_malloc( MAXPATHLEN );
+    static ROBO_THREAD_LOCAL char manpage[MAXPATHLEN];
 
     if ( cur_header->name )
     {
@@ -164,42 +298,16 @@ FILE               *RB_TROFF_Generate_Header_Start(
             RB_Get_FullDocname( cur_header->owner->filename );
         char               *name = basename( cur_header->name );
         char               *path = basename( file );
-        int                 len, i;
-        struct RB_Item      *item;
-        char                *section = NULL;
-
-        /* Search for SECTION header and use this section for man pages */
-        sec_item = RB_Get_Item_Type("SECTION");
-        for( item = cur_header->items; item ; item = item->next) {
-            if( item->type == sec_item ) {
-                /* Item found, search for nonempty line */
-                for(i = 0 ; i < item->no_lines; i++ ) {
-                    section = item->lines[i]->line;
-                    while( *section && utf8_isspace(*section) ) section++;
-                    if( *section ) {
-                        /* nonempty line found, break */
-                        break;
-                    }
-                }
-                break;
-            }
-        }
+        int                 len;
+#ifdef HAVE_SYMLINK
+        int                 i;
+#endif
+        char                *section = Find_Section( cur_header );
 
         len = path - file;
         memcpy( manpage, file, len );
 
-        /* we found a section header, strip at next whitespace */
-        if( section && *section ) {
-            char *to, *ptr;
-            ptr = RB_malloc( strlen(section) + 1 );
-            to = ptr;
-            while( *section && !utf8_isspace(*section) ) {
-                *to++ = *section++;
-            }
-            *to++ = 0;
-            section = ptr;
-        }
-        else {
+        if( section == NULL ) {
 	    section = man_section;
         }
 
@@ -213,6 +321,9 @@ FILE               *RB_TROFF_Generate_Header_Start(
 
         RB_Say( "+ Generating man page \"%s\"\n", SAY_INFO, manpage );
 
+        /* Nothing of the previous manual page carries over. */
+        RB_TROFF_Reset_State(  );
+
         /* Check for aliases if we have symlink() */
 #ifdef HAVE_SYMLINK
         for ( i = 1; i < cur_header->no_names; i++ )
@@ -226,8 +337,6 @@ FILE               *RB_TROFF_Generate_Header_Start(
             symlink( basename( manpage ), buf );
             RB_Say( "+ Linked with \"%s\"\n", SAY_INFO, buf );
         }
-#else
-        USE( i );
 #endif
 
         /* Append document type and title */
@@ -240,10 +349,18 @@ FILE               *RB_TROFF_Generate_Header_Start(
         {
             time_t              ttp;
             char                timeBuffer[255];
+#ifndef _WIN32
+            struct tm           tm;
+#endif
 
             time( &ttp );
+#ifdef _WIN32
             strftime( timeBuffer, sizeof timeBuffer, "%b %d, %Y",
                       localtime( &ttp ) );
+#else
+            strftime( timeBuffer, sizeof timeBuffer, "%b %d, %Y",
+                      localtime_r( &ttp, &tm ) );
+#endif
             fputs( timeBuffer, dest_doc );
 
             if ( name > cur_header->name )
@@ -278,7 +395,7 @@ void RB_TROFF_Generate_Header_End(
     struct RB_header *cur_header )
 {
 	USE( cur_header );
-    fclose( dest_doc );
+    RB_Close_Output_File( dest_doc );
 }
 
 
@@ -409,12 +526,12 @@ int RB_TROFF_Generate_Extra(
             p++;
             if ( *p == '-' )
                 p++;
-            if ( !utf8_isspace( p[1] ) )
+            if ( !*p || !utf8_isspace( p[1] ) )
                 return -1;
             in_list = 1;
             *item = 0;
             fprintf( out, ".TP\n.I %s\n\\-\\ ", skip );
-            strcpy( p, p + 2 );
+            memmove( p, p + 2, strlen( p + 2 ) + 1 );
             skip = item;
             *item = ' ';
             in_list = 2;
@@ -422,7 +539,7 @@ int RB_TROFF_Generate_Extra(
         else
         {
             char m = *p;
-            if ( !utf8_isspace( p[1] ) )
+            if ( !m || !utf8_isspace( p[1] ) )
                 return -1;
             if( strchr(p, ':') != NULL ) {
                 fprintf( out, ".IP \"" );
@@ -473,6 +590,25 @@ int RB_TROFF_Generate_Extra(
     return -1;
 }
 
+/****if* TROFF_Generator/RB_TROFF_Reset_State
+ * FUNCTION
+ *   Start a manual page at the beginning of a new line, so a
+ *   list or preformatted item of a previous manual page does not
+ *   carry over into the next one.
+ ******
+ */
+
+static void RB_TROFF_Reset_State(
+    void )
+{
+    skip_space = 1;
+    in_list = 0;
+    preformat = 0;
+    skippre = 0;
+    end_of_line = 1;
+    end_of_para = 1;
+}
+
 void RB_TROFF_Set_Param(
         char *compress,
         char *section )
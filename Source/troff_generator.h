@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "headers.h"
 #include "items.h"
+#include "document.h"
 
 char               *RB_TROFF_Get_Default_Extension(
     void );
@@ -70,6 +71,8 @@ void                TROFF_Generate_End_Paragraph(
     FILE *out );
 void                TROFF_Generate_Begin_Paragraph(
     FILE *out );
+int                 RB_TROFF_Has_Shared_Pages(
+    struct RB_Document *document );
 void                RB_TROFF_Set_Param(
     char *compress,
     char *section );
@@ -57,6 +57,53 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 
+/****if* Utilities/RB_Message
+ * FUNCTION
+ *   A message in a message log, see RB_Start_Message_Log().
+ * ATTRIBUTES
+ *   o kind        -- what to do when the log is replayed.
+ *   o text        -- the formatted message.
+ *   o file_name   -- the file the warning is about, or NULL.
+ *   o line_number -- the line the warning is about.
+ *   o function    -- the postponed call, see RB_Defer().
+ *   o data        -- the argument of the postponed call.
+ * SOURCE
+ */
+
+enum RB_Message_Kind
+{
+    RB_MESSAGE_SAY,
+    RB_MESSAGE_WARNING,
+    RB_MESSAGE_CALL
+};
+
+struct RB_Message
+{
+    struct RB_Message  *next;
+    enum RB_Message_Kind kind;
+    char               *text;
+    char               *file_name;
+    int                 line_number;
+    void                ( *function ) ( void * );
+    void               *data;
+};
+
+/*******/
+
+/* The message log of the current thread, NULL if messages are printed. */
+static ROBO_THREAD_LOCAL struct RB_Message_Log *message_log = NULL;
+
+/* The number of the next warning. */
+static int          warning_count = 1;
+
+/* The number of warnings given by the current thread. */
+static ROBO_THREAD_LOCAL int thread_warnings = 0;
+
+static struct RB_Message *Add_Message(
+    enum RB_Message_Kind kind );
+static char        *Format_Message(
+    const char *format,
+    va_list ap );
 static void         RB_Swap(
     void **array,
     int left,
@@ -66,67 +113,96 @@ static void         RB_Swap(
 /*===============================================================================*/
 
 
+/****if* Utilities/Tab_Jump
+ * FUNCTION
+ *   Compute the number of spaces a tab is expanded to.
+ * SYNOPSIS
+ */
+
+static int Tab_Jump(
+    int n,
+    int *actual_tab )
+/*
+ * INPUTS
+ *   o n          -- the column of the tab.
+ *   o actual_tab -- the tab stop that was used for the previous
+ *                   tab of the line, 0 for the first one.
+ *   o tab_stops  -- global.
+ * OUTPUT
+ *   o actual_tab -- the tab stop that is used for this tab.
+ * RESULT
+ *   The number of spaces.
+ * SOURCE
+ */
+{
+    int                 jump;
+
+    /* Seek to actual tab stop position in tabstop table */
+    while ( ( tab_stops[*actual_tab] <= n )
+            && ( *actual_tab < ( MAX_TABS - 1 ) ) )
+    {
+        ( *actual_tab )++;
+    }
+
+    jump = tab_stops[*actual_tab] - n;
+
+    /* If jump gets somehow negative fix it... */
+    if ( jump < 0 )
+    {
+        jump = 1;
+    }
+    return jump;
+}
+
+/******/
+
+
 /****f* Utilities/ExpandTab
  * FUNCTION
- *   Expand the tabs in a line of text.
+ *   Expand the tabs in a line of text.  Most lines have no tabs,
+ *   these are not copied.
  * SYNOPSIS
  */
 
 char               *ExpandTab(
+    struct RB_Arena *arena,
     char *line )
 /*
  * INPUTS
+ *   arena -- the arena the expanded line is allocated from.
  *   line -- the line to be expanded
- *   tab_size    -- global.
+ *   tab_stops   -- global.
  * RETURN
- *   pointer to the expanded line.
- * NOTE
- *   This function is not reentrant.
+ *   line itself if it has no tabs, otherwise a pointer to the
+ *   expanded line.
  * SOURCE
  */
 {
-    char               *cur_char = line;
+    char               *cur_char;
     int                 n = 0;
     int                 jump = 0;
     char               *newLine = NULL;
-    int                 lineBufLen = 1;
     int                 actual_tab = 0;
 
-    lineBufLen = strlen( line ) + 1;
+    if ( !strchr( line, '\t' ) )
+    {
+        return line;
+    }
 
-    if ( ( newLine = malloc( lineBufLen * sizeof( char ) ) ) == NULL )
+    /* First find the length of the expanded line */
+    for ( cur_char = line; *cur_char; ++cur_char )
     {
-        RB_Panic( "Out of memory! ExpandTab()\n" );
+        n += ( *cur_char == '\t' ) ? Tab_Jump( n, &actual_tab ) : 1;
     }
+    newLine = RB_Arena_Alloc( arena, n + 1 );
 
-    for ( ; *cur_char; ++cur_char )
+    n = 0;
+    actual_tab = 0;
+    for ( cur_char = line; *cur_char; ++cur_char )
     {
         if ( *cur_char == '\t' )
         {
-            int                 i;
-
-            /* Seek to actual tab stop position in tabstop table */
-            while ( ( tab_stops[actual_tab] <= n )
-                    && ( actual_tab < ( MAX_TABS - 1 ) ) )
-            {
-                actual_tab++;
-            }
-
-            jump = tab_stops[actual_tab] - n;
-
-            /* If jump gets somehow negative fix it... */
-            if ( jump < 0 )
-            {
-                jump = 1;
-            }
-
-            lineBufLen += jump;
-            if ( ( newLine = realloc( newLine, sizeof( char ) * lineBufLen ) )
-                 == NULL )
-            {
-                RB_Panic( "Out of memory! ExpandTab()\n" );
-            }
-            for ( i = 0; i < jump; i++ )
+            for ( jump = Tab_Jump( n, &actual_tab ); jump > 0; --jump )
             {
                 newLine[n] = ' ';
                 ++n;
@@ -153,8 +229,11 @@ char               *ExpandTab(
  */
 
 struct RB_header   *RB_Alloc_Header(
-    void )
+    struct RB_Arena *arena )
 /*
+ * INPUTS
+ *   struct RB_Arena *arena  -- the arena of the part the header is
+ *                              found in.
  * RESULT
  *   struct RB_header *      -- all attributes/pointers set to zero
  * AUTHOR
@@ -164,17 +243,7 @@ struct RB_header   *RB_Alloc_Header(
  * SOURCE
  */
 {
-    struct RB_header   *new_header;
-
-    if ( ( new_header = malloc( sizeof( struct RB_header ) ) ) != NULL )
-    {
-        memset( new_header, 0, sizeof( struct RB_header ) );
-    }
-    else
-    {
-        RB_Panic( "out of memory! [Alloc Header]\n" );
-    }
-    return ( new_header );
+    return RB_Arena_Calloc( arena, 1, sizeof( struct RB_header ) );
 }
 
 /********/
@@ -189,7 +258,9 @@ void RB_Free_Header(
     struct RB_header *header )
 /*
  * FUNCTION
- *   free struct RB_header and associated strings
+ *   free the strings of a struct RB_header that are not in the
+ *   arena of its part.  The header itself, its names, lines and
+ *   items are freed with the arena.
  * INPUTS
  *   struct RB_header *header -- this one
  * AUTHOR
@@ -201,33 +272,11 @@ void RB_Free_Header(
 {
     if ( header )
     {
-        if ( header->function_name )
-        {
-            free( header->function_name );
-        }
-        if ( header->version )
-        {
-            free( header->version );
-        }
-        if ( header->name )
-        {
-            free( header->name );
-        }
         if ( header->unique_name )
         {
             free( header->unique_name );
+            header->unique_name = NULL;
         }
-        if ( header->lines )
-        {
-            int                 i;
-
-            for ( i = 0; i < header->no_lines; ++i )
-            {
-                free( header->lines[i].line );
-            }
-            free( header->lines );
-        }
-        free( header );
     }
 }
 
@@ -289,6 +338,66 @@ char               *RB_StrDupLen(
 
 /*** RB_StrDup ***/
 
+
+/****f* Utilities/RB_Hash_String
+ * FUNCTION
+ *   Calculate a hash value for a string of a given length.
+ *   This is the FNV-1a hash.  It is used by the various
+ *   name indices.  The caller reduces the result to the
+ *   size of its table.
+ * SYNOPSIS
+ */
+unsigned long RB_Hash_String(
+    const char *str,
+    size_t length )
+/*
+ * INPUTS
+ *   o str    -- the string, does not need to be '\0' terminated.
+ *   o length -- the number of characters to hash.
+ * RESULT
+ *   The hash value.
+ * SOURCE
+ */
+{
+    unsigned long       hash = 2166136261UL;
+    size_t              i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        hash ^= ( unsigned char ) str[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/*****/
+
+
+/****f* Utilities/RB_Hash_Table_Size
+ * FUNCTION
+ *   Compute the size of a hash table that can comfortably hold the
+ *   given number of entries.  The size is a power of two, so a hash
+ *   value can be reduced to a bucket with an AND operation using
+ *   size - 1.
+ * SYNOPSIS
+ */
+unsigned long RB_Hash_Table_Size(
+    unsigned long no_entries )
+/*
+ * SOURCE
+ */
+{
+    unsigned long       size;
+
+    for ( size = 16; size < 2 * no_entries; size <<= 1 )
+    {
+        /* Empty */
+    }
+    return size;
+}
+
+/*****/
+
 /****f* Utilities/RB_Say [2.01]
  * NAME
  *   RB_Say                     -- varargs
@@ -317,8 +426,17 @@ void RB_Say(
     if ( course_of_action.do_tell && debugmode & mode )
     {
         va_start( ap, mode );
-        printf( "%s: ", whoami );
-        vprintf( format, ap );
+        if ( message_log )
+        {
+            struct RB_Message  *message = Add_Message( RB_MESSAGE_SAY );
+
+            message->text = Format_Message( format, ap );
+        }
+        else
+        {
+            printf( "%s: ", whoami );
+            vprintf( format, ap );
+        }
         va_end( ap );
     }
 }
@@ -398,13 +516,20 @@ void RB_Panic(
 
     if ( name )
     {
-        char               *buffer_copy = RB_StrDup( myLine );
-
-        RB_StripCR( buffer_copy );
         fprintf( stderr, "%s:\n%s(%d) : Error E1:\n", whoami, name,
                  line_number );
-        fprintf( stderr, "   %s\n%s: ", whoami, buffer_copy );
-        free( buffer_copy );
+        if ( myLine )
+        {
+            char               *buffer_copy = RB_StrDup( myLine );
+
+            RB_StripCR( buffer_copy );
+            fprintf( stderr, "   %s\n%s: ", whoami, buffer_copy );
+            free( buffer_copy );
+        }
+        else
+        {
+            fprintf( stderr, "   %s: ", whoami );
+        }
         free( name );
     }
     else
@@ -443,6 +568,7 @@ void RB_Warning_Full(
     va_list             ap;
 
     ++number_of_warnings;
+    ++thread_warnings;
     va_start( ap, arg_format );
     fprintf( stderr, "%s: Warning - %s:%d\n", whoami, arg_filename,
              arg_line_number );
@@ -469,27 +595,278 @@ void RB_Warning(
     char *format,
     ... )
 {
-    static int          count = 1;
     va_list             ap;
     char               *name;
 
-    ++number_of_warnings;
     va_start( ap, format );
-
     name = RB_GetCurrentFile(  );
+    ++thread_warnings;
+    if ( message_log )
+    {
+        struct RB_Message  *message = Add_Message( RB_MESSAGE_WARNING );
 
-    if ( name )
+        message->file_name = name;
+        message->line_number = line_number;
+        message->text = Format_Message( format, ap );
+    }
+    else
     {
-        fprintf( stderr, "%s:\n%s(%d) : Warning R%d:\n", whoami, name,
-                 line_number, count );
-        free( name );
+        ++number_of_warnings;
+        if ( name )
+        {
+            fprintf( stderr, "%s:\n%s(%d) : Warning R%d:\n", whoami, name,
+                     line_number, warning_count );
+            free( name );
+        }
+        fprintf( stderr, "  " );
+        vfprintf( stderr, format, ap );
+        ++warning_count;
     }
-
-    fprintf( stderr, "  " );
-    vfprintf( stderr, format, ap );
     va_end( ap );
+}
+
+/*******/
+
+
+/****if* Utilities/Add_Message
+ * FUNCTION
+ *   Append an empty message to the message log of the
+ *   current thread.
+ * SYNOPSIS
+ */
+static struct RB_Message *Add_Message(
+    enum RB_Message_Kind kind )
+/*
+ * RESULT
+ *   The new message.
+ * SOURCE
+ */
+{
+    struct RB_Message  *message = calloc( 1, sizeof( struct RB_Message ) );
 
-    ++count;
+    if ( !message )
+    {
+        RB_Panic( "Out of memory! %s()\n", "Add_Message" );
+    }
+    message->kind = kind;
+    if ( message_log->last )
+    {
+        message_log->last->next = message;
+    }
+    else
+    {
+        message_log->first = message;
+    }
+    message_log->last = message;
+    return message;
+}
+
+/*******/
+
+
+/****if* Utilities/Format_Message
+ * FUNCTION
+ *   Format a message into a newly allocated string.
+ * SYNOPSIS
+ */
+static char        *Format_Message(
+    const char *format,
+    va_list ap )
+/*
+ * SOURCE
+ */
+{
+    va_list             ap_copy;
+    int                 length;
+    char               *text;
+
+    va_copy( ap_copy, ap );
+    length = vsnprintf( NULL, 0, format, ap_copy );
+    va_end( ap_copy );
+    if ( length < 0 )
+    {
+        length = 0;
+    }
+    text = malloc( ( size_t ) length + 1 );
+    if ( !text )
+    {
+        RB_Panic( "Out of memory! %s()\n", "Format_Message" );
+    }
+    vsnprintf( text, ( size_t ) length + 1, format, ap );
+    return text;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Start_Message_Log
+ * FUNCTION
+ *   Start collecting the messages of the calling thread in a
+ *   message log.  Until RB_Stop_Message_Log() is called RB_Say()
+ *   and RB_Warning() add their message to the log instead of
+ *   printing it, and RB_Defer() adds the call to the log.
+ *   This is used to analyse several parts at the same time and still
+ *   print all messages in the same order as a serial run would.
+ * SYNOPSIS
+ */
+void RB_Start_Message_Log(
+    struct RB_Message_Log *log )
+/*
+ * INPUTS
+ *   o log -- an empty message log.
+ * SEE ALSO
+ *   RB_Replay_Message_Log()
+ * SOURCE
+ */
+{
+    log->first = NULL;
+    log->last = NULL;
+    message_log = log;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Stop_Message_Log
+ * FUNCTION
+ *   Stop collecting messages, from now on the messages of the
+ *   calling thread are printed again.
+ * SYNOPSIS
+ */
+void RB_Stop_Message_Log(
+    void )
+/*
+ * SOURCE
+ */
+{
+    message_log = NULL;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Message_Log_Active
+ * FUNCTION
+ *   Tell whether the messages of the calling thread go to a
+ *   message log.
+ * SYNOPSIS
+ */
+int RB_Message_Log_Active(
+    void )
+/*
+ * SOURCE
+ */
+{
+    return ( message_log != NULL );
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Thread_Warnings
+ * FUNCTION
+ *   Count the warnings that were given by the calling thread,
+ *   including those that went to its message log.
+ * SYNOPSIS
+ */
+int RB_Thread_Warnings(
+    void )
+/*
+ * RESULT
+ *   The number of warnings so far.
+ * SOURCE
+ */
+{
+    return thread_warnings;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Defer
+ * FUNCTION
+ *   Call a function that changes state that is shared between
+ *   threads.  If the calling thread collects its messages in a
+ *   message log the call is postponed until the log is replayed,
+ *   otherwise the function is called right away.
+ * SYNOPSIS
+ */
+void RB_Defer(
+    void ( *function ) ( void * ),
+    void *data )
+/*
+ * INPUTS
+ *   o function -- the function to be called.
+ *   o data     -- its argument.
+ * SOURCE
+ */
+{
+    if ( message_log )
+    {
+        struct RB_Message  *message = Add_Message( RB_MESSAGE_CALL );
+
+        message->function = function;
+        message->data = data;
+    }
+    else
+    {
+        function( data );
+    }
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Replay_Message_Log
+ * FUNCTION
+ *   Print all the messages in a message log and make all the
+ *   postponed calls, in the order in which they were added.
+ *   Warnings are numbered and counted at this point.  The log is
+ *   empty afterwards.
+ * SYNOPSIS
+ */
+void RB_Replay_Message_Log(
+    struct RB_Message_Log *log )
+/*
+ * INPUTS
+ *   o log -- the message log.
+ * SOURCE
+ */
+{
+    struct RB_Message  *message;
+    struct RB_Message  *next_message;
+
+    for ( message = log->first; message; message = next_message )
+    {
+        next_message = message->next;
+        switch ( message->kind )
+        {
+        case RB_MESSAGE_SAY:
+            printf( "%s: %s", whoami, message->text );
+            break;
+        case RB_MESSAGE_WARNING:
+            ++number_of_warnings;
+            if ( message->file_name )
+            {
+                fprintf( stderr, "%s:\n%s(%d) : Warning R%d:\n", whoami,
+                         message->file_name, message->line_number,
+                         warning_count );
+                free( message->file_name );
+            }
+            fprintf( stderr, "  %s", message->text );
+            ++warning_count;
+            break;
+        case RB_MESSAGE_CALL:
+            message->function( message->data );
+            break;
+        default:
+            assert( 0 );
+        }
+        free( message->text );
+        free( message );
+    }
+    log->first = NULL;
+    log->last = NULL;
 }
 
 /*******/
@@ -540,7 +917,16 @@ void RB_TimeStamp(
 
     time( &ttp );
     //strftime( timeBuffer, 255, "%a %b %d %Y %H:%M:%S\n", localtime( &ttp ) );
+#ifdef _WIN32
     strftime(timeBuffer, 255, "%Y-%m-%d %H:%M:%S", localtime( &ttp ) );
+#else
+    {
+        /* Documentation can be generated by several threads */
+        struct tm           tm;
+
+        strftime(timeBuffer, 255, "%Y-%m-%d %H:%M:%S", localtime_r( &ttp, &tm ) );
+    }
+#endif
     fprintf( f, "%s", timeBuffer );
 }
 
@@ -947,25 +1333,6 @@ int RB_ContainsNL(
 /*******/
 
 
-/****f* Utilities/RB_FreeLineBuffer
- * FUNCTION
- *   Free the dynamically allocated line-buffer
- * INPUTS
- *   * works on the globals line_buffer, readChars, myLine
- * SOURCE
- */
-
-void RB_FreeLineBuffer(
-     )
-{
-    *line_buffer = '\0';
-    free( myLine );
-    myLine = NULL;
-    readChars = 0;
-}
-
-/*******/
-
 /****f* Utilities/CR_LF_Conversion
  * FUNCTION
  *   Fix CR/LF problems.
@@ -1317,6 +1684,213 @@ void RB_Close_File(
 /*******/
 
 
+/****s* Utilities/RB_Output_Buffer
+ * FUNCTION
+ *   The stdio buffer of an output file opened with
+ *   RB_Open_Output_File().  It has to stay around until the
+ *   file is closed with RB_Close_Output_File().
+ * ATTRIBUTES
+ *   o file   -- the output file.
+ *   o buffer -- the buffer that was given to the file.
+ *   o next   -- the next buffer in the list of open output files.
+ * SOURCE
+ */
+
+struct RB_Output_Buffer
+{
+    FILE               *file;
+    char               *buffer;
+    struct RB_Output_Buffer *next;
+};
+
+/*******/
+
+/* The output files opened by this thread.  A file is always closed
+ * by the thread that opened it. */
+static ROBO_THREAD_LOCAL struct RB_Output_Buffer *output_buffers = NULL;
+
+/* The list the names of the output files of this thread are added
+ * to, NULL if they are not recorded. */
+static ROBO_THREAD_LOCAL struct RB_Output_List *output_list = NULL;
+
+
+/****f* Utilities/RB_Start_Output_List
+ * FUNCTION
+ *   Start recording the names of the documentation files that
+ *   are written by the calling thread, see RB_Record_Output_File().
+ * SYNOPSIS
+ */
+void RB_Start_Output_List(
+    struct RB_Output_List *list )
+/*
+ * INPUTS
+ *   o list -- the list the names are added to.  It should be
+ *             empty, or a list that was recorded before.
+ * SOURCE
+ */
+{
+    output_list = list;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Stop_Output_List
+ * FUNCTION
+ *   Stop recording the names of the documentation files.
+ * SOURCE
+ */
+
+void RB_Stop_Output_List(
+    void )
+{
+    output_list = NULL;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Record_Output_File
+ * FUNCTION
+ *   Add the name of a documentation file to the output list of
+ *   the calling thread, if it has one.  RB_Open_Output_File()
+ *   does this for all files it opens.  Files that are written
+ *   in another way should be recorded with this function.
+ * SYNOPSIS
+ */
+void RB_Record_Output_File(
+    char *file_name )
+/*
+ * INPUTS
+ *   o file_name -- the name of the file.
+ * SOURCE
+ */
+{
+    if ( output_list )
+    {
+        if ( output_list->no_names == output_list->size )
+        {
+            output_list->size = 2 * output_list->size + 8;
+            output_list->names = realloc( output_list->names,
+                                          output_list->size *
+                                          sizeof( char * ) );
+            RB_Mem_Check( output_list->names );
+        }
+        output_list->names[output_list->no_names++] = RB_StrDup( file_name );
+    }
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Free_Output_List
+ * FUNCTION
+ *   Free the names in an output list.
+ * SOURCE
+ */
+
+void RB_Free_Output_List(
+    struct RB_Output_List *list )
+{
+    int                 i;
+
+    for ( i = 0; i < list->no_names; ++i )
+    {
+        free( list->names[i] );
+    }
+    free( list->names );
+    list->names = NULL;
+    list->no_names = 0;
+    list->size = 0;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Open_Output_File
+ * FUNCTION
+ *   Opens a documentation file for writing and gives it a large
+ *   buffer of RB_OUTPUT_BUFFER_SIZE bytes.  Documentation is written
+ *   in many small pieces, with a large buffer these end up in
+ *   the file with a few large writes.
+ * SYNOPSIS
+ */
+FILE               *RB_Open_Output_File(
+    char *file_name )
+/*
+ * INPUTS
+ *   o file_name -- the name of the file.
+ * RESULT
+ *   The opened file, or NULL if it could not be opened.
+ * SEE ALSO
+ *   RB_Close_Output_File()
+ * SOURCE
+ */
+{
+    FILE               *a_file;
+    struct RB_Output_Buffer *output_buffer;
+
+    a_file = fopen( file_name, "w" );
+    if ( a_file == NULL )
+    {
+        return NULL;
+    }
+
+    output_buffer = malloc( sizeof( struct RB_Output_Buffer ) );
+    RB_Mem_Check( output_buffer );
+    output_buffer->buffer = malloc( RB_OUTPUT_BUFFER_SIZE );
+    RB_Mem_Check( output_buffer->buffer );
+    output_buffer->file = a_file;
+    setvbuf( a_file, output_buffer->buffer, _IOFBF, RB_OUTPUT_BUFFER_SIZE );
+
+    output_buffer->next = output_buffers;
+    output_buffers = output_buffer;
+    RB_Record_Output_File( file_name );
+    return a_file;
+}
+
+/*******/
+
+
+/****f* Utilities/RB_Close_Output_File
+ * FUNCTION
+ *   Closes a file and frees the buffer it was given by
+ *   RB_Open_Output_File().  Files that were opened in another
+ *   way are just closed.
+ * SYNOPSIS
+ */
+void RB_Close_Output_File(
+    FILE *arg_file )
+/*
+ * INPUTS
+ *   o arg_file -- the file to close.
+ * SOURCE
+ */
+{
+    struct RB_Output_Buffer **link;
+    struct RB_Output_Buffer *output_buffer;
+
+    if ( arg_file == NULL )
+    {
+        return;
+    }
+    fclose( arg_file );
+    for ( link = &output_buffers; *link; link = &( ( *link )->next ) )
+    {
+        if ( ( *link )->file == arg_file )
+        {
+            output_buffer = *link;
+            *link = output_buffer->next;
+            free( output_buffer->buffer );
+            free( output_buffer );
+            break;
+        }
+    }
+}
+
+/*******/
+
+
 /* TODO Move this to a separate file */
 /* TODO grow this into a whole set of utf8 routines. */
 /* TODO Documentation */
@@ -29,6 +29,49 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "robodoc.h"
 #include "headers.h"
 #include "document.h"
+#include "arena.h"
+
+/****d* Utilities/RB_OUTPUT_BUFFER_SIZE
+ * FUNCTION
+ *   Size of the buffer of a documentation file,
+ *   see RB_Open_Output_File().
+ * SOURCE
+ */
+
+#define RB_OUTPUT_BUFFER_SIZE ( 256 * 1024 )
+
+/*******/
+
+/****s* Utilities/RB_Message_Log
+ * FUNCTION
+ *   The messages and postponed calls of a thread, in the order
+ *   in which they were made.  See RB_Start_Message_Log().
+ * SOURCE
+ */
+
+struct RB_Message_Log
+{
+    struct RB_Message  *first;
+    struct RB_Message  *last;
+};
+
+/*******/
+
+/****s* Utilities/RB_Output_List
+ * FUNCTION
+ *   The names of the documentation files that were written by a
+ *   thread.  See RB_Start_Output_List().
+ * SOURCE
+ */
+
+struct RB_Output_List
+{
+    char              **names;
+    int                 no_names;
+    int                 size;
+};
+
+/*******/
 
 typedef int         (
     *TCompare )         (
@@ -57,7 +100,7 @@ void                RB_Remove_From_List(
     struct RB_header **,
     struct RB_header * );
 struct RB_header   *RB_Alloc_Header(
-    void );
+    struct RB_Arena *arena );
 void                RB_Free_Header(
     struct RB_header * );
 char               *RB_StrDup(
@@ -65,6 +108,11 @@ char               *RB_StrDup(
 char               *RB_StrDupLen(
     char *str,
     size_t length );
+unsigned long       RB_Hash_String(
+    const char *str,
+    size_t length );
+unsigned long       RB_Hash_Table_Size(
+    unsigned long no_entries );
 char               *RB_CookStr(
     char * );
 void                RB_Say(
@@ -82,6 +130,19 @@ void                RB_Warning(
 void                RB_Panic(
     char *,
     ... );
+void                RB_Start_Message_Log(
+    struct RB_Message_Log *log );
+void                RB_Stop_Message_Log(
+    void );
+int                 RB_Message_Log_Active(
+    void );
+int                 RB_Thread_Warnings(
+    void );
+void                RB_Defer(
+    void ( *function ) ( void * ),
+    void *data );
+void                RB_Replay_Message_Log(
+    struct RB_Message_Log *log );
 int                 RB_Str_Case_Cmp(
     char *s,
     char *t );
@@ -118,6 +179,7 @@ int                 Stat_Path(
     char *path );
 
 char               *ExpandTab(
+    struct RB_Arena *arena,
     char *line );
 
 int                 RB_ContainsNL(
@@ -126,8 +188,6 @@ char               *RB_ReadWholeLine(
     FILE *file,
     char *buf,
     int *arg_readChars );
-void                RB_FreeLineBuffer(
-     );
 
 void               *RB_malloc(
     size_t bytes );
@@ -147,6 +207,18 @@ FILE               *RB_Open_File(
     char * );
 void                RB_Close_File(
     FILE * );
+FILE               *RB_Open_Output_File(
+    char *file_name );
+void                RB_Close_Output_File(
+    FILE *arg_file );
+void                RB_Start_Output_List(
+    struct RB_Output_List *list );
+void                RB_Stop_Output_List(
+    void );
+void                RB_Record_Output_File(
+    char *file_name );
+void                RB_Free_Output_List(
+    struct RB_Output_List *list );
 
 
 void                _RB_Mem_Check(
@@ -0,0 +1,783 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Watch
+ * FUNCTION
+ *   Keep the analysed document in memory after the documentation
+ *   was generated, and update the documentation whenever one of
+ *   the source files changes (--watch).
+ *
+ *   Only the source files that changed are analysed again.  The
+ *   headers of the other source files are kept as they are.  The
+ *   links between the headers, the index, and the documentation
+ *   are then generated again from the parts, see
+ *   RB_Document_Reset().  With --cache only the documentation
+ *   files that are out of date are written.
+ *
+ *   The directories of the source tree are watched with inotify,
+ *   so this is only available on Linux.  The source tree is only
+ *   scanned again when files or directories are added or removed.
+ *****
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "robodoc.h"
+#if defined( __linux__ )
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#define ROBO_USE_INOTIFY
+#endif
+
+#include "watch.h"
+#include "analyser.h"
+#include "directory.h"
+#include "file.h"
+#include "generator.h"
+#include "globals.h"
+#include "headers.h"
+#include "intern.h"
+#include "part.h"
+#include "path.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+#ifdef ROBO_USE_INOTIFY
+
+/****id* Watch/RB_WATCH_EVENTS
+ * FUNCTION
+ *   The inotify events that are watched for in each directory of
+ *   the source tree.
+ * SOURCE
+ */
+
+#define RB_WATCH_EVENTS ( IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | \
+                          IN_MOVED_FROM | IN_MOVED_TO )
+
+/*******/
+
+
+/****id* Watch/RB_WATCH_QUIET_TIME
+ * FUNCTION
+ *   The number of milliseconds without new events after which
+ *   the changes are handled.  Editors and version control tools
+ *   often change several files, or one file several times, in a
+ *   short time.
+ * SOURCE
+ */
+
+#define RB_WATCH_QUIET_TIME 200
+
+/*******/
+
+
+/****is* Watch/RB_Watch_Change
+ * FUNCTION
+ *   A file in one of the watched directories that changed.
+ * ATTRIBUTES
+ *   o directory -- the index of the directory in
+ *                  RB_Watch->directories.
+ *   o full_name -- the name of the file including the path.
+ * SOURCE
+ */
+
+struct RB_Watch_Change
+{
+    int                 directory;
+    char               *full_name;
+};
+
+/*******/
+
+
+/****is* Watch/RB_Watch
+ * FUNCTION
+ *   The state of the watcher.
+ * ATTRIBUTES
+ *   o fd             -- the inotify instance.
+ *   o directories    -- the names of the watched directories,
+ *                       indexed on their watch descriptor.
+ *   o no_directories -- the size of directories.
+ *   o changes        -- the files that changed since the last
+ *                       update.
+ *   o no_changes     -- the number of changes.
+ *   o size           -- the size of changes.
+ *   o rescan         -- TRUE if the source tree has to be
+ *                       scanned again.
+ *   o everything     -- TRUE if all source files have to be
+ *                       analysed again, because events were lost.
+ * SOURCE
+ */
+
+struct RB_Watch
+{
+    int                 fd;
+    char              **directories;
+    int                 no_directories;
+    struct RB_Watch_Change *changes;
+    int                 no_changes;
+    int                 size;
+    int                 rescan;
+    int                 everything;
+};
+
+/*******/
+
+
+/****is* Watch/RB_Watched_Part
+ * FUNCTION
+ *   A part of the document with the name of its source file, used
+ *   to find the part that belongs to a changed file.
+ * ATTRIBUTES
+ *   o name  -- the name of the source file including the path.
+ *   o part  -- the part, or NULL once it is used in a new
+ *              source tree.
+ *   o stale -- TRUE if the source file has to be analysed again.
+ * SOURCE
+ */
+
+struct RB_Watched_Part
+{
+    char               *name;
+    struct RB_Part     *part;
+    int                 stale;
+};
+
+/*******/
+
+
+/****if* Watch/Watch_Directories
+ * FUNCTION
+ *   Watch all directories of the source tree of a document.
+ *   Directories that are already watched keep their watch
+ *   descriptor.
+ * SYNOPSIS
+ */
+static void Watch_Directories(
+    struct RB_Watch *watch,
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o watch    -- the watcher.
+ *   o document -- the document.
+ * SOURCE
+ */
+{
+    struct RB_Path     *i_path;
+
+    for ( i_path = document->srctree->first_path; i_path;
+          i_path = i_path->next )
+    {
+        int                 wd =
+            inotify_add_watch( watch->fd, i_path->name, RB_WATCH_EVENTS );
+
+        if ( wd < 0 )
+        {
+            RB_Warning( "Can't watch %s\n", i_path->name );
+            continue;
+        }
+        if ( wd >= watch->no_directories )
+        {
+            int                 size = 2 * wd + 8;
+            int                 i;
+
+            watch->directories =
+                realloc( watch->directories, size * sizeof( char * ) );
+            RB_Mem_Check( watch->directories );
+            for ( i = watch->no_directories; i < size; ++i )
+            {
+                watch->directories[i] = NULL;
+            }
+            watch->no_directories = size;
+        }
+        free( watch->directories[wd] );
+        watch->directories[wd] = RB_StrDup( i_path->name );
+    }
+}
+
+/*******/
+
+
+/****if* Watch/Add_Change
+ * FUNCTION
+ *   Remember that a file in one of the watched directories
+ *   changed.
+ * SYNOPSIS
+ */
+static void Add_Change(
+    struct RB_Watch *watch,
+    int wd,
+    char *name )
+/*
+ * INPUTS
+ *   o watch -- the watcher.
+ *   o wd    -- the watch descriptor of the directory.
+ *   o name  -- the name of the file within the directory.
+ * SOURCE
+ */
+{
+    char               *directory = watch->directories[wd];
+    struct RB_Watch_Change *change;
+
+    if ( watch->no_changes == watch->size )
+    {
+        watch->size = 2 * watch->size + 8;
+        watch->changes = realloc( watch->changes,
+                                  watch->size *
+                                  sizeof( struct RB_Watch_Change ) );
+        RB_Mem_Check( watch->changes );
+    }
+    change = &( watch->changes[watch->no_changes++] );
+    change->directory = wd;
+    change->full_name = malloc( strlen( directory ) + strlen( name ) + 1 );
+    RB_Mem_Check( change->full_name );
+    strcpy( change->full_name, directory );
+    strcat( change->full_name, name );
+}
+
+/*******/
+
+
+/****if* Watch/Is_Source_Directory
+ * FUNCTION
+ *   Check if a directory that was added to or removed from one of
+ *   the watched directories is, or was, part of the source tree.
+ *   This uses the same rules as RB_Fill_Directory().
+ * SYNOPSIS
+ */
+static int Is_Source_Directory(
+    struct RB_Document *document,
+    char *directory,
+    char *name )
+/*
+ * INPUTS
+ *   o document  -- the document.
+ *   o directory -- the watched directory.
+ *   o name      -- the name of the directory within it.
+ * SOURCE
+ */
+{
+    struct RB_Path     *path;
+    int                 is_source;
+
+    if ( course_of_action.do_nodesc || RB_To_Be_Skipped( name ) )
+    {
+        return FALSE;
+    }
+    path = RB_Get_RB_Path2( directory, name );
+    is_source = !( document->docroot &&
+                   ( strcmp( path->name, document->docroot->name ) == 0 ) );
+    RB_Free_RB_Path( path );
+    return is_source;
+}
+
+/*******/
+
+
+/****if* Watch/Read_Events
+ * FUNCTION
+ *   Wait until something changes in one of the watched directories,
+ *   and then read all events until there were none for
+ *   RB_WATCH_QUIET_TIME milliseconds.
+ * SYNOPSIS
+ */
+static void Read_Events(
+    struct RB_Watch *watch,
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o watch    -- the watcher, the changes are added to it.
+ *   o document -- the document.
+ * SOURCE
+ */
+{
+    /* Aligned for the struct inotify_event in it */
+    long                buffer[( 64 * 1024 ) / sizeof( long )];
+    struct pollfd       poll_fd;
+
+    poll_fd.fd = watch->fd;
+    poll_fd.events = POLLIN;
+    do
+    {
+        ssize_t             length =
+            read( watch->fd, buffer, sizeof( buffer ) );
+        char               *c;
+
+        if ( length <= 0 )
+        {
+            RB_Panic( "Can't read the changes of the source files\n" );
+        }
+        for ( c = ( char * ) buffer; c < ( char * ) buffer + length;
+              c += sizeof( struct inotify_event ) +
+              ( ( struct inotify_event * ) c )->len )
+        {
+            struct inotify_event *event = ( struct inotify_event * ) c;
+
+            if ( event->mask & IN_Q_OVERFLOW )
+            {
+                watch->rescan = TRUE;
+                watch->everything = TRUE;
+            }
+            else if ( ( event->len == 0 ) || ( event->wd < 0 ) ||
+                      ( event->wd >= watch->no_directories ) ||
+                      !watch->directories[event->wd] )
+            {
+                /* An event of the directory itself */
+            }
+            else if ( event->mask & IN_ISDIR )
+            {
+                if ( Is_Source_Directory( document,
+                                          watch->directories[event->wd],
+                                          event->name ) )
+                {
+                    watch->rescan = TRUE;
+                }
+            }
+            else if ( !RB_Not_Accepted( event->name ) )
+            {
+                Add_Change( watch, event->wd, event->name );
+            }
+        }
+    }
+    while ( poll( &poll_fd, 1, RB_WATCH_QUIET_TIME ) > 0 );
+}
+
+/*******/
+
+
+/****if* Watch/Compare_Watched_Parts
+ * FUNCTION
+ *   Compare two RB_Watched_Part on the name of their source file,
+ *   for qsort() and bsearch().
+ * SOURCE
+ */
+
+static int Compare_Watched_Parts(
+    const void *p1,
+    const void *p2 )
+{
+    const struct RB_Watched_Part *part1 = p1;
+    const struct RB_Watched_Part *part2 = p2;
+
+    return strcmp( part1->name, part2->name );
+}
+
+/*******/
+
+
+/****if* Watch/Find_Watched_Part
+ * FUNCTION
+ *   Find the part of a source file.
+ * SYNOPSIS
+ */
+static struct RB_Watched_Part *Find_Watched_Part(
+    struct RB_Watched_Part *parts,
+    int no_parts,
+    char *name )
+/*
+ * INPUTS
+ *   o parts    -- the parts, sorted on name.
+ *   o no_parts -- the number of parts.
+ *   o name     -- the name of the source file including the path.
+ * RESULT
+ *   The part, or NULL if the source file has no part.
+ * SOURCE
+ */
+{
+    struct RB_Watched_Part key;
+
+    key.name = name;
+    return bsearch( &key, parts, no_parts, sizeof( struct RB_Watched_Part ),
+                    Compare_Watched_Parts );
+}
+
+/*******/
+
+
+/****if* Watch/Free_Part_Headers
+ * FUNCTION
+ *   Free the headers of a part, so it can be analysed again.
+ * SOURCE
+ */
+
+static void Free_Part_Headers(
+    struct RB_Part *part )
+{
+    struct RB_header   *i_header;
+    struct RB_header   *next_header;
+
+    for ( i_header = part->headers; i_header; i_header = next_header )
+    {
+        next_header = i_header->next;
+        RB_Free_Header( i_header );
+    }
+    part->headers = NULL;
+    part->last_header = NULL;
+    RB_Free_Arena( &( part->arena ) );
+}
+
+/*******/
+
+
+/****if* Watch/Intern_Header_Names
+ * FUNCTION
+ *   Intern the names of all headers of a document again, see
+ *   RB_Renew_Interned_Strings().  These are the only interned
+ *   strings in use after RB_Document_Reset().
+ * SYNOPSIS
+ */
+static void Intern_Header_Names(
+    void *data )
+/*
+ * INPUTS
+ *   o data -- the document.
+ * SOURCE
+ */
+{
+    struct RB_Document *document = data;
+    struct RB_Part     *i_part;
+
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        struct RB_header   *i_header;
+
+        for ( i_header = i_part->headers; i_header;
+              i_header = i_header->next )
+        {
+            int                 i;
+
+            for ( i = 0; i < i_header->no_names; ++i )
+            {
+                i_header->names[i] = RB_Intern_String( i_header->names[i] );
+            }
+            i_header->name = i_header->no_names ? i_header->names[0] : NULL;
+            if ( i_header->function_name )
+            {
+                i_header->function_name =
+                    RB_Intern_String( i_header->function_name );
+            }
+            if ( i_header->module_name )
+            {
+                i_header->module_name =
+                    RB_Intern_String( i_header->module_name );
+            }
+        }
+    }
+}
+
+/*******/
+
+
+/****if* Watch/Rescan_Source_Tree
+ * FUNCTION
+ *   Scan the source tree again and create a part for each source
+ *   file.  Source files that were there before keep their part.
+ *   The parts of source files that are gone are freed.
+ * SYNOPSIS
+ */
+static int Rescan_Source_Tree(
+    struct RB_Document *document,
+    struct RB_Watched_Part *parts,
+    int no_parts,
+    struct RB_Part ***stale_parts_result )
+/*
+ * INPUTS
+ *   o document -- the document, RB_Document_Reset() must have
+ *                 been called.
+ *   o parts    -- the current parts, sorted on name.
+ *   o no_parts -- the number of parts.
+ * OUTPUT
+ *   o stale_parts_result -- a new array with the parts that have
+ *                           to be analysed.
+ * RESULT
+ *   The number of parts that have to be analysed.
+ * SOURCE
+ */
+{
+    struct RB_Directory *srctree;
+    struct RB_Filename *i_file;
+    struct RB_Part    **stale_parts;
+    int                 no_stale_parts = 0;
+    int                 i;
+
+    srctree = RB_Get_RB_Directory( document->srcroot->name,
+                                   document->docroot ?
+                                   document->docroot->name : NULL,
+                                   document->no_jobs );
+    stale_parts = malloc( ( RB_Number_Of_Filenames( srctree ) + 1 ) *
+                          sizeof( struct RB_Part * ) );
+    RB_Mem_Check( stale_parts );
+    document->parts = NULL;
+    for ( i_file = srctree->first; i_file; i_file = i_file->next )
+    {
+        struct RB_Watched_Part *watched =
+            Find_Watched_Part( parts, no_parts, Get_Fullname( i_file ) );
+        struct RB_Part     *part;
+
+        if ( watched && watched->part )
+        {
+            part = watched->part;
+            watched->part = NULL;
+            RB_Part_Add_Source( part, i_file );
+            if ( watched->stale )
+            {
+                stale_parts[no_stale_parts++] = part;
+            }
+            else
+            {
+                RB_Free_Kept_Source( i_file );
+            }
+        }
+        else
+        {
+            part = RB_Get_RB_Part(  );
+            RB_Part_Add_Source( part, i_file );
+            stale_parts[no_stale_parts++] = part;
+        }
+        RB_Document_Add_Part( document, part );
+    }
+    for ( i = 0; i < no_parts; ++i )
+    {
+        if ( parts[i].part )
+        {
+            Free_Part_Headers( parts[i].part );
+            RB_Free_RB_Part( parts[i].part );
+        }
+    }
+    RB_Free_RB_Directory( document->srctree );
+    document->srctree = srctree;
+    *stale_parts_result = stale_parts;
+    return no_stale_parts;
+}
+
+/*******/
+
+
+/****if* Watch/Update_Document
+ * FUNCTION
+ *   Analyse the source files that changed again, and generate
+ *   the documentation again.
+ * SYNOPSIS
+ */
+static void Update_Document(
+    struct RB_Watch *watch,
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o watch    -- the watcher with the changes.
+ *   o document -- the document.
+ * SOURCE
+ */
+{
+    struct RB_Watched_Part *parts;
+    struct RB_Part    **stale_parts;
+    struct RB_Part     *i_part;
+    int                 no_parts = 0;
+    int                 no_stale_parts = 0;
+    int                 i;
+
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        ++no_parts;
+    }
+    parts = malloc( ( no_parts + 1 ) * sizeof( struct RB_Watched_Part ) );
+    RB_Mem_Check( parts );
+    for ( i = 0, i_part = document->parts; i_part;
+          i_part = i_part->next, ++i )
+    {
+        parts[i].name = Get_Fullname( i_part->filename );
+        parts[i].part = i_part;
+        parts[i].stale = watch->everything;
+    }
+    qsort( parts, no_parts, sizeof( struct RB_Watched_Part ),
+           Compare_Watched_Parts );
+
+    for ( i = 0; i < watch->no_changes; ++i )
+    {
+        struct RB_Watch_Change *change = &( watch->changes[i] );
+        struct RB_Watched_Part *watched =
+            Find_Watched_Part( parts, no_parts, change->full_name );
+        struct stat         st;
+        int                 is_file = ( stat( change->full_name, &st ) == 0 )
+            && S_ISREG( st.st_mode );
+
+        if ( watched )
+        {
+            if ( is_file )
+            {
+                watched->stale = TRUE;
+            }
+            else
+            {
+                /* It was removed */
+                watch->rescan = TRUE;
+            }
+        }
+        else if ( is_file )
+        {
+            struct RB_Path     *path =
+                RB_Get_RB_Path( watch->directories[change->directory] );
+
+            if ( RB_Is_Source_File( path, change->full_name +
+                                    strlen( path->name ) ) )
+            {
+                watch->rescan = TRUE;
+            }
+            RB_Free_RB_Path( path );
+        }
+    }
+
+    /* The names of the old source tree might be in use. */
+    RB_SetCurrentFile( NULL );
+    RB_Document_Reset( document );
+    for ( i = 0; i < no_parts; ++i )
+    {
+        if ( parts[i].stale )
+        {
+            Free_Part_Headers( parts[i].part );
+        }
+    }
+    if ( watch->rescan )
+    {
+        no_stale_parts =
+            Rescan_Source_Tree( document, parts, no_parts, &stale_parts );
+        Watch_Directories( watch, document );
+    }
+    else
+    {
+        stale_parts = malloc( ( no_parts + 1 ) * sizeof( struct RB_Part * ) );
+        RB_Mem_Check( stale_parts );
+        for ( i_part = document->parts; i_part; i_part = i_part->next )
+        {
+            struct RB_Watched_Part *watched =
+                Find_Watched_Part( parts, no_parts,
+                                   Get_Fullname( i_part->filename ) );
+
+            if ( watched->stale )
+            {
+                stale_parts[no_stale_parts++] = i_part;
+            }
+        }
+    }
+    /* Drop the names of the headers that are gone */
+    RB_Renew_Interned_Strings( Intern_Header_Names, document );
+
+    /* The headers of the other parts go into the header name index
+     * first, so the duplicates in the changed files are found. */
+    for ( i_part = document->parts; i_part; i_part = i_part->next )
+    {
+        struct RB_header   *i_header;
+
+        for ( i_header = i_part->headers; i_header;
+              i_header = i_header->next )
+        {
+            RB_Document_Add_Header_Name( document, i_header );
+        }
+    }
+    for ( i = 0; i < no_stale_parts; ++i )
+    {
+        RB_Say( "Analysing %s\n", SAY_INFO,
+                Get_Fullname( stale_parts[i]->filename ) );
+        RB_Analyse_Part( document, stale_parts[i] );
+    }
+    RB_Generate_Documentation( document );
+
+    for ( i = 0; i < watch->no_changes; ++i )
+    {
+        free( watch->changes[i].full_name );
+    }
+    watch->no_changes = 0;
+    watch->rescan = FALSE;
+    watch->everything = FALSE;
+    free( stale_parts );
+    free( parts );
+}
+
+/*******/
+
+#endif /* ROBO_USE_INOTIFY */
+
+
+/****f* Watch/RB_Watch_Document
+ * FUNCTION
+ *   Watch the source tree of a document, and update the
+ *   documentation each time source files are changed, added,
+ *   or removed.  The source files are filtered with the
+ *   "ignore files:" and "accept files:" blocks of the
+ *   configuration, in the same way as when the source tree is
+ *   scanned.
+ * SYNOPSIS
+ */
+void RB_Watch_Document(
+    struct RB_Document *document )
+/*
+ * INPUTS
+ *   o document -- the document, its documentation should have been
+ *                 generated with RB_Generate_Documentation().
+ * RESULT
+ *   Does not return, the program has to be interrupted.
+ * SOURCE
+ */
+{
+#ifdef ROBO_USE_INOTIFY
+    struct RB_Watch     watch;
+
+    assert( !document->actions.do_one_file_per_header );
+    watch.fd = inotify_init(  );
+    if ( watch.fd < 0 )
+    {
+        RB_Panic( "Can't watch the source files\n" );
+    }
+    watch.directories = NULL;
+    watch.no_directories = 0;
+    watch.changes = NULL;
+    watch.no_changes = 0;
+    watch.size = 0;
+    watch.rescan = FALSE;
+    watch.everything = FALSE;
+    Watch_Directories( &watch, document );
+
+    for ( ;; )
+    {
+        RB_Say( "Watching %s for changes\n", SAY_INFO,
+                document->srcroot->name );
+        Read_Events( &watch, document );
+        if ( watch.no_changes || watch.rescan )
+        {
+            Update_Document( &watch, document );
+        }
+    }
+#else
+    USE( document );
+    RB_Panic( "--watch is not supported on this platform\n" );
+#endif
+}
+
+/*******/
@@ -0,0 +1,393 @@
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****h* ROBODoc/Wildcard
+ * FUNCTION
+ *   Match file names against the wildcard expressions of the
+ *   "ignore files:" and "accept files:" blocks.  The expressions
+ *   are compiled once, when the configuration is read, see
+ *   RB_Compile_Wildcards().  They match the same names as
+ *   RB_Match() does, but without backtracking, so the time it
+ *   takes to match a name is at most proportional to the length
+ *   of the name times the length of the expression.
+ *****
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "robodoc.h"
+#include "wildcard.h"
+#include "util.h"
+
+#ifdef DMALLOC
+#include <dmalloc.h>
+#endif
+
+
+/****id* Wildcard/RB_FOLD
+ * FUNCTION
+ *   The form of a character in which it is compared.  See
+ *   RB_Match() for IGNORE_CASE_FILENAMES.
+ * SOURCE
+ */
+
+#ifdef IGNORE_CASE_FILENAMES
+#define RB_FOLD( c ) ( ( char ) tolower( ( unsigned char ) ( c ) ) )
+#else
+#define RB_FOLD( c ) ( c )
+#endif
+
+/*******/
+
+
+/****if* Wildcard/Compile_Wildcard
+ * FUNCTION
+ *   Split a wildcard expression into the pieces between its '*'
+ *   characters.
+ * SYNOPSIS
+ */
+static void Compile_Wildcard(
+    struct RB_Wildcard *wildcard,
+    char *expression )
+/*
+ * INPUTS
+ *   o wildcard   -- the compiled expression.
+ *   o expression -- the wildcard expression.
+ * SOURCE
+ */
+{
+    int                 no_stars = 0;
+    int                 length = 0;
+    char               *c;
+
+    for ( c = expression; *c; ++c )
+    {
+        if ( *c == '*' )
+        {
+            ++no_stars;
+        }
+    }
+    wildcard->expression = expression;
+    wildcard->text = malloc( strlen( expression ) + 1 );
+    wildcard->offsets = malloc( ( no_stars + 1 ) * sizeof( int ) );
+    wildcard->lengths = malloc( ( no_stars + 1 ) * sizeof( int ) );
+    RB_Mem_Check( wildcard->text );
+    RB_Mem_Check( wildcard->offsets );
+    RB_Mem_Check( wildcard->lengths );
+
+    wildcard->no_pieces = 0;
+    wildcard->offsets[0] = 0;
+    for ( c = expression;; ++c )
+    {
+        if ( ( *c == '*' ) || ( *c == '\0' ) )
+        {
+            int                 piece = wildcard->no_pieces++;
+
+            wildcard->lengths[piece] = length - wildcard->offsets[piece];
+            if ( *c == '\0' )
+            {
+                break;
+            }
+            wildcard->offsets[piece + 1] = length;
+        }
+        else
+        {
+            wildcard->text[length++] = RB_FOLD( *c );
+        }
+    }
+    wildcard->text[length] = '\0';
+    wildcard->min_length = length;
+}
+
+/*******/
+
+
+/****if* Wildcard/Match_Piece
+ * FUNCTION
+ *   Check if a piece of a wildcard expression matches the text at
+ *   the given position in a target.
+ * SYNOPSIS
+ */
+static int Match_Piece(
+    const char *piece,
+    int length,
+    const char *target )
+/*
+ * INPUTS
+ *   o piece  -- the piece, it can contain '?'.
+ *   o length -- the length of the piece.
+ *   o target -- the text, at least length characters long.
+ * RESULT
+ *   TRUE if it matches, FALSE otherwise.
+ * SOURCE
+ */
+{
+    int                 i;
+
+    for ( i = 0; i < length; ++i )
+    {
+        if ( ( piece[i] != '?' ) && ( piece[i] != RB_FOLD( target[i] ) ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*******/
+
+
+/****if* Wildcard/Match_Wildcard
+ * FUNCTION
+ *   Check if a compiled wildcard expression matches a target.
+ *   The first and the last piece can only be at the begin and the
+ *   end of the target.  Each of the other pieces is matched at the
+ *   first place it fits after the previous one.  This never has to
+ *   be undone: a match further on would leave less room for the
+ *   pieces that follow.
+ * SYNOPSIS
+ */
+static int Match_Wildcard(
+    struct RB_Wildcard *wildcard,
+    const char *target,
+    int target_length )
+/*
+ * INPUTS
+ *   o wildcard      -- the compiled expression.
+ *   o target        -- the string to be matched.
+ *   o target_length -- its length.
+ * RESULT
+ *   TRUE if it matches, FALSE otherwise.
+ * SOURCE
+ */
+{
+    int                 last = wildcard->no_pieces - 1;
+    int                 begin;
+    int                 end;
+    int                 piece;
+
+    if ( target_length < wildcard->min_length )
+    {
+        return FALSE;
+    }
+    if ( last == 0 )
+    {
+        /* No '*' at all */
+        return ( target_length == wildcard->lengths[0] ) &&
+            Match_Piece( wildcard->text, wildcard->lengths[0], target );
+    }
+    /* For expressions like "*.c" this is all there is to do. */
+    end = target_length - wildcard->lengths[last];
+    if ( !Match_Piece( wildcard->text + wildcard->offsets[last],
+                       wildcard->lengths[last], target + end ) ||
+         !Match_Piece( wildcard->text, wildcard->lengths[0], target ) )
+    {
+        return FALSE;
+    }
+    begin = wildcard->lengths[0];
+    for ( piece = 1; piece < last; ++piece )
+    {
+        char               *text = wildcard->text + wildcard->offsets[piece];
+        int                 length = wildcard->lengths[piece];
+
+        for ( ; begin + length <= end; ++begin )
+        {
+            if ( Match_Piece( text, length, target + begin ) )
+            {
+                break;
+            }
+        }
+        if ( begin + length > end )
+        {
+            return FALSE;
+        }
+        begin += length;
+    }
+    return TRUE;
+}
+
+/*******/
+
+
+/****f* Wildcard/RB_Compile_Wildcards
+ * FUNCTION
+ *   Compile a list of wildcard expressions into a
+ *   RB_Wildcard_Set.
+ * SYNOPSIS
+ */
+void RB_Compile_Wildcards(
+    struct RB_Wildcard_Set *set,
+    char **expressions,
+    unsigned int number )
+/*
+ * INPUTS
+ *   o set         -- the set to fill.
+ *   o expressions -- the wildcard expressions, they should stay
+ *                    around as long as the set is used.
+ *   o number      -- the number of expressions.
+ * SOURCE
+ */
+{
+    int                 count[256];
+    int                 i;
+    int                 c;
+
+    set->no_wildcards = number;
+    set->wildcards = malloc( ( number + 1 ) * sizeof( struct RB_Wildcard ) );
+    set->pool = malloc( ( number + 1 ) * sizeof( int ) );
+    set->any = malloc( ( number + 1 ) * sizeof( int ) );
+    RB_Mem_Check( set->wildcards );
+    RB_Mem_Check( set->pool );
+    RB_Mem_Check( set->any );
+    set->no_any = 0;
+    memset( count, 0, sizeof( count ) );
+
+    for ( i = 0; i < set->no_wildcards; ++i )
+    {
+        struct RB_Wildcard *wildcard = &( set->wildcards[i] );
+        size_t              length = strlen( expressions[i] );
+        char                last = length ? expressions[i][length - 1] : '\0';
+
+        Compile_Wildcard( wildcard, expressions[i] );
+        if ( ( last == '\0' ) || ( last == '*' ) || ( last == '?' ) )
+        {
+            set->any[set->no_any++] = i;
+        }
+        else
+        {
+            ++count[( unsigned char ) RB_FOLD( last )];
+        }
+    }
+
+    set->start[0] = 0;
+    for ( c = 0; c < 256; ++c )
+    {
+        set->start[c + 1] = set->start[c] + count[c];
+        count[c] = set->start[c];
+    }
+    /* In the original order within each group */
+    for ( i = 0; i < set->no_wildcards; ++i )
+    {
+        struct RB_Wildcard *wildcard = &( set->wildcards[i] );
+        int                 last = wildcard->no_pieces - 1;
+
+        if ( ( wildcard->lengths[last] > 0 ) &&
+             ( wildcard->text[wildcard->offsets[last] +
+                              wildcard->lengths[last] - 1] != '?' ) )
+        {
+            c = ( unsigned char ) wildcard->text[wildcard->offsets[last] +
+                                                 wildcard->lengths[last] -
+                                                 1];
+            set->pool[count[c]++] = i;
+        }
+    }
+}
+
+/*******/
+
+
+/****f* Wildcard/RB_Match_Wildcards
+ * FUNCTION
+ *   Find the first wildcard expression of a set that matches a
+ *   target string.
+ * SYNOPSIS
+ */
+int RB_Match_Wildcards(
+    struct RB_Wildcard_Set *set,
+    const char *target )
+/*
+ * INPUTS
+ *   o set    -- the compiled wildcard expressions.
+ *   o target -- the string to be matched.
+ * RESULT
+ *   The index of the first expression that matches, or -1 if none
+ *   of them matches.
+ * SOURCE
+ */
+{
+    int                 target_length = strlen( target );
+    int                 i = 0;
+    int                 i_end = 0;
+    int                 j = 0;
+
+    if ( target_length > 0 )
+    {
+        int                 c =
+            ( unsigned char ) RB_FOLD( target[target_length - 1] );
+
+        i = set->start[c];
+        i_end = set->start[c + 1];
+    }
+    /* Merge both lists, so the expressions are tried in order */
+    while ( ( i < i_end ) || ( j < set->no_any ) )
+    {
+        int                 k;
+
+        if ( ( j == set->no_any ) ||
+             ( ( i < i_end ) && ( set->pool[i] < set->any[j] ) ) )
+        {
+            k = set->pool[i++];
+        }
+        else
+        {
+            k = set->any[j++];
+        }
+        if ( Match_Wildcard( &( set->wildcards[k] ), target, target_length ) )
+        {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/*******/
+
+
+/****f* Wildcard/RB_Free_Wildcards
+ * FUNCTION
+ *   Free the memory used by a RB_Wildcard_Set.
+ * SOURCE
+ */
+
+void RB_Free_Wildcards(
+    struct RB_Wildcard_Set *set )
+{
+    int                 i;
+
+    for ( i = 0; i < set->no_wildcards; ++i )
+    {
+        free( set->wildcards[i].text );
+        free( set->wildcards[i].offsets );
+        free( set->wildcards[i].lengths );
+    }
+    free( set->wildcards );
+    free( set->pool );
+    free( set->any );
+    set->wildcards = NULL;
+    set->pool = NULL;
+    set->any = NULL;
+    set->no_wildcards = 0;
+    set->no_any = 0;
+}
+
+/*******/
@@ -0,0 +1,99 @@
+#ifndef ROBODOC_WILDCARD_H
+#define ROBODOC_WILDCARD_H
+/*
+Copyright (C) 1994-2007  Frans Slothouber, Jacco van Weert, Petteri Kettunen,
+Bernd Koesling, Thomas Aglassinger, Anthon Pang, Stefan Kost, David Druffner,
+Sasha Vasko, Kai Hofmann, Thierry Pierron, Friedrich Haase, and Gergely Budai.
+
+This file is part of ROBODoc
+
+ROBODoc is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/****s* Wildcard/RB_Wildcard
+ * FUNCTION
+ *   A compiled wildcard expression.  The expression is split on
+ *   its '*' characters into pieces.  The first piece has to match
+ *   the start of the target, the last piece the end of the target,
+ *   and the other pieces are searched for in between, in order.
+ * ATTRIBUTES
+ *   o expression -- the wildcard expression.
+ *   o text       -- the pieces, one after the other.  With
+ *                   IGNORE_CASE_FILENAMES in lower case.
+ *   o offsets    -- the offset of each piece in text.
+ *   o lengths    -- the length of each piece.
+ *   o no_pieces  -- the number of pieces, one more than the
+ *                   number of '*' in the expression.
+ *   o min_length -- the length of the shortest target that can
+ *                   match.
+ * SOURCE
+ */
+
+struct RB_Wildcard
+{
+    char               *expression;
+    char               *text;
+    int                *offsets;
+    int                *lengths;
+    int                 no_pieces;
+    int                 min_length;
+};
+
+/*******/
+
+
+/****s* Wildcard/RB_Wildcard_Set
+ * FUNCTION
+ *   A list of compiled wildcard expressions, indexed on the last
+ *   character they match.  A target only has to be matched
+ *   against the expressions that end with its last character,
+ *   and the expressions that end with a '*' or '?'.
+ * ATTRIBUTES
+ *   o wildcards    -- the compiled expressions, in the original
+ *                     order.
+ *   o no_wildcards -- the number of expressions.
+ *   o pool         -- the indices of the expressions that end with
+ *                     a literal character, grouped on that
+ *                     character.
+ *   o start        -- for each character c the expressions ending
+ *                     in c are pool[start[c]] .. pool[start[c+1]-1].
+ *   o any          -- the indices of the other expressions.
+ *   o no_any       -- the number of other expressions.
+ * SOURCE
+ */
+
+struct RB_Wildcard_Set
+{
+    struct RB_Wildcard *wildcards;
+    int                 no_wildcards;
+    int                *pool;
+    int                 start[257];
+    int                *any;
+    int                 no_any;
+};
+
+/*******/
+
+void                RB_Compile_Wildcards(
+    struct RB_Wildcard_Set *set,
+    char **expressions,
+    unsigned int number );
+int                 RB_Match_Wildcards(
+    struct RB_Wildcard_Set *set,
+    const char *target );
+void                RB_Free_Wildcards(
+    struct RB_Wildcard_Set *set );
+
+#endif /* ROBODOC_WILDCARD_H */
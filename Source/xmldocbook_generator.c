@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <assert.h>
 #include <ctype.h>
 #include "xmldocbook_generator.h"
+#include "generator.h"
 #include "globals.h"
 #include "util.h"
 
@@ -40,15 +41,7 @@ void RB_XMLDB_Generate_String(
     FILE *dest_doc,
     char *a_string )
 {
-    int                 i;
-    int                 l = strlen( a_string );
-    unsigned char       c;
-
-    for ( i = 0; i < l; ++i )
-    {
-        c = a_string[i];
-        RB_XMLDB_Generate_Char( dest_doc, c );
-    }
+    RB_Generate_Chars( dest_doc, a_string, strlen( a_string ) );
 }
 
 /* TODO Documentation */